@@ -0,0 +1,35 @@
+#ifndef __ARC_FLAGS_HPP__
+#define __ARC_FLAGS_HPP__
+
+#include "ch_graph.hpp"
+#include <vector>
+#include <cstdint>
+
+namespace CHGraph
+{
+    constexpr int MAX_ARC_FLAGS_CELL_NUMBER = 64;
+
+    struct ArcFlags
+    {
+        int cell_number = 0;
+        std::vector<int> cells; // cells[node] = cell of node
+
+        // Bit c of forward_flags[e] is set if forward_arcs[e] starts a shortest path into cell c,
+        // bit c of backward_flags[e] is set if backward_arcs[e] ends a shortest path out of cell c
+        std::vector<std::uint64_t> forward_flags;
+        std::vector<std::uint64_t> backward_flags;
+    };
+
+    void preproc_arc_flags(const Graph &graph, const PreprocGraph &preproc_graph, const int cell_number, ArcFlags &arc_flags);
+
+    void query_route(const Graph &graph, const PreprocGraph &preproc_graph, const ArcFlags &arc_flags,
+                     const Destination &destination, Route &route);
+
+    // query_route reporting the number of settled nodes, arc_flags may be nullptr
+    void query_route_search_space(const PreprocGraph &preproc_graph, const ArcFlags *arc_flags,
+                                  const Destination &destination, Route &route, int &settled_nodes);
+
+    std::size_t arc_flags_memory(const ArcFlags &arc_flags);
+}
+
+#endif
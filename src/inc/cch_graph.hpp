@@ -0,0 +1,42 @@
+#ifndef __CCH_GRAPH_HPP__
+#define __CCH_GRAPH_HPP__
+
+#include "ch_graph.hpp"
+#include <vector>
+
+namespace CHGraph
+{
+    // Metric independent part of a customizable contraction hierarchy (CCH).
+    // Each undirected arc {u, v} of the chordal supergraph is stored once at its
+    // lower ranked end point u and carries two weights after customization:
+    // up (u -> v) and down (v -> u).
+    struct CCHTopology
+    {
+        std::vector<int> ranks; // ranks[node] = position in nested dissection order
+
+        // -------- Upward arcs {u, v} with ranks[u] < ranks[v], heads sorted by rank --------
+        std::vector<int> up_first_out;
+        std::vector<int> up_head;
+
+        // -------- Lower neighbours: for node v all arcs {x, v} with ranks[x] < ranks[v], sorted by x --------
+        std::vector<int> down_first_out;
+        std::vector<int> down_tail;
+        std::vector<int> down_arc;
+
+        // -------- Mapping of input arcs (Graph::to index) to CCH arcs, -1 for self loops --------
+        std::vector<int> input_arc;
+        std::vector<char> input_upward; // 1 if input arc goes from lower to higher ranked node
+
+        // -------- Arcs grouped by level of their lower end point, levels are customized one after another --------
+        std::vector<int> level_first;
+        std::vector<int> level_arcs;
+    };
+
+    void order_nested_dissection(const Graph &graph, std::vector<int> &ranks);
+
+    void preproc_graph_cch(const Graph &graph, CCHTopology &topology);
+
+    void customize_cch(const CCHTopology &topology, const std::vector<double> &weights, PreprocGraph &preproc_graph);
+}
+
+#endif
@@ -1,10 +1,14 @@
 #ifndef __GRAPH_HPP__
 #define __GRAPH_HPP__
 
+#include "search_stats.hpp"
+#include "preproc_monitor.hpp"
 #include <vector>
+#include <cstdint>
 
 namespace CHGraph
 {
+    struct PreprocCheckpoint;
 
     struct Graph
     {
@@ -36,8 +40,43 @@ namespace CHGraph
         // contains edges v -> u for each edge (original or shortcut) u -> v with ranks[u] > ranks[v]"
         std::vector<int> backward_first_out;
         std::vector<CHArc>   backward_arcs;
+
+        // -------- Reachability filter, empty if it was not computed --------
+        // components[node] = strongly connected component over the arcs with finite weight, an arc
+        // between two components always leads to the smaller id
+        std::vector<int> components;
+        int component_number = 0;
+        // Condensation bit matrix with component_words(component_number) words per row, bit d of row c
+        // is set if component c reaches component d. Only built for few components.
+        std::vector<std::uint64_t> component_reachability;
     };
 
+    constexpr int MAX_REACHABILITY_COMPONENTS = 4096;
+
+    inline int component_words(const int component_number)
+    {
+        return (component_number + 63) / 64;
+    }
+
+    // False only if there is provably no path from s to t, always true without reachability filter
+    inline bool may_reach(const PreprocGraph &preproc_graph, const int s, const int t)
+    {
+        if (preproc_graph.components.empty())
+            return true;
+
+        const int source_component = preproc_graph.components[s];
+        const int target_component = preproc_graph.components[t];
+        if (source_component == target_component)
+            return true;
+        if (source_component < target_component)
+            return false;
+        if (preproc_graph.component_reachability.empty())
+            return true;
+
+        const std::size_t row = static_cast<std::size_t>(source_component) * component_words(preproc_graph.component_number);
+        return (preproc_graph.component_reachability[row + target_component / 64] >> (target_component % 64)) & 1;
+    }
+
     struct Route
     {
         double total_weight = 0;
@@ -59,15 +98,59 @@ namespace CHGraph
         double expected_weight = 0.0;
     };
 
+    // Optional inputs and outputs of the preprocessors, nullptr and 0 leave them out
+    struct PreprocOptions
+    {
+        // Adds witness searches and shortcuts in builds with search statistics
+        PreprocStats *stats = nullptr;
+        // Reports phase times, contraction costs and progress
+        PreprocMonitor *monitor = nullptr;
+        // Checkpoints the contraction to checkpoint->file and resumes from it, see preproc_checkpoint.hpp. Throws
+        // std::runtime_error if the file belongs to another graph or method or can not be read or written.
+        PreprocCheckpoint *checkpoint = nullptr;
+        // Contracts the nodes in this order, for example the ranks of an earlier hierarchy of the graph, and skips
+        // the priority computation. Throws std::invalid_argument unless it is a permutation of the nodes.
+        const std::vector<int> *ranks = nullptr;
+        // Bottom up only, stops the contraction when core_size nodes remain. These get the highest ranks in the
+        // order of their ids and keep all arcs between them, for example to search the core with another method.
+        int core_size = 0;
+    };
+
     void preproc_graph_bottom_up(const Graph &graph, PreprocGraph &preproc_graph);
+    void preproc_graph_bottom_up(const Graph &graph, PreprocGraph &preproc_graph, const PreprocOptions &options);
 
     void preproc_graph_top_down(const Graph &graph, PreprocGraph &preproc_graph);
+    // Throws std::invalid_argument for a core_size
+    void preproc_graph_top_down(const Graph &graph, PreprocGraph &preproc_graph, const PreprocOptions &options);
+
+    // Repairs preproc_graph after graph.weights changed for the arcs listed in changed_arcs
+    // (indices into Graph::to, infinity closes an arc). Ranks are kept.
+    void update_preproc_graph(const Graph &graph, PreprocGraph &preproc_graph, const std::vector<int> &changed_arcs);
+
+    // Removes the shortcuts that an upward path of at most the same weight makes unnecessary, except those
+    // still needed to unpack other shortcuts, and returns their number. The result is only valid for the
+    // current weights, so it can not be repaired by update_preproc_graph, and arc indices change.
+    long long prune_redundant_shortcuts(PreprocGraph &preproc_graph);
+
+    // Fills the reachability filter of preproc_graph from graph, the condensation matrix only for at most
+    // MAX_REACHABILITY_COMPONENTS components. Both preprocessors and update_preproc_graph call it.
+    void compute_components(const Graph &graph, PreprocGraph &preproc_graph);
 
     // Helper functions query
     bool stall_forward(int v, const std::vector<double>& dist_f, const PreprocGraph& preproc_graph);
     bool stall_backward(int v, const std::vector<double>& dist_b, const PreprocGraph& preproc_graph);
    
     void query_route(const CHGraph::Graph &graph, const PreprocGraph &preproc_graph, const Destination &destination, Route &route);
+    // Adds the search space of the query to stats in builds with search statistics
+    void query_route(const CHGraph::Graph &graph, const PreprocGraph &preproc_graph, const Destination &destination, Route &route,
+                     QueryStats &stats);
+
+    // Appends the original path of arc from -> to (excluding from, including to) to nodes
+    void unpack_arc(const PreprocGraph &preproc_graph, int from, int to, int mid_node, std::vector<int> &nodes);
+
+    // routes[0] is the shortest route, followed by at most max_alternative_number via node alternatives
+    void query_alternative_routes(const CHGraph::Graph &graph, const PreprocGraph &preproc_graph, const Destination &destination,
+                                  const int max_alternative_number, std::vector<Route> &routes);
     
     static bool witness_search(const std::vector<std::vector<std::pair<int,double>>>& adj,int source,
                         int target, int forbidden, double max_dist, const std::vector<int>& contracted);
@@ -0,0 +1,43 @@
+#ifndef __CHAIN_COMPRESSION_HPP__
+#define __CHAIN_COMPRESSION_HPP__
+
+#include "ch_graph.hpp"
+#include "graph_normalization.hpp"
+#include <vector>
+
+namespace CHGraph
+{
+    // Graph whose chains of degree 2 nodes are replaced by single arcs. A chain node has exactly two
+    // neighbours and either one arc in from one of them and one arc out to the other (one-way chain)
+    // or arcs in both directions to both of them (two-way chain). Chains start and end at kept nodes,
+    // chains that close a cycle on their own are kept.
+    struct ChainCompression
+    {
+        Graph graph;         // kept nodes in compressed ids, one arc per chain and direction
+        NodeMapping mapping; // original <-> compressed ids, chain nodes and nodes without arcs map to -1
+
+        // -------- Chain c runs from chain_tail[c] to chain_head[c] (original ids) through the interior
+        // nodes chain_nodes[chain_first[c]], ..., chain_nodes[chain_first[c + 1] - 1] --------
+        std::vector<int> chain_first;
+        std::vector<int> chain_tail;
+        std::vector<int> chain_head;
+        std::vector<int> chain_nodes;
+
+        // Distances along the chain for every entry of chain_nodes, infinity against a one-way chain
+        std::vector<double> from_tail;
+        std::vector<double> to_head;
+        std::vector<double> to_tail;
+        std::vector<double> from_head;
+
+        std::vector<int> node_position; // node_position[original node] = index into chain_nodes, -1 for other nodes
+    };
+
+    void compress_chains(const Graph &graph, ChainCompression &compression);
+
+    // Answers destination given in original ids with preproc_graph, the hierarchy of compression.graph. An end
+    // point inside a chain is attached to the chain ends, which takes at most four queries.
+    void query_route(const ChainCompression &compression, const PreprocGraph &preproc_graph, const Destination &destination,
+                     Route &route);
+}
+
+#endif
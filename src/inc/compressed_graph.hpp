@@ -0,0 +1,101 @@
+#ifndef __COMPRESSED_GRAPH_HPP__
+#define __COMPRESSED_GRAPH_HPP__
+
+#include "ch_graph.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace CHGraph
+{
+    // Read-only adjacency array. The heads of every node are sorted and stored as varint deltas, the
+    // first one zigzag encoded relative to the node itself. Integral weights are bit-packed with
+    // weight_bits bits per arc, any other weight makes all weights stay uncompressed in raw_weights.
+    struct CompressedArcs
+    {
+        std::vector<int> first_out;             // first_out[node] = index of the first arc of node
+        std::vector<std::uint32_t> first_byte;  // first_byte[node] = offset of the heads of node
+        std::vector<std::uint8_t> heads;
+
+        bool packed_weights = true;
+        int weight_bits = 0;
+        std::vector<std::uint64_t> weight_words; // one padding word, so a weight never reads past the end
+        std::vector<double> raw_weights;
+    };
+
+    // Graph without the redundant Graph::from array
+    struct CompressedGraph
+    {
+        CompressedArcs arcs;
+    };
+
+    // PreprocGraph without ranks and mid nodes, enough to answer queries but not to unpack routes
+    struct CompressedPreprocGraph
+    {
+        CompressedArcs forward_arcs;
+        CompressedArcs backward_arcs;
+    };
+
+    void compress_graph(const Graph &graph, CompressedGraph &compressed_graph);
+
+    void compress_preproc_graph(const PreprocGraph &preproc_graph, CompressedPreprocGraph &compressed_graph);
+
+    // Bidirectional upward search with stall-on-demand, same results as query_route on the plain graph
+    void query_route(const CompressedPreprocGraph &compressed_graph, const Destination &destination, Route &route);
+
+    // Plain Dijkstra, the baseline for both representations
+    void query_route_dijkstra(const Graph &graph, const Destination &destination, Route &route);
+    void query_route_dijkstra(const CompressedGraph &compressed_graph, const Destination &destination, Route &route);
+
+    std::size_t graph_memory(const Graph &graph);
+    std::size_t preproc_graph_memory(const PreprocGraph &preproc_graph);
+    std::size_t compressed_arcs_memory(const CompressedArcs &arcs);
+
+    inline double compressed_arc_weight(const CompressedArcs &arcs, const int arc)
+    {
+        if (!arcs.packed_weights)
+            return arcs.raw_weights[arc];
+        if (arcs.weight_bits == 0)
+            return 0.0;
+
+        const std::uint64_t bit = static_cast<std::uint64_t>(arc) * arcs.weight_bits;
+        const std::uint64_t word = bit / 64;
+        const int shift = static_cast<int>(bit % 64);
+
+        std::uint64_t value = arcs.weight_words[word] >> shift;
+        if (shift + arcs.weight_bits > 64)
+            value |= arcs.weight_words[word + 1] << (64 - shift);
+        if (arcs.weight_bits < 64)
+            value &= (std::uint64_t{1} << arcs.weight_bits) - 1;
+        return static_cast<double>(value);
+    }
+
+    // Calls func(head, weight) for every arc of node, in increasing order of head
+    template <typename Func>
+    inline void for_each_compressed_arc(const CompressedArcs &arcs, const int node, Func func)
+    {
+        const std::uint8_t *byte = arcs.heads.data() + arcs.first_byte[node];
+        std::int64_t head = node;
+
+        for (int e = arcs.first_out[node]; e < arcs.first_out[node + 1]; ++e)
+        {
+            std::uint64_t delta = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                const std::uint8_t value = *byte++;
+                delta |= static_cast<std::uint64_t>(value & 0x7f) << shift;
+                if ((value & 0x80) == 0)
+                    break;
+            }
+
+            if (e == arcs.first_out[node])
+                head += static_cast<std::int64_t>(delta >> 1) ^ -static_cast<std::int64_t>(delta & 1);
+            else
+                head += static_cast<std::int64_t>(delta);
+
+            func(static_cast<int>(head), compressed_arc_weight(arcs, e));
+        }
+    }
+}
+
+#endif
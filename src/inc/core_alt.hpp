@@ -0,0 +1,35 @@
+#ifndef __CORE_ALT_HPP__
+#define __CORE_ALT_HPP__
+
+#include "ch_graph.hpp"
+#include <vector>
+
+namespace CHGraph
+{
+    // Partially contracted graph: contracted nodes form a hierarchy below the
+    // uncontracted core, the core is searched with ALT (A*, landmarks, triangle inequality)
+    struct CoreALTGraph
+    {
+        // Arcs with at least one contracted end point, core nodes have the highest ranks
+        PreprocGraph hierarchy;
+
+        std::vector<int> core_index; // core_index[node] = position among core nodes, -1 if contracted
+
+        // -------- Core graph (original edges and shortcuts between core nodes) --------
+        std::vector<int> core_first_out;
+        std::vector<CHArc> core_arcs;
+        std::vector<int> core_backward_first_out; // reversed core graph
+        std::vector<CHArc> core_backward_arcs;
+
+        // -------- Landmark distances within the core, [landmark * core_size + core_index] --------
+        std::vector<int> landmarks;
+        std::vector<double> landmark_from; // dist(landmark, node)
+        std::vector<double> landmark_to;   // dist(node, landmark)
+    };
+
+    void preproc_graph_core_alt(const Graph &graph, const int core_size, const int landmark_number, CoreALTGraph &core_graph);
+
+    void query_route_core_alt(const CoreALTGraph &core_graph, const Destination &destination, Route &route);
+}
+
+#endif
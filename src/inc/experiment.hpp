@@ -1,12 +1,20 @@
 #ifndef __EXPERIMENT_HPP__
 #define __EXPERIMENT_HPP__
 
+#include "timer.hpp"
 #include <string>
 
 namespace Experiment
 {
+    // The top down preprocced graph is loaded from preproc_file if it exists, otherwise
+    // it is computed and saved there. An empty preproc_file always preprocesses.
+    // The graph is read through its binary cache, rebuild_graph_cache parses the text file anyway.
+    // Every measured region is timed with timer_backend. count_events also records the hardware
+    // counters of every region that the kernel lets us open.
     void run(const std::string &graph_file, const std::string &destinations_file,
-             const std::string &output_file, const int run_number);
+             const std::string &output_file, const int run_number, const std::string &preproc_file = "",
+             const bool rebuild_graph_cache = false, const TimerBackend timer_backend = TimerBackend::CHRONO,
+             const bool count_events = false);
 }
 
 #endif
\ No newline at end of file
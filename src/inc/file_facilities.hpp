@@ -3,18 +3,75 @@
 
 #include "measurement.hpp"
 #include "ch_graph.hpp"
+#include "preproc_checkpoint.hpp"
 #include <string>
 #include <vector>
+#include <fstream>
 
 namespace FileFacilities
 {
-    void read_graph(const std::string &graph_file, CHGraph::Graph &graph);
+    enum class GraphCacheMode
+    {
+        DISABLED, // always parse the text file
+        ENABLED,  // use graph_file + ".cache" if it matches the size, mtime and hash of graph_file, otherwise parse and write it
+        REBUILD   // parse and write the cache even if it matches
+    };
+
+    void read_graph(const std::string &graph_file, CHGraph::Graph &graph, const GraphCacheMode cache_mode = GraphCacheMode::DISABLED);
 
     void read_destinations(const std::string &destinations_file, std::vector<CHGraph::Destination> &destinations);
 
+    // Reads a destinations file batch by batch through a fixed size buffer
+    class DestinationReader
+    {
+    private:
+        std::string m_destinations_file;
+        std::ifstream m_file;
+        std::vector<char> m_buffer;
+        std::size_t m_begin = 0;
+        std::size_t m_end = 0;
+        int m_line_number = 1;
+        bool m_eof = false;
+
+        bool next_line(const char *&line_begin, const char *&line_end);
+    public:
+        explicit DestinationReader(const std::string &destinations_file);
+
+        // Replaces batch with at most max_batch_size next destinations, false once the file is exhausted
+        bool next_batch(std::vector<CHGraph::Destination> &batch, const std::size_t max_batch_size);
+    };
+
     void read_solutions(const std::string &solutions_file, std::vector<CHGraph::Solution> &solutions);
 
     void dump_measurement(const Measurement &measurement, const std::string &output_file);
+
+    // Summary of every registered metric with values, one "metric;statistic;value" line per statistic
+    void dump_measurement_summary(const Measurement &measurement, const std::string &output_file);
+
+    // Same summary as a JSON object keyed by metric name
+    void dump_measurement_json(const Measurement &measurement, const std::string &output_file);
+
+    // Binary, versioned and checksummed copy of a preprocessed graph, sections are 64 byte aligned and the file
+    // is tied to graph by a checksum. The reachability filter is not stored, CHGraph::compute_components
+    // rebuilds it from the input graph.
+    void save_preproc_graph(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph, const std::string &preproc_file);
+
+    // Throws std::runtime_error if the file is damaged or was written for another graph
+    void load_preproc_graph(const std::string &preproc_file, const CHGraph::Graph &graph, CHGraph::PreprocGraph &preproc_graph);
+
+    // Binary copy of an interrupted contraction of graph in the same layout, tied to graph by a checksum. It is
+    // written next to checkpoint_file and renamed, so a crash while writing keeps the previous checkpoint.
+    void save_contraction_checkpoint(const CHGraph::Graph &graph, const CHGraph::ContractionState &state,
+                                     const std::string &checkpoint_file);
+
+    // Throws std::runtime_error if the file is damaged or was written for another graph
+    void load_contraction_checkpoint(const std::string &checkpoint_file, const CHGraph::Graph &graph,
+                                     CHGraph::ContractionState &state);
+
+    // Binary and checksummed contraction order, PreprocGraph::ranks, to contract a graph again with new weights
+    void save_ranks(const std::vector<int> &ranks, const std::string &ranks_file);
+
+    void load_ranks(const std::string &ranks_file, std::vector<int> &ranks);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef __GRAPH_NORMALIZATION_HPP__
+#define __GRAPH_NORMALIZATION_HPP__
+
+#include "ch_graph.hpp"
+#include <vector>
+
+namespace CHGraph
+{
+    // Node ids before and after normalize_graph
+    struct NodeMapping
+    {
+        std::vector<int> to_normalized; // to_normalized[original node] = normalized node, -1 if it was removed
+        std::vector<int> to_original;   // to_original[normalized node] = original node
+    };
+
+    // Keeps the lightest of the parallel arcs u -> v, drops self loops and sorts the arcs of every node by
+    // target, neither changes any shortest path. remove_isolated_nodes also drops the nodes left without
+    // arcs and renumbers the others in their original order, otherwise the ids stay the same.
+    void normalize_graph(const Graph &graph, Graph &normalized_graph, NodeMapping &mapping,
+                         const bool remove_isolated_nodes = false);
+
+    // False if an end point was removed or is out of range. A removed node only reaches itself, so its
+    // route is 0 for source == target and infinite otherwise.
+    bool normalize_destination(const NodeMapping &mapping, const Destination &destination, Destination &normalized_destination);
+    // Translates route.nodes back to original ids
+    void denormalize_route(const NodeMapping &mapping, Route &route);
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __HIERARCHY_QUALITY_HPP__
+#define __HIERARCHY_QUALITY_HPP__
+
+#include "ch_graph.hpp"
+#include "measurement.hpp"
+
+namespace CHGraph
+{
+    // Size of a contraction hierarchy independent of any query set. A search space holds every node
+    // reachable over upward arcs, the node itself included, as an upward search without stall-on-demand
+    // or pruning would settle them; it is computed for the sampled nodes only, everything else for all nodes.
+    struct HierarchyQuality
+    {
+        int node_number = 0;
+        int sampled_nodes = 0;
+        long long forward_arcs = 0;
+        long long backward_arcs = 0;
+        long long shortcuts = 0;           // arcs of both graphs with a mid node
+
+        Histogram forward_search_space;    // nodes per sampled node
+        Histogram backward_search_space;
+        Histogram forward_search_arcs;     // arcs scanned per sampled node
+        Histogram backward_search_arcs;
+        Histogram forward_degree;          // forward arcs per node
+        Histogram backward_degree;
+        Histogram depth;                   // nodes on the longest upward path from every node, max() is the depth of the hierarchy
+    };
+
+    // sample_size = 0 or at least the node number analyzes the search spaces of all nodes, otherwise of
+    // sample_size nodes drawn with seed. The search spaces are explored in parallel.
+    void analyze_hierarchy(const PreprocGraph &preproc_graph, HierarchyQuality &quality,
+                           const int sample_size = 0, const unsigned int seed = 0);
+}
+
+#endif
@@ -6,9 +6,46 @@
 #include <string>
 #include "timer.hpp"
 
+using MetricId = int;
+
+// Log-bucketed histogram of non-negative values with constant memory. Values below
+// 2^HISTOGRAM_PRECISION_BITS are counted exactly, larger values with a relative error
+// below 2^-(HISTOGRAM_PRECISION_BITS - 1). Count, min, max and mean are exact.
+class Histogram
+{
+private:
+    std::vector<long long> m_counts;
+    long long m_count = 0;
+    TimerTime m_min = 0;
+    TimerTime m_max = 0;
+    double m_sum = 0.0;
+public:
+    Histogram();
+    void record(const TimerTime value);
+    // Adds every value recorded in other
+    void merge(const Histogram &other);
+    long long count() const;
+    TimerTime min() const;
+    TimerTime max() const;
+    double mean() const;
+    // Smallest recorded value (up to bucket precision) not exceeded by percentile % of the values
+    TimerTime value_at_percentile(const double percentile) const;
+};
+
 struct Measurement
 {
+    // Raw values, one column each in dump_measurement
     std::unordered_map<std::string, std::vector<TimerTime>> data;
+
+    // -------- Registered metrics, metric_names[id] and histograms[id] belong to MetricId id --------
+    std::vector<std::string> metric_names;
+    std::vector<Histogram> histograms;
+    std::unordered_map<std::string, MetricId> metric_ids;
+
+    // Returns the id of the metric, registering it on first use
+    MetricId register_metric(const std::string &name);
+    void record(const MetricId metric, const TimerTime value);
+    void record(const MetricId metric, const Histogram &values);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,62 @@
+#ifndef __OVERLAY_GRAPH_HPP__
+#define __OVERLAY_GRAPH_HPP__
+
+#include "ch_graph.hpp"
+#include <vector>
+
+namespace CHGraph
+{
+    // One level of a nested multi-level partition. Entry nodes have an incoming arc from
+    // another cell of the level, exit nodes an outgoing arc to another cell.
+    struct OverlayLevel
+    {
+        int cell_number = 0;
+        std::vector<int> cells; // cells[node] = cell of node on this level
+
+        // -------- Nodes grouped by cell, node_index[node] = position of node inside its cell --------
+        std::vector<int> node_first;
+        std::vector<int> nodes;
+        std::vector<int> node_index;
+
+        // -------- Boundary nodes grouped by cell, -1 in entry_index / exit_index for other nodes --------
+        std::vector<int> entry_first;
+        std::vector<int> entries;
+        std::vector<int> entry_index;
+        std::vector<int> exit_first;
+        std::vector<int> exits;
+        std::vector<int> exit_index;
+
+        // Offset of the entries x exits clique matrix of each cell
+        std::vector<int> clique_first;
+    };
+
+    // Metric independent part of the multi-level overlay, levels[0] is the finest partition
+    // and every cell of levels[l] is a union of cells of levels[l - 1]
+    struct OverlayPartition
+    {
+        std::vector<OverlayLevel> levels;
+
+        // -------- Reverse input graph, reverse_arc[e] = index of the arc in Graph::to --------
+        std::vector<int> reverse_first_out;
+        std::vector<int> reverse_tail;
+        std::vector<int> reverse_arc;
+    };
+
+    // Result of customizing an OverlayPartition with one metric
+    struct OverlayMetric
+    {
+        std::vector<double> weights;             // weights[e] = weight of Graph::to[e]
+        std::vector<std::vector<double>> cliques; // cliques[level][clique_first[cell] + entry * exit_count + exit]
+    };
+
+    // cell_numbers lists the number of cells per level, from the finest level to the coarsest
+    void preproc_overlay_partition(const Graph &graph, const std::vector<int> &cell_numbers, OverlayPartition &partition);
+
+    void customize_overlay(const Graph &graph, const OverlayPartition &partition, const std::vector<double> &weights,
+                           OverlayMetric &metric);
+
+    void query_route_overlay(const Graph &graph, const OverlayPartition &partition, const OverlayMetric &metric,
+                             const Destination &destination, Route &route);
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef __PARALLEL_HPP__
+#define __PARALLEL_HPP__
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+namespace Parallel
+{
+    // Ranges smaller than this are processed on the calling thread
+    constexpr int MIN_PARALLEL_RANGE = 1024;
+
+    inline int thread_number()
+    {
+        const unsigned int hardware_threads = std::thread::hardware_concurrency();
+        return hardware_threads == 0 ? 1 : static_cast<int>(hardware_threads);
+    }
+
+    // Calls func(ind) for every ind in [begin, end), splitting the range into
+    // contiguous blocks, one block per thread. Each thread gets at least min_range indices.
+    template <typename Func>
+    void parallel_for(const int begin, const int end, Func func, const int min_range = MIN_PARALLEL_RANGE)
+    {
+        const int size = end - begin;
+        const int threads = std::min(thread_number(), std::max(1, size / std::max(1, min_range)));
+
+        if (threads <= 1)
+        {
+            for (int ind = begin; ind < end; ++ind)
+                func(ind);
+            return;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        const int block = (size + threads - 1) / threads;
+
+        for (int thread_ind = 0; thread_ind < threads; ++thread_ind)
+        {
+            const int block_begin = begin + thread_ind * block;
+            const int block_end = std::min(end, block_begin + block);
+            if (block_begin >= block_end)
+                break;
+
+            workers.emplace_back([block_begin, block_end, &func]()
+            {
+                for (int ind = block_begin; ind < block_end; ++ind)
+                    func(ind);
+            });
+        }
+
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    // Blocking FIFO queue holding at most capacity items, shared by producer and consumer threads
+    template <typename Item>
+    class BoundedQueue
+    {
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_not_empty;
+        std::condition_variable m_not_full;
+        std::deque<Item> m_items;
+        std::size_t m_capacity;
+        bool m_closed = false;
+    public:
+        explicit BoundedQueue(const std::size_t capacity) : m_capacity(std::max<std::size_t>(1, capacity)) {}
+
+        // Waits while the queue is full, false if the queue was closed
+        bool push(Item item)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_full.wait(lock, [this]() { return m_closed || m_items.size() < m_capacity; });
+            if (m_closed)
+                return false;
+
+            m_items.push_back(std::move(item));
+            m_not_empty.notify_one();
+            return true;
+        }
+
+        // Waits while the queue is empty, false once the queue is closed and drained
+        bool pop(Item &item)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_not_empty.wait(lock, [this]() { return m_closed || !m_items.empty(); });
+            if (m_items.empty())
+                return false;
+
+            item = std::move(m_items.front());
+            m_items.pop_front();
+            m_not_full.notify_one();
+            return true;
+        }
+
+        // No more pushes, waiting consumers drain the remaining items
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_not_empty.notify_all();
+            m_not_full.notify_all();
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef __PARTITION_HPP__
+#define __PARTITION_HPP__
+
+#include "ch_graph.hpp"
+#include <vector>
+
+namespace CHGraph
+{
+    // Splits the nodes into cell_number cells grown by BFS around seeds chosen by
+    // farthest point selection, cells[node] = cell of node
+    void partition_graph(const Graph &graph, const int cell_number, std::vector<int> &cells);
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef __PERF_COUNTERS_HPP__
+#define __PERF_COUNTERS_HPP__
+
+#include <array>
+#include <cstdint>
+
+enum class PerfEvent
+{
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_READ_MISSES,
+    LLC_MISSES,
+    BRANCH_MISSES
+};
+
+constexpr int PERF_EVENT_NUMBER = 5;
+
+// User space hardware counters of the calling thread and of the threads it starts, opened as inherited
+// Linux perf_events. Counts of a started thread are added when it exits, so threads have to be joined
+// before stop, as parallel_for and the query pipeline do. Inherited events can not form a group, each is
+// read on its own. Events the kernel refuses (no PMU, perf_event_paranoid, seccomp in containers) are
+// unavailable, start and stop still work and only the available events are counted.
+class PerfCounters
+{
+private:
+    // -1 if unavailable
+    std::array<int, PERF_EVENT_NUMBER> m_fds;
+    bool m_running = false;
+    // value, time_enabled and time_running at start, a reset would not clear the counts of exited threads
+    std::array<std::array<std::uint64_t, 3>, PERF_EVENT_NUMBER> m_start_values;
+    std::array<long long, PERF_EVENT_NUMBER> m_results;
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool available() const;
+    bool available(const PerfEvent event) const;
+
+    void start();
+    void stop();
+    // Count of event between the last start and stop, scaled up if the kernel multiplexed it
+    long long get_result(const PerfEvent event) const;
+
+    static const char *event_name(const PerfEvent event);
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef __PREPROC_CHECKPOINT_HPP__
+#define __PREPROC_CHECKPOINT_HPP__
+
+#include "ch_graph.hpp"
+#include "timer.hpp"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace CHGraph
+{
+    enum class ContractionMethod : std::uint32_t
+    {
+        BOTTOM_UP,
+        TOP_DOWN
+    };
+
+    // Everything a contraction needs to continue after its last contracted node
+    struct ContractionState
+    {
+        ContractionMethod method = ContractionMethod::BOTTOM_UP;
+        int contracted_nodes = 0;               // bottom up: next rank, top down: next position in the order
+        std::vector<int> ranks;                 // bottom up: -1 for uncontracted nodes
+        std::vector<unsigned char> contracted;
+
+        // Adjacency lists with the shortcuts so far, list v is arcs[first_out[v]], ..., arcs[first_out[v + 1] - 1]
+        std::vector<int> out_first_out;
+        std::vector<CHArc> out_arcs;
+        std::vector<int> in_first_out;
+        std::vector<CHArc> in_arcs;
+
+        std::vector<CHArc> shortcuts;        // bottom up: shortcuts in the order they were added
+        std::vector<int> queue_priorities;   // bottom up: entries of the priority queue
+        std::vector<int> queue_nodes;
+    };
+
+    // Periodic checkpoints of a contraction. A run resumes from file if it exists, writes it whenever
+    // interval passed since the last one and removes it when the contraction is done. The result equals
+    // that of an uninterrupted run, search statistics only count the resumed part.
+    struct PreprocCheckpoint
+    {
+        std::string file;
+        ChronoTime interval = std::chrono::minutes(5);
+        int resumed_nodes = 0; // set by the run, contracted nodes taken over from file
+    };
+}
+
+#endif
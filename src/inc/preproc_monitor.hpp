@@ -0,0 +1,51 @@
+#ifndef __PREPROC_MONITOR_HPP__
+#define __PREPROC_MONITOR_HPP__
+
+#include "measurement.hpp"
+#include "timer.hpp"
+#include <array>
+#include <chrono>
+#include <functional>
+
+namespace CHGraph
+{
+    enum class PreprocPhase
+    {
+        ADJACENCY,  // adjacency lists of the input graph
+        PRIORITIES, // initial node priorities or contraction order
+        CONTRACTION,
+        ASSEMBLY    // forward and backward CSR arrays
+    };
+
+    constexpr int PREPROC_PHASE_NUMBER = 4;
+
+    const char *preproc_phase_name(const PreprocPhase phase);
+
+    struct PreprocProgress
+    {
+        int contracted_nodes = 0;
+        int node_number = 0;
+        long long remaining_arcs = 0; // arcs between uncontracted nodes, shortcuts included
+        double average_degree = 0.0;  // remaining_arcs per uncontracted node
+        long long shortcuts = 0;      // shortcut arcs added so far
+        TimerTime elapsed = 0;        // nanoseconds since the contraction started
+        TimerTime eta = 0;            // estimated nanoseconds until the contraction ends
+    };
+
+    struct PreprocProfile
+    {
+        std::array<TimerTime, PREPROC_PHASE_NUMBER> phase_times{}; // nanoseconds, indexed by PreprocPhase
+        Histogram contraction_costs;                               // nanoseconds per contracted node
+    };
+
+    // Observes one preprocessing run. progress is called at most every progress_interval during
+    // the contraction and once when it ends, profile is overwritten by the run.
+    struct PreprocMonitor
+    {
+        std::function<void(const PreprocProgress &)> progress;
+        ChronoTime progress_interval = std::chrono::seconds(1);
+        PreprocProfile profile;
+    };
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __QUERY_PIPELINE_HPP__
+#define __QUERY_PIPELINE_HPP__
+
+#include "ch_graph.hpp"
+#include "parallel.hpp"
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+namespace CHGraph
+{
+    struct QueryResult
+    {
+        Destination destination;
+        double total_weight = 0;
+    };
+
+    struct QueryPipelineOptions
+    {
+        int worker_number = Parallel::thread_number();
+        std::size_t max_batches_in_flight = 16; // batches read but not yet handed to the sink
+    };
+
+    // Fills the batch with the next destinations, false once there are none left
+    using DestinationSource = std::function<bool(std::vector<Destination> &)>;
+    using QueryFunction = std::function<void(const Destination &, Route &)>;
+    using ResultSink = std::function<void(const std::vector<QueryResult> &)>;
+
+    // Reads batches on the calling thread, answers them with query on worker threads and hands
+    // the results to sink on a writer thread in input order. The first exception thrown by
+    // source, query or sink stops the pipeline and is rethrown.
+    void run_query_pipeline(const DestinationSource &source, const QueryFunction &query, const ResultSink &sink,
+                            const QueryPipelineOptions &options = QueryPipelineOptions{});
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef __SEARCH_STATS_HPP__
+#define __SEARCH_STATS_HPP__
+
+// Statistics are only collected in builds with CH_SEARCH_STATS defined (make build SEARCH_STATS=1),
+// otherwise SEARCH_STATS_ADD compiles to nothing and every counter stays 0
+#ifdef CH_SEARCH_STATS
+constexpr bool SEARCH_STATS_ENABLED = true;
+#else
+constexpr bool SEARCH_STATS_ENABLED = false;
+#endif
+
+#define SEARCH_STATS_ADD(counter, value)     \
+    do                                       \
+    {                                        \
+        if constexpr (SEARCH_STATS_ENABLED)  \
+            counter += value;                \
+    } while (0)
+
+namespace CHGraph
+{
+    struct QueryStats
+    {
+        long long settled_nodes = 0;
+        long long stalled_nodes = 0;  // settled but not expanded because of stall-on-demand
+        long long relaxed_arcs = 0;
+        long long queue_pushes = 0;
+    };
+
+    struct PreprocStats
+    {
+        long long witness_searches = 0;
+        long long witness_settled_nodes = 0;
+        long long shortcuts_added = 0;
+    };
+}
+
+#endif
@@ -1,11 +1,22 @@
 #ifndef __TIMER_HPP__
 #define __TIMER_HPP__
 
+#include "perf_counters.hpp"
 #include <chrono>
+#include <cstdint>
+#include <memory>
 
 using TimerTime = long long;
 using ChronoTime = std::chrono::nanoseconds;
 
+enum class TimerBackend
+{
+    CHRONO,
+    // Fenced rdtsc/rdtscp, calibrated against steady_clock on first use. Its own
+    // start/stop overhead is subtracted from every result. x86 with an invariant TSC only.
+    TSC
+};
+
 class Timer
 {
 private:
@@ -17,14 +28,29 @@ private:
     };
 
     Timer::State m_state = Timer::State::INITIAL;
-    
+    TimerBackend m_backend = TimerBackend::CHRONO;
+
     std::chrono::time_point<std::chrono::high_resolution_clock> m_start;
     std::chrono::time_point<std::chrono::high_resolution_clock> m_end;
+    std::uint64_t m_start_ticks = 0;
+    std::uint64_t m_end_ticks = 0;
+
+    std::unique_ptr<PerfCounters> m_counters;
 public:
     Timer() {};
+    // count_events opens hardware counters that run between every start and stop
+    explicit Timer(const TimerBackend backend, const bool count_events = false);
     void start();
     void stop();
+    // Nanoseconds between start and stop
     TimerTime get_result() const;
+    // Counters of the last measured region, nullptr if they were not requested or none is available
+    const PerfCounters *counters() const;
+
+    // True on x86 processors with an invariant TSC (CPUID 0x80000007, EDX bit 8)
+    static bool tsc_available();
+    // Calibrated length of one TSC tick in nanoseconds
+    static double tsc_tick_time();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,62 @@
+#ifndef __TRACE_HPP__
+#define __TRACE_HPP__
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+// Spans are only recorded in builds with CH_TRACE defined (make build TRACE=1), otherwise
+// TRACE_SCOPE compiles to nothing
+#ifdef CH_TRACE
+constexpr bool TRACE_ENABLED = true;
+#else
+constexpr bool TRACE_ENABLED = false;
+#endif
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Records a span from here to the end of the enclosing scope
+#ifdef CH_TRACE
+#define TRACE_SCOPE(name) const Trace::Span TRACE_CONCAT(trace_span_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) \
+    do                    \
+    {                     \
+    } while (0)
+#endif
+
+namespace Trace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t DEFAULT_BUFFER_EVENTS = 1 << 16;
+
+    // Starts recording spans into one ring buffer of buffer_events spans per thread, the oldest
+    // spans of a thread are overwritten once its buffer is full. The spans are written to
+    // output_file as Chrome Trace Event JSON by flush, stop or at exit.
+    void start(const std::string &output_file, const std::size_t buffer_events = DEFAULT_BUFFER_EVENTS);
+    // Writes the remaining spans and stops recording
+    void stop();
+    // Rewrites output_file with the spans still in the buffers, no thread may record meanwhile
+    void flush();
+    bool enabled();
+
+    // name is written at flush, so it has to live until then; intern keeps names built at runtime
+    void record(const char *name, const Clock::time_point begin, const Clock::time_point end);
+    const char *intern(const std::string &name);
+
+    class Span
+    {
+    private:
+        const char *m_name;
+        Clock::time_point m_begin;
+    public:
+        explicit Span(const char *name);
+        ~Span();
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+    };
+}
+
+#endif
@@ -0,0 +1,239 @@
+#include "ch_graph.hpp"
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <functional>
+#include <utility>
+#include <algorithm>
+
+
+// Alternative is at most (1 + ALTERNATIVE_STRETCH) times longer than the shortest route
+constexpr double ALTERNATIVE_STRETCH = 0.25;
+// Alternative shares at most ALTERNATIVE_SHARING times the shortest distance with any accepted route
+constexpr double ALTERNATIVE_SHARING = 0.8;
+// Subpaths around the via node up to ALTERNATIVE_LOCAL_OPTIMALITY times the shortest distance are shortest paths
+constexpr double ALTERNATIVE_LOCAL_OPTIMALITY = 0.25;
+// Relative tolerance when comparing route lengths
+constexpr double ALTERNATIVE_TOLERANCE = 1e-9;
+
+
+namespace
+{
+    // Exhaustive upward search from one end point, forward or backward
+    struct UpwardSearch
+    {
+        std::vector<double> dist;
+        std::vector<int> prev;     // parent in the search tree
+        std::vector<int> prev_mid; // mid node of the tree arc, -1 for original arcs
+        std::vector<char> stalled;
+        std::vector<int> settled;
+    };
+}
+
+
+static void upward_search(const CHGraph::PreprocGraph &preproc_graph, int source, bool forward, UpwardSearch &search)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const int n = static_cast<int>(preproc_graph.ranks.size());
+
+    search.dist.assign(n, INF);
+    search.prev.assign(n, -1);
+    search.prev_mid.assign(n, -1);
+    search.stalled.assign(n, 0);
+    search.settled.clear();
+
+    const std::vector<int> &first_out = forward ? preproc_graph.forward_first_out : preproc_graph.backward_first_out;
+    const std::vector<CHGraph::CHArc> &arcs = forward ? preproc_graph.forward_arcs : preproc_graph.backward_arcs;
+
+    using QItem = std::pair<double, int>;
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
+
+    search.dist[source] = 0.0;
+    pq.push(QItem(0.0, source));
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.top();
+        pq.pop();
+
+        if (d > search.dist[u])
+            continue;
+
+        search.settled.push_back(u);
+
+        const bool stall = forward ? CHGraph::stall_forward(u, search.dist, preproc_graph)
+                                   : CHGraph::stall_backward(u, search.dist, preproc_graph);
+        if (stall)
+        {
+            search.stalled[u] = 1;
+            continue;
+        }
+
+        for (int e = first_out[u]; e < first_out[u + 1]; ++e)
+        {
+            const CHGraph::CHArc &arc = arcs[e];
+            const double new_distance = d + arc.weight;
+            if (new_distance < search.dist[arc.to])
+            {
+                search.dist[arc.to] = new_distance;
+                search.prev[arc.to] = u;
+                search.prev_mid[arc.to] = arc.mid_node;
+                pq.push(QItem(new_distance, arc.to));
+            }
+        }
+    }
+}
+
+// Distance from the root to the last common node of the tree paths to a and b
+static double shared_tree_distance(const UpwardSearch &search, int a, int b, std::vector<int> &mark, int &stamp)
+{
+    const int current_stamp = stamp++;
+    for (int x = a; x != -1; x = search.prev[x])
+        mark[x] = current_stamp;
+
+    for (int x = b; x != -1; x = search.prev[x])
+        if (mark[x] == current_stamp)
+            return search.dist[x];
+
+    return 0.0;
+}
+
+// Tree ancestor of v that is at least min_dist away from v, or the root
+static int tree_ancestor(const UpwardSearch &search, int v, double min_dist)
+{
+    int x = v;
+    while (search.prev[x] != -1 && search.dist[v] - search.dist[x] < min_dist)
+        x = search.prev[x];
+    return x;
+}
+
+static void unpack_via_route(const CHGraph::PreprocGraph &preproc_graph, const UpwardSearch &forward_search,
+                             const UpwardSearch &backward_search, int source, int via, CHGraph::Route &route)
+{
+    route.total_weight = forward_search.dist[via] + backward_search.dist[via];
+    route.nodes.clear();
+
+    std::vector<int> chain;
+    for (int x = via; x != -1; x = forward_search.prev[x])
+        chain.push_back(x);
+
+    route.nodes.push_back(source);
+    for (int ind = static_cast<int>(chain.size()) - 1; ind > 0; --ind)
+        CHGraph::unpack_arc(preproc_graph, chain[ind], chain[ind - 1], forward_search.prev_mid[chain[ind - 1]], route.nodes);
+
+    for (int x = via; backward_search.prev[x] != -1; x = backward_search.prev[x])
+        CHGraph::unpack_arc(preproc_graph, x, backward_search.prev[x], backward_search.prev_mid[x], route.nodes);
+}
+
+void CHGraph::query_alternative_routes(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph,
+                                       const CHGraph::Destination &destination, const int max_alternative_number,
+                                       std::vector<CHGraph::Route> &routes)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const int n = static_cast<int>(preproc_graph.ranks.size());
+    const int s = destination.source;
+    const int t = destination.target;
+
+    routes.assign(1, CHGraph::Route{INF, {}});
+
+    if (n <= 0 || s < 0 || s >= n || t < 0 || t >= n)
+        return;
+
+    if (s == t)
+    {
+        routes[0].total_weight = 0.0;
+        routes[0].nodes.push_back(s);
+        return;
+    }
+
+    UpwardSearch forward_search, backward_search;
+    upward_search(preproc_graph, s, true, forward_search);
+    upward_search(preproc_graph, t, false, backward_search);
+
+    // Via node candidates are nodes settled and not stalled in both search spaces
+
+    std::vector<std::pair<double, int>> candidates;
+    double best_dist = INF;
+    int meeting_node = -1;
+    for (int v : forward_search.settled)
+    {
+        if (forward_search.stalled[v] || backward_search.stalled[v] || backward_search.dist[v] == INF)
+            continue;
+
+        const double length = forward_search.dist[v] + backward_search.dist[v];
+        candidates.emplace_back(length, v);
+        if (length < best_dist)
+        {
+            best_dist = length;
+            meeting_node = v;
+        }
+    }
+
+    if (meeting_node == -1)
+        return;
+
+    unpack_via_route(preproc_graph, forward_search, backward_search, s, meeting_node, routes[0]);
+
+    std::sort(candidates.begin(), candidates.end());
+
+    std::vector<int> accepted_via{meeting_node};
+    std::vector<int> mark(n, -1);
+    int stamp = 0;
+
+    for (auto &[length, v] : candidates)
+    {
+        if (static_cast<int>(routes.size()) > max_alternative_number)
+            break;
+        if (length > (1.0 + ALTERNATIVE_STRETCH) * best_dist)
+            break;
+
+        // Limited sharing with every accepted route, measured on the packed search trees
+        bool shares_too_much = false;
+        for (int via : accepted_via)
+        {
+            const double shared = shared_tree_distance(forward_search, via, v, mark, stamp) +
+                                  shared_tree_distance(backward_search, via, v, mark, stamp);
+            if (shared > ALTERNATIVE_SHARING * best_dist)
+            {
+                shares_too_much = true;
+                break;
+            }
+        }
+        if (shares_too_much)
+            continue;
+
+        // Local optimality (T-test): the subpath u -> v -> w around the via node is a shortest path
+        const double local_dist = ALTERNATIVE_LOCAL_OPTIMALITY * best_dist;
+        const int u = tree_ancestor(forward_search, v, local_dist);
+        const int w = tree_ancestor(backward_search, v, local_dist);
+        const double subpath_length = (forward_search.dist[v] - forward_search.dist[u]) +
+                                      (backward_search.dist[v] - backward_search.dist[w]);
+
+        CHGraph::Route local_route;
+        CHGraph::query_route(graph, preproc_graph, CHGraph::Destination{.source = u, .target = w}, local_route);
+        if (local_route.total_weight < subpath_length * (1.0 - ALTERNATIVE_TOLERANCE))
+            continue;
+
+        // Only accepted candidates are unpacked, routes with repeated nodes are dropped
+        CHGraph::Route route;
+        unpack_via_route(preproc_graph, forward_search, backward_search, s, v, route);
+
+        bool simple = true;
+        const int current_stamp = stamp++;
+        for (int x : route.nodes)
+        {
+            if (mark[x] == current_stamp)
+            {
+                simple = false;
+                break;
+            }
+            mark[x] = current_stamp;
+        }
+        if (!simple)
+            continue;
+
+        accepted_via.push_back(v);
+        routes.push_back(std::move(route));
+    }
+}
@@ -0,0 +1,193 @@
+#include "arc_flags.hpp"
+#include "partition.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <functional>
+#include <utility>
+#include <stdexcept>
+#include <string>
+
+
+// Relative tolerance when checking whether an arc lies on a shortest path
+constexpr double ARC_FLAGS_TOLERANCE = 1e-9;
+
+
+// Dijkstra on the input graph (forward) or its reverse, from source
+static void graph_dijkstra(const std::vector<int> &first_out, const std::vector<int> &head, const std::vector<double> &weights,
+                           int source, std::vector<double> &dist)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    std::fill(dist.begin(), dist.end(), INF);
+
+    using QItem = std::pair<double, int>;
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
+
+    dist[source] = 0.0;
+    pq.push(QItem(0.0, source));
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.top();
+        pq.pop();
+
+        if (d > dist[u])
+            continue;
+
+        for (int e = first_out[u]; e < first_out[u + 1]; ++e)
+        {
+            const double nd = d + weights[e];
+            if (nd < dist[head[e]])
+            {
+                dist[head[e]] = nd;
+                pq.push(QItem(nd, head[e]));
+            }
+        }
+    }
+}
+
+// True if an arc of the given weight followed by a path of length rest_dist is as short as total_dist
+static bool on_shortest_path(double rest_dist, double weight, double total_dist)
+{
+    return rest_dist < std::numeric_limits<double>::infinity() &&
+           rest_dist + weight <= total_dist + ARC_FLAGS_TOLERANCE * total_dist;
+}
+
+void CHGraph::preproc_arc_flags(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph,
+                                const int cell_number, CHGraph::ArcFlags &arc_flags)
+{
+    if (cell_number < 1 || cell_number > CHGraph::MAX_ARC_FLAGS_CELL_NUMBER)
+    {
+        throw std::invalid_argument("Number of arc flags cells should be between 1 and " +
+                                    std::to_string(CHGraph::MAX_ARC_FLAGS_CELL_NUMBER));
+    }
+
+    const int n = static_cast<int>(preproc_graph.ranks.size());
+    const int forward_m = static_cast<int>(preproc_graph.forward_arcs.size());
+    const int backward_m = static_cast<int>(preproc_graph.backward_arcs.size());
+
+    arc_flags = CHGraph::ArcFlags{};
+    arc_flags.cell_number = cell_number;
+    CHGraph::partition_graph(graph, cell_number, arc_flags.cells);
+    const std::vector<int> &cells = arc_flags.cells;
+
+    // Reverse input graph
+    std::vector<int> reverse_first_out(n + 1, 0), reverse_head(graph.to.size());
+    std::vector<double> reverse_weights(graph.to.size());
+    for (int v : graph.to)
+        reverse_first_out[v + 1]++;
+    for (int v = 0; v < n; ++v)
+        reverse_first_out[v + 1] += reverse_first_out[v];
+    {
+        std::vector<int> pos = reverse_first_out;
+        for (int u = 0; u < n; ++u)
+        {
+            for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+            {
+                reverse_head[pos[graph.to[e]]] = u;
+                reverse_weights[pos[graph.to[e]]++] = graph.weights[e];
+            }
+        }
+    }
+
+    // Entry nodes have an incoming arc from another cell, exit nodes an outgoing arc to another cell
+    std::vector<std::vector<int>> entries(cell_number), exits(cell_number);
+    {
+        std::vector<char> is_entry(n, 0), is_exit(n, 0);
+        for (int u = 0; u < n; ++u)
+        {
+            for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+            {
+                const int v = graph.to[e];
+                if (cells[u] != cells[v])
+                {
+                    is_exit[u] = 1;
+                    is_entry[v] = 1;
+                }
+            }
+        }
+        for (int v = 0; v < n; ++v)
+        {
+            if (is_entry[v])
+                entries[cells[v]].push_back(v);
+            if (is_exit[v])
+                exits[cells[v]].push_back(v);
+        }
+    }
+
+    // One flag vector per cell, cells are processed in parallel
+    std::vector<std::vector<char>> forward_cell_flags(cell_number), backward_cell_flags(cell_number);
+
+    auto compute_cell = [&](int cell)
+    {
+        std::vector<char> &forward = forward_cell_flags[cell];
+        std::vector<char> &backward = backward_cell_flags[cell];
+        forward.assign(forward_m, 0);
+        backward.assign(backward_m, 0);
+        std::vector<double> dist(n);
+
+        // A shortcut may jump over the boundary: past the last entry (before the first exit)
+        // a shortest path stays in the cell, so arcs ending (starting) in the cell are flagged
+        for (int e = 0; e < forward_m; ++e)
+            if (cells[preproc_graph.forward_arcs[e].to] == cell)
+                forward[e] = 1;
+        for (int e = 0; e < backward_m; ++e)
+            if (cells[preproc_graph.backward_arcs[e].to] == cell)
+                backward[e] = 1;
+
+        // Arcs before the last entry node: forward arc u -> v is flagged
+        // if dist(v, entry) + w = dist(u, entry)
+        for (int entry : entries[cell])
+        {
+            graph_dijkstra(reverse_first_out, reverse_head, reverse_weights, entry, dist);
+            for (int u = 0; u < n; ++u)
+            {
+                for (int e = preproc_graph.forward_first_out[u]; e < preproc_graph.forward_first_out[u + 1]; ++e)
+                {
+                    const CHGraph::CHArc &arc = preproc_graph.forward_arcs[e];
+                    if (!forward[e] && on_shortest_path(dist[arc.to], arc.weight, dist[u]))
+                        forward[e] = 1;
+                }
+            }
+        }
+
+        // Arcs after the first exit node: backward arc x -> y (original y -> x)
+        // is flagged if dist(exit, y) + w = dist(exit, x)
+        for (int exit : exits[cell])
+        {
+            graph_dijkstra(graph.first_out, graph.to, graph.weights, exit, dist);
+            for (int x = 0; x < n; ++x)
+            {
+                for (int e = preproc_graph.backward_first_out[x]; e < preproc_graph.backward_first_out[x + 1]; ++e)
+                {
+                    const CHGraph::CHArc &arc = preproc_graph.backward_arcs[e];
+                    if (!backward[e] && on_shortest_path(dist[arc.to], arc.weight, dist[x]))
+                        backward[e] = 1;
+                }
+            }
+        }
+    };
+
+    Parallel::parallel_for(0, cell_number, compute_cell, 1);
+
+    arc_flags.forward_flags.assign(forward_m, 0);
+    arc_flags.backward_flags.assign(backward_m, 0);
+    for (int cell = 0; cell < cell_number; ++cell)
+    {
+        const std::uint64_t bit = std::uint64_t{1} << cell;
+        for (int e = 0; e < forward_m; ++e)
+            if (forward_cell_flags[cell][e])
+                arc_flags.forward_flags[e] |= bit;
+        for (int e = 0; e < backward_m; ++e)
+            if (backward_cell_flags[cell][e])
+                arc_flags.backward_flags[e] |= bit;
+    }
+}
+
+std::size_t CHGraph::arc_flags_memory(const CHGraph::ArcFlags &arc_flags)
+{
+    return arc_flags.cells.size() * sizeof(int) +
+           (arc_flags.forward_flags.size() + arc_flags.backward_flags.size()) * sizeof(std::uint64_t);
+}
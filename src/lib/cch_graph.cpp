@@ -0,0 +1,402 @@
+#include "cch_graph.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <utility>
+
+
+// Parts of at most this size are not dissected further
+constexpr int DISSECTION_LEAF_SIZE = 8;
+// Minimal share of nodes on each side of a separator
+constexpr double DISSECTION_BALANCE = 0.3;
+
+
+static void build_undirected_adjacency(const CHGraph::Graph &graph, std::vector<std::vector<int>> &adj)
+{
+    const int n = graph.first_out.empty() ? 0 : static_cast<int>(graph.first_out.size()) - 1;
+    adj.assign(n, {});
+
+    for (int u = 0; u < n; ++u)
+    {
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+        {
+            const int v = graph.to[e];
+            if (v == u)
+                continue;
+            adj[u].push_back(v);
+            adj[v].push_back(u);
+        }
+    }
+
+    for (int u = 0; u < n; ++u)
+    {
+        std::sort(adj[u].begin(), adj[u].end());
+        adj[u].erase(std::unique(adj[u].begin(), adj[u].end()), adj[u].end());
+    }
+}
+
+void CHGraph::order_nested_dissection(const CHGraph::Graph &graph, std::vector<int> &ranks)
+{
+    std::vector<std::vector<int>> adj;
+    build_undirected_adjacency(graph, adj);
+    const int n = static_cast<int>(adj.size());
+
+    struct Task
+    {
+        std::vector<int> nodes;
+        bool emit; // true: nodes form a separator and are appended to the order as they are
+    };
+
+    std::vector<int> order;
+    order.reserve(n);
+
+    std::vector<int> region(n, -1);  // region[node] = stamp of the task the node belongs to
+    std::vector<int> visited(n, -1); // visited[node] = stamp of the last BFS that reached node
+    std::vector<int> dist(n, 0);
+    int stamp = 0;
+
+    // BFS restricted to the current region, returns nodes in visiting order
+    auto bfs = [&](int source, int region_stamp, std::vector<int> &reached)
+    {
+        const int bfs_stamp = stamp++;
+        reached.clear();
+        reached.push_back(source);
+        visited[source] = bfs_stamp;
+        dist[source] = 0;
+
+        for (std::size_t head = 0; head < reached.size(); ++head)
+        {
+            const int u = reached[head];
+            for (int v : adj[u])
+            {
+                if (region[v] != region_stamp || visited[v] == bfs_stamp)
+                    continue;
+                visited[v] = bfs_stamp;
+                dist[v] = dist[u] + 1;
+                reached.push_back(v);
+            }
+        }
+    };
+
+    std::vector<Task> tasks;
+    {
+        std::vector<int> all_nodes(n);
+        for (int v = 0; v < n; ++v)
+            all_nodes[v] = v;
+        tasks.push_back(Task{std::move(all_nodes), false});
+    }
+
+    std::vector<int> reached;
+
+    while (!tasks.empty())
+    {
+        Task task = std::move(tasks.back());
+        tasks.pop_back();
+
+        if (task.emit || static_cast<int>(task.nodes.size()) <= DISSECTION_LEAF_SIZE)
+        {
+            order.insert(order.end(), task.nodes.begin(), task.nodes.end());
+            continue;
+        }
+
+        const int region_stamp = stamp++;
+        for (int v : task.nodes)
+            region[v] = region_stamp;
+
+        // Split into connected components first
+        bfs(task.nodes.front(), region_stamp, reached);
+        if (reached.size() < task.nodes.size())
+        {
+            const int component_stamp = visited[task.nodes.front()];
+            std::vector<int> rest;
+            for (int v : task.nodes)
+                if (visited[v] != component_stamp)
+                    rest.push_back(v);
+
+            tasks.push_back(Task{std::move(rest), false});
+            tasks.push_back(Task{reached, false});
+            continue;
+        }
+
+        // Pseudo-peripheral node as BFS root, BFS levels as candidate separators
+        bfs(reached.back(), region_stamp, reached);
+        const int max_level = dist[reached.back()];
+
+        if (max_level < 2)
+        {
+            order.insert(order.end(), task.nodes.begin(), task.nodes.end());
+            continue;
+        }
+
+        std::vector<int> level_size(max_level + 1, 0);
+        for (int v : reached)
+            level_size[dist[v]]++;
+
+        const int size = static_cast<int>(reached.size());
+        const int min_side = static_cast<int>(DISSECTION_BALANCE * size);
+
+        int separator_level = -1;
+        int below = level_size[0];
+        int median_level = 1;
+        for (int level = 1; level < max_level; ++level)
+        {
+            const int above = size - below - level_size[level];
+            if (below < size / 2)
+                median_level = level;
+
+            if (below >= min_side && above >= min_side &&
+                (separator_level == -1 || level_size[level] < level_size[separator_level]))
+            {
+                separator_level = level;
+            }
+            below += level_size[level];
+        }
+
+        if (separator_level == -1)
+            separator_level = median_level;
+
+        std::vector<int> lower_part, upper_part, separator;
+        for (int v : reached)
+        {
+            if (dist[v] < separator_level)
+                lower_part.push_back(v);
+            else if (dist[v] > separator_level)
+                upper_part.push_back(v);
+            else
+                separator.push_back(v);
+        }
+
+        // Separator is ordered after (above) both parts
+        tasks.push_back(Task{std::move(separator), true});
+        tasks.push_back(Task{std::move(upper_part), false});
+        tasks.push_back(Task{std::move(lower_part), false});
+    }
+
+    ranks.assign(n, -1);
+    for (int ind = 0; ind < n; ++ind)
+        ranks[order[ind]] = ind;
+}
+
+void CHGraph::preproc_graph_cch(const CHGraph::Graph &graph, CHGraph::CCHTopology &topology)
+{
+    topology = CHGraph::CCHTopology{};
+    order_nested_dissection(graph, topology.ranks);
+
+    const std::vector<int> &ranks = topology.ranks;
+    const int n = static_cast<int>(ranks.size());
+
+    std::vector<std::vector<int>> up(n);
+    {
+        std::vector<std::vector<int>> adj;
+        build_undirected_adjacency(graph, adj);
+        for (int u = 0; u < n; ++u)
+            for (int v : adj[u])
+                if (ranks[u] < ranks[v])
+                    up[u].push_back(v);
+    }
+
+    auto by_rank = [&](int a, int b) { return ranks[a] < ranks[b]; };
+
+    std::vector<int> order(n);
+    for (int v = 0; v < n; ++v)
+        order[ranks[v]] = v;
+
+    // Chordal completion: eliminating x turns its upper neighbourhood into a clique.
+    // It is enough to pass the neighbourhood to the lowest upper neighbour.
+    for (int x : order)
+    {
+        std::sort(up[x].begin(), up[x].end(), by_rank);
+        up[x].erase(std::unique(up[x].begin(), up[x].end()), up[x].end());
+
+        if (up[x].size() < 2)
+            continue;
+
+        const int parent = up[x].front();
+        up[parent].insert(up[parent].end(), up[x].begin() + 1, up[x].end());
+    }
+
+    topology.up_first_out.assign(n + 1, 0);
+    for (int u = 0; u < n; ++u)
+        topology.up_first_out[u + 1] = topology.up_first_out[u] + static_cast<int>(up[u].size());
+
+    const int m = topology.up_first_out[n];
+    topology.up_head.reserve(m);
+    for (int u = 0; u < n; ++u)
+        topology.up_head.insert(topology.up_head.end(), up[u].begin(), up[u].end());
+
+    // Lower neighbours of every node, sorted by tail for triangle enumeration
+    topology.down_first_out.assign(n + 1, 0);
+    for (int a = 0; a < m; ++a)
+        topology.down_first_out[topology.up_head[a] + 1]++;
+    for (int v = 0; v < n; ++v)
+        topology.down_first_out[v + 1] += topology.down_first_out[v];
+
+    topology.down_tail.resize(m);
+    topology.down_arc.resize(m);
+    std::vector<int> pos = topology.down_first_out;
+    for (int u = 0; u < n; ++u)
+    {
+        for (int a = topology.up_first_out[u]; a < topology.up_first_out[u + 1]; ++a)
+        {
+            const int v = topology.up_head[a];
+            topology.down_tail[pos[v]] = u;
+            topology.down_arc[pos[v]] = a;
+            pos[v]++;
+        }
+    }
+
+    // Input arcs onto CCH arcs
+    const int input_m = static_cast<int>(graph.to.size());
+    topology.input_arc.assign(input_m, -1);
+    topology.input_upward.assign(input_m, 0);
+    for (int u = 0; u < n; ++u)
+    {
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+        {
+            const int v = graph.to[e];
+            if (u == v)
+                continue;
+
+            const bool upward = ranks[u] < ranks[v];
+            const int low = upward ? u : v;
+            const int high = upward ? v : u;
+
+            auto begin = topology.up_head.begin() + topology.up_first_out[low];
+            auto end = topology.up_head.begin() + topology.up_first_out[low + 1];
+            auto it = std::lower_bound(begin, end, high, by_rank);
+
+            topology.input_arc[e] = static_cast<int>(it - topology.up_head.begin());
+            topology.input_upward[e] = upward ? 1 : 0;
+        }
+    }
+
+    // Arc levels: an arc only depends on arcs at strictly lower levels
+    std::vector<int> node_level(n, 0);
+    int max_level = 0;
+    for (int u : order)
+    {
+        max_level = std::max(max_level, node_level[u]);
+        for (int a = topology.up_first_out[u]; a < topology.up_first_out[u + 1]; ++a)
+        {
+            const int v = topology.up_head[a];
+            node_level[v] = std::max(node_level[v], node_level[u] + 1);
+        }
+    }
+
+    topology.level_first.assign(max_level + 2, 0);
+    for (int u = 0; u < n; ++u)
+        topology.level_first[node_level[u] + 1] += topology.up_first_out[u + 1] - topology.up_first_out[u];
+    for (int level = 0; level <= max_level; ++level)
+        topology.level_first[level + 1] += topology.level_first[level];
+
+    topology.level_arcs.resize(m);
+    std::vector<int> level_pos(topology.level_first.begin(), topology.level_first.end() - 1);
+    for (int u = 0; u < n; ++u)
+        for (int a = topology.up_first_out[u]; a < topology.up_first_out[u + 1]; ++a)
+            topology.level_arcs[level_pos[node_level[u]]++] = a;
+}
+
+void CHGraph::customize_cch(const CHGraph::CCHTopology &topology, const std::vector<double> &weights,
+                            CHGraph::PreprocGraph &preproc_graph)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const int n = static_cast<int>(topology.ranks.size());
+    const int m = static_cast<int>(topology.up_head.size());
+
+    std::vector<int> tail(m);
+    for (int u = 0; u < n; ++u)
+        for (int a = topology.up_first_out[u]; a < topology.up_first_out[u + 1]; ++a)
+            tail[a] = u;
+
+    std::vector<double> up(m, INF), down(m, INF);
+    std::vector<int> up_mid(m, -1), down_mid(m, -1);
+
+    for (std::size_t e = 0; e < topology.input_arc.size(); ++e)
+    {
+        const int a = topology.input_arc[e];
+        if (a < 0)
+            continue;
+
+        if (topology.input_upward[e])
+            up[a] = std::min(up[a], weights[e]);
+        else
+            down[a] = std::min(down[a], weights[e]);
+    }
+
+    // Lower triangle relaxation: for arc {u, v} and common lower neighbour x
+    // up(u, v) = min(up(u, v), down(x, u) + up(x, v))
+    // down(u, v) = min(down(u, v), down(x, v) + up(x, u))
+    auto customize_arc = [&](int level_ind)
+    {
+        const int a = topology.level_arcs[level_ind];
+        const int u = tail[a];
+        const int v = topology.up_head[a];
+
+        int i = topology.down_first_out[u];
+        int j = topology.down_first_out[v];
+        const int i_end = topology.down_first_out[u + 1];
+        const int j_end = topology.down_first_out[v + 1];
+
+        while (i < i_end && j < j_end)
+        {
+            const int x_u = topology.down_tail[i];
+            const int x_v = topology.down_tail[j];
+
+            if (x_u < x_v)
+            {
+                ++i;
+            }
+            else if (x_v < x_u)
+            {
+                ++j;
+            }
+            else
+            {
+                const int xu = topology.down_arc[i];
+                const int xv = topology.down_arc[j];
+
+                const double up_candidate = down[xu] + up[xv];
+                if (up_candidate < up[a])
+                {
+                    up[a] = up_candidate;
+                    up_mid[a] = x_u;
+                }
+
+                const double down_candidate = down[xv] + up[xu];
+                if (down_candidate < down[a])
+                {
+                    down[a] = down_candidate;
+                    down_mid[a] = x_u;
+                }
+                ++i;
+                ++j;
+            }
+        }
+    };
+
+    const int levels = static_cast<int>(topology.level_first.size()) - 1;
+    for (int level = 0; level < levels; ++level)
+        Parallel::parallel_for(topology.level_first[level], topology.level_first[level + 1], customize_arc);
+
+    // Build the forward and backward graphs, arcs with infinite weight are dropped
+    preproc_graph = CHGraph::PreprocGraph{};
+    preproc_graph.ranks = topology.ranks;
+    preproc_graph.forward_first_out.assign(n + 1, 0);
+    preproc_graph.backward_first_out.assign(n + 1, 0);
+
+    for (int u = 0; u < n; ++u)
+    {
+        for (int a = topology.up_first_out[u]; a < topology.up_first_out[u + 1]; ++a)
+        {
+            const int v = topology.up_head[a];
+            if (up[a] < INF)
+                preproc_graph.forward_arcs.push_back(CHGraph::CHArc{u, v, up[a], up_mid[a]});
+            if (down[a] < INF)
+                preproc_graph.backward_arcs.push_back(CHGraph::CHArc{u, v, down[a], down_mid[a]});
+        }
+        preproc_graph.forward_first_out[u + 1] = static_cast<int>(preproc_graph.forward_arcs.size());
+        preproc_graph.backward_first_out[u + 1] = static_cast<int>(preproc_graph.backward_arcs.size());
+    }
+}
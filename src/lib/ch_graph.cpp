@@ -1,4 +1,8 @@
 #include "ch_graph.hpp"
+#include "arc_flags.hpp"
+#include "preproc_checkpoint.hpp"
+#include "file_facilities.hpp"
+#include "trace.hpp"
 
 #include <vector>
 #include <queue>
@@ -7,6 +11,256 @@
 #include <utility>
 #include <cstddef>
 #include <algorithm>
+#include <cstdint>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+
+// Contracted nodes per trace span of the contraction phase
+constexpr int TRACE_CONTRACTION_BATCH = 1024;
+
+// Phase times, contraction costs and progress of one preprocessing run for the monitor, and trace spans
+// of its phases and contraction batches. Does nothing without a monitor while tracing is off.
+class PreprocRecorder
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    CHGraph::PreprocMonitor *m_monitor;
+    bool m_tracing;
+    int m_phase = -1;
+    Clock::time_point m_phase_start;
+    Clock::time_point m_contraction_start;
+    Clock::time_point m_node_start;
+    Clock::time_point m_last_report;
+    Clock::time_point m_batch_start;
+    int m_batch_nodes = 0;
+    CHGraph::PreprocProgress m_progress;
+
+    static TimerTime nanoseconds(const Clock::duration duration)
+    {
+        return std::chrono::duration_cast<ChronoTime>(duration).count();
+    }
+
+    void report(const Clock::time_point now)
+    {
+        const int remaining_nodes = m_progress.node_number - m_progress.contracted_nodes;
+        m_progress.average_degree = (remaining_nodes > 0) ? static_cast<double>(m_progress.remaining_arcs) / remaining_nodes : 0.0;
+        m_progress.elapsed = nanoseconds(now - m_contraction_start);
+        m_progress.eta = (m_progress.contracted_nodes > 0)
+                             ? std::llround(static_cast<double>(m_progress.elapsed) / m_progress.contracted_nodes * remaining_nodes)
+                             : 0;
+        m_last_report = now;
+        m_monitor->progress(m_progress);
+    }
+
+public:
+    PreprocRecorder(CHGraph::PreprocMonitor *monitor, const int node_number)
+        : m_monitor(monitor), m_tracing(TRACE_ENABLED && Trace::enabled())
+    {
+        if (m_monitor == nullptr)
+            return;
+
+        m_monitor->profile = CHGraph::PreprocProfile();
+        m_progress.node_number = node_number;
+    }
+
+    bool active() const
+    {
+        return m_monitor != nullptr;
+    }
+
+    // Ends the running phase and starts phase, leaving the contraction reports the final progress
+    void phase(const CHGraph::PreprocPhase phase)
+    {
+        if (m_monitor == nullptr && !m_tracing)
+            return;
+
+        const Clock::time_point now = Clock::now();
+        finish(now);
+        m_phase = static_cast<int>(phase);
+        m_phase_start = now;
+        if (phase == CHGraph::PreprocPhase::CONTRACTION)
+            m_contraction_start = m_last_report = m_batch_start = now;
+    }
+
+    void finish(const Clock::time_point now = Clock::now())
+    {
+        if (m_phase == -1)
+            return;
+
+        const bool contraction = m_phase == static_cast<int>(CHGraph::PreprocPhase::CONTRACTION);
+        if (m_tracing)
+        {
+            if (contraction && m_batch_nodes > 0)
+                Trace::record("contraction_batch", m_batch_start, now);
+            Trace::record(CHGraph::preproc_phase_name(static_cast<CHGraph::PreprocPhase>(m_phase)), m_phase_start, now);
+            m_batch_nodes = 0;
+        }
+        if (m_monitor != nullptr)
+        {
+            m_monitor->profile.phase_times[m_phase] += nanoseconds(now - m_phase_start);
+            if (contraction && m_monitor->progress)
+                report(now);
+        }
+        m_phase = -1;
+    }
+
+    // Nodes contracted before a resumed run, progress only covers the remaining ones
+    void skip_nodes(const int nodes)
+    {
+        if (m_monitor != nullptr)
+            m_progress.node_number -= nodes;
+    }
+
+    void add_arcs(const long long arcs)
+    {
+        if (m_monitor != nullptr)
+            m_progress.remaining_arcs += arcs;
+    }
+
+    void add_shortcut()
+    {
+        if (m_monitor == nullptr)
+            return;
+
+        ++m_progress.shortcuts;
+        ++m_progress.remaining_arcs;
+    }
+
+    void begin_node()
+    {
+        if (m_monitor != nullptr)
+            m_node_start = Clock::now();
+    }
+
+    // removed_arcs = arcs between the contracted node and the uncontracted nodes
+    void end_node(const long long removed_arcs)
+    {
+        if (m_monitor == nullptr && !m_tracing)
+            return;
+
+        const Clock::time_point now = Clock::now();
+        if (m_tracing && ++m_batch_nodes == TRACE_CONTRACTION_BATCH)
+        {
+            Trace::record("contraction_batch", m_batch_start, now);
+            m_batch_start = now;
+            m_batch_nodes = 0;
+        }
+        if (m_monitor == nullptr)
+            return;
+
+        m_monitor->profile.contraction_costs.record(nanoseconds(now - m_node_start));
+        m_progress.remaining_arcs -= removed_arcs;
+        ++m_progress.contracted_nodes;
+
+        if (m_monitor->progress && now - m_last_report >= m_monitor->progress_interval)
+            report(now);
+    }
+};
+
+// Resumes one contraction from its checkpoint file and writes it at most every interval. Does nothing
+// without a checkpoint.
+class CheckpointWriter
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const CHGraph::Graph &m_graph;
+    CHGraph::PreprocCheckpoint *m_checkpoint;
+    Clock::time_point m_last_write;
+
+public:
+    CheckpointWriter(const CHGraph::Graph &graph, CHGraph::PreprocCheckpoint *checkpoint)
+        : m_graph(graph), m_checkpoint(checkpoint), m_last_write(Clock::now())
+    {
+    }
+
+    // Loads the checkpoint file if there is one
+    bool resume(const CHGraph::ContractionMethod method, CHGraph::ContractionState &state)
+    {
+        if (m_checkpoint == nullptr)
+            return false;
+
+        m_checkpoint->resumed_nodes = 0;
+        if (!std::filesystem::exists(m_checkpoint->file))
+            return false;
+
+        FileFacilities::load_contraction_checkpoint(m_checkpoint->file, m_graph, state);
+        if (state.method != method)
+        {
+            throw std::runtime_error("Checkpoint file " + m_checkpoint->file + " belongs to another preprocessing method");
+        }
+
+        m_checkpoint->resumed_nodes = state.contracted_nodes;
+        return true;
+    }
+
+    bool due() const
+    {
+        return m_checkpoint != nullptr && Clock::now() - m_last_write >= m_checkpoint->interval;
+    }
+
+    void write(const CHGraph::ContractionState &state)
+    {
+        TRACE_SCOPE("preproc_checkpoint");
+        FileFacilities::save_contraction_checkpoint(m_graph, state, m_checkpoint->file);
+        m_last_write = Clock::now();
+    }
+
+    // The contraction is done, a later run must not resume it
+    void finish()
+    {
+        if (m_checkpoint != nullptr)
+            std::remove(m_checkpoint->file.c_str());
+    }
+};
+
+// Adjacency lists to the first_out and arcs arrays of a checkpoint and back
+template <typename Edge, typename ToArc>
+static void flatten_adjacency(const std::vector<std::vector<Edge>> &adjacency, std::vector<int> &first_out,
+                              std::vector<CHGraph::CHArc> &arcs, ToArc to_arc)
+{
+    first_out.assign(1, 0);
+    arcs.clear();
+    for (int v = 0; v < static_cast<int>(adjacency.size()); ++v)
+    {
+        for (const Edge &edge : adjacency[v])
+            arcs.push_back(to_arc(v, edge));
+        first_out.push_back(static_cast<int>(arcs.size()));
+    }
+}
+
+template <typename Edge, typename FromArc>
+static void restore_adjacency(const std::vector<int> &first_out, const std::vector<CHGraph::CHArc> &arcs,
+                              std::vector<std::vector<Edge>> &adjacency, FromArc from_arc)
+{
+    for (int v = 0; v < static_cast<int>(adjacency.size()); ++v)
+    {
+        adjacency[v].clear();
+        for (int a = first_out[v]; a < first_out[v + 1]; ++a)
+            adjacency[v].push_back(from_arc(arcs[a]));
+    }
+}
+
+const char *CHGraph::preproc_phase_name(const CHGraph::PreprocPhase phase)
+{
+    switch (phase)
+    {
+    case CHGraph::PreprocPhase::ADJACENCY:
+        return "adjacency";
+    case CHGraph::PreprocPhase::PRIORITIES:
+        return "priorities";
+    case CHGraph::PreprocPhase::CONTRACTION:
+        return "contraction";
+    case CHGraph::PreprocPhase::ASSEMBLY:
+        return "assembly";
+    }
+
+    return "unknown";
+}
 
 double CHGraph::importance(
     int v,
@@ -78,11 +332,71 @@ bool CHGraph::witness_search(
     return false;
 }
 
+static void contract_bottom_up(const CHGraph::Graph &graph, const std::vector<int> *order_ranks, int core_size,
+                               CHGraph::PreprocGraph &preproc_graph, CHGraph::PreprocStats &stats, CHGraph::PreprocMonitor *monitor,
+                               CHGraph::PreprocCheckpoint *checkpoint);
+static void contract_top_down(const CHGraph::Graph &graph, const std::vector<int> *order_ranks, CHGraph::PreprocGraph &preproc_graph,
+                              CHGraph::PreprocStats &stats, CHGraph::PreprocMonitor *monitor, CHGraph::PreprocCheckpoint *checkpoint);
+
+// Nodes sorted by rank, throws std::invalid_argument unless ranks is a permutation of the nodes
+static std::vector<int> nodes_by_rank(const std::vector<int> &ranks, const int node_number)
+{
+    if (static_cast<int>(ranks.size()) != node_number)
+    {
+        throw std::invalid_argument("Contraction order has " + std::to_string(ranks.size()) + " ranks for " +
+                                    std::to_string(node_number) + " nodes");
+    }
+
+    std::vector<int> order(node_number, -1);
+    for (int v = 0; v < node_number; ++v)
+    {
+        if (ranks[v] < 0 || ranks[v] >= node_number || order[ranks[v]] != -1)
+        {
+            throw std::invalid_argument("Contraction order is not a permutation of the nodes");
+        }
+        order[ranks[v]] = v;
+    }
+    return order;
+}
+
 void CHGraph::preproc_graph_bottom_up(
     const CHGraph::Graph &graph,
     CHGraph::PreprocGraph &preproc_graph
 ) {
+    preproc_graph_bottom_up(graph, preproc_graph, CHGraph::PreprocOptions{});
+}
+
+void CHGraph::preproc_graph_bottom_up(
+    const CHGraph::Graph &graph,
+    CHGraph::PreprocGraph &preproc_graph,
+    const CHGraph::PreprocOptions &options
+) {
+    CHGraph::PreprocStats stats;
+    contract_bottom_up(graph, options.ranks, options.core_size, preproc_graph, options.stats != nullptr ? *options.stats : stats,
+                       options.monitor, options.checkpoint);
+}
+
+// Contraction by priorities or, with order_ranks, in the order of order_ranks. Stops when core_size nodes remain.
+static void contract_bottom_up(
+    const CHGraph::Graph &graph,
+    const std::vector<int> *order_ranks,
+    const int core_size,
+    CHGraph::PreprocGraph &preproc_graph,
+    CHGraph::PreprocStats &stats,
+    CHGraph::PreprocMonitor *monitor,
+    CHGraph::PreprocCheckpoint *checkpoint
+) {
+    using CHGraph::CHArc;
+    using CHGraph::compute_components;
+
+    TRACE_SCOPE("preproc_graph_bottom_up");
     const int n = graph.first_out.size() - 1;
+    PreprocRecorder recorder(monitor, n);
+    recorder.phase(CHGraph::PreprocPhase::ADJACENCY);
+
+    CheckpointWriter checkpoints(graph, checkpoint);
+    CHGraph::ContractionState state;
+    const bool resumed = checkpoints.resume(CHGraph::ContractionMethod::BOTTOM_UP, state);
 
     // Build directed adjacency lists
 
@@ -94,15 +408,6 @@ void CHGraph::preproc_graph_bottom_up(
     // in_adj[v]:  all edges v -> w
     std::vector<std::vector<Edge>> out_adj(n), in_adj(n);
 
-    for (int u = 0; u < n; ++u) {
-        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e) {
-            int v = graph.to[e];
-            double w = graph.weights[e];
-            out_adj[u].push_back({v, w});
-            in_adj[v].push_back({u, w});
-        }
-    }
-
     // Bookkeeping arrays
 
     std::vector<int> contracted(n, 0);   // 1 if node already contracted
@@ -111,6 +416,35 @@ void CHGraph::preproc_graph_bottom_up(
 
     std::vector<CHArc> all_arcs;          // original edges + shortcuts
 
+    if (resumed) {
+        restore_adjacency(state.out_first_out, state.out_arcs, out_adj, [](const CHArc &a) { return Edge{a.to, a.weight}; });
+        restore_adjacency(state.in_first_out, state.in_arcs, in_adj, [](const CHArc &a) { return Edge{a.from, a.weight}; });
+        contracted.assign(state.contracted.begin(), state.contracted.end());
+        rank = state.ranks;
+        current_rank = state.contracted_nodes;
+        all_arcs = state.shortcuts;
+
+        recorder.skip_nodes(current_rank);
+        if (recorder.active()) {
+            long long arcs = 0;
+            for (int u = 0; u < n; ++u)
+                if (!contracted[u])
+                    for (auto &e : out_adj[u])
+                        arcs += !contracted[e.to];
+            recorder.add_arcs(arcs);
+        }
+    } else {
+        for (int u = 0; u < n; ++u) {
+            for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e) {
+                int v = graph.to[e];
+                double w = graph.weights[e];
+                out_adj[u].push_back({v, w});
+                in_adj[v].push_back({u, w});
+            }
+        }
+        recorder.add_arcs(static_cast<long long>(graph.to.size()));
+    }
+
     // importance function per node
 
     auto importance = [&](int v) {
@@ -134,12 +468,44 @@ void CHGraph::preproc_graph_bottom_up(
     using QItem = std::pair<int, int>; // (importance, node)
     std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
 
-    for (int v = 0; v < n; ++v)
-        pq.emplace(importance(v), v);
+    // a given order replaces the priorities and the queue
+    std::vector<int> order;
+
+    recorder.phase(CHGraph::PreprocPhase::PRIORITIES);
+    if (order_ranks != nullptr) {
+        order = nodes_by_rank(*order_ranks, n);
+    } else if (resumed) {
+        for (std::size_t i = 0; i < state.queue_nodes.size(); ++i)
+            pq.emplace(state.queue_priorities[i], state.queue_nodes[i]);
+    } else {
+        for (int v = 0; v < n; ++v)
+            pq.emplace(importance(v), v);
+    }
+    // everything is restored, the loaded copy would stay alive for the whole contraction
+    state = CHGraph::ContractionState{};
+
+    // everything the loop below needs to continue with the next node, equal queue entries are
+    // interchangeable, so rebuilding the queue keeps the order
+    auto write_checkpoint = [&]() {
+        state.method = CHGraph::ContractionMethod::BOTTOM_UP;
+        state.contracted_nodes = current_rank;
+        state.ranks = rank;
+        state.contracted.assign(contracted.begin(), contracted.end());
+        flatten_adjacency(out_adj, state.out_first_out, state.out_arcs, [](int v, const Edge &e) { return CHArc{v, e.to, e.weight, -1}; });
+        flatten_adjacency(in_adj, state.in_first_out, state.in_arcs, [](int v, const Edge &e) { return CHArc{e.to, v, e.weight, -1}; });
+        state.shortcuts = all_arcs;
+        for (auto queue = pq; !queue.empty(); queue.pop()) {
+            state.queue_priorities.push_back(queue.top().first);
+            state.queue_nodes.push_back(queue.top().second);
+        }
+        checkpoints.write(state);
+        state = CHGraph::ContractionState{};
+    };
 
     // witness search
 
     auto witness_search = [&](int source, int target, int forbidden, double max_dist) {
+        SEARCH_STATS_ADD(stats.witness_searches, 1);
         const double INF = std::numeric_limits<double>::infinity();
         std::vector<double> dist(n, INF);
 
@@ -161,6 +527,7 @@ void CHGraph::preproc_graph_bottom_up(
 
             if (d != dist[u])
                 continue;
+            SEARCH_STATS_ADD(stats.witness_settled_nodes, 1);
 
             for (auto &e : out_adj[u]) {
                 int v = e.to;
@@ -177,21 +544,9 @@ void CHGraph::preproc_graph_bottom_up(
         return false;
     };
 
-    // contraction loop
-
-    while (!pq.empty()) {
-        auto [old_imp, v] = pq.top();
-        pq.pop();
-
-        if (contracted[v])
-            continue;
-
-        // lazy recomputation (only update importance when you pop a node, if the new imporance is bigger than the old one)
-        int new_imp = importance(v);
-        if (new_imp > old_imp) {
-            pq.emplace(new_imp, v);
-            continue;
-        }
+    // contracts v, adds the shortcuts that no witness makes unnecessary and returns the arcs it removed
+    auto contract = [&](int v) {
+        recorder.begin_node();
 
         // collect in and out edges
 
@@ -226,8 +581,17 @@ void CHGraph::preproc_graph_bottom_up(
                     for (auto &e : out_adj[u]) {
                         if (e.to == w) {
                             found = true;
-                            if (shortcut_weight < e.weight)
+                            if (shortcut_weight < e.weight) {
+                                // the lower weight has to reach in_adj and the hierarchy as well
                                 e.weight = shortcut_weight;
+                                for (auto &in_w : in_adj[w])
+                                    if (in_w.to == u && in_w.weight > shortcut_weight) {
+                                        in_w.weight = shortcut_weight;
+                                        break;
+                                    }
+                                all_arcs.push_back(CHArc{u, w, shortcut_weight, v});
+                                SEARCH_STATS_ADD(stats.shortcuts_added, 1);
+                            }
                             break;
                         }
                     }
@@ -235,6 +599,8 @@ void CHGraph::preproc_graph_bottom_up(
                         out_adj[u].push_back({w, shortcut_weight});
                         in_adj[w].push_back({u, shortcut_weight});
                         all_arcs.push_back(CHArc{u, w, shortcut_weight, v});
+                        SEARCH_STATS_ADD(stats.shortcuts_added, 1);
+                        recorder.add_shortcut();
                     }
                 }
             }
@@ -245,7 +611,43 @@ void CHGraph::preproc_graph_bottom_up(
         contracted[v] = 1;
         rank[v] = current_rank++;
 
-        // neighbours change importance 
+        long long removed_arcs = 0;
+        if (recorder.active()) {
+            // a self loop is in incoming and outgoing
+            removed_arcs = incoming.size() + outgoing.size();
+            for (auto &e : outgoing)
+                removed_arcs -= (e.to == v);
+        }
+        return removed_arcs;
+    };
+
+    // contraction loop
+
+    recorder.phase(CHGraph::PreprocPhase::CONTRACTION);
+    for (int v : order) {
+        if (n - current_rank <= core_size)
+            break;
+        if (!contracted[v])
+            recorder.end_node(contract(v));
+    }
+
+    while (!pq.empty() && n - current_rank > core_size) {
+        auto [old_imp, v] = pq.top();
+        pq.pop();
+
+        if (contracted[v])
+            continue;
+
+        // lazy recomputation (only update importance when you pop a node, if the new imporance is bigger than the old one)
+        int new_imp = importance(v);
+        if (new_imp > old_imp) {
+            pq.emplace(new_imp, v);
+            continue;
+        }
+
+        const long long removed_arcs = contract(v);
+
+        // neighbours change importance
         for (auto &e : in_adj[v])
             if (!contracted[e.to])
                 pq.emplace(importance(e.to), e.to);
@@ -253,10 +655,23 @@ void CHGraph::preproc_graph_bottom_up(
         for (auto &e : out_adj[v])
             if (!contracted[e.to])
                 pq.emplace(importance(e.to), e.to);
+
+        recorder.end_node(removed_arcs);
+
+        if (checkpoints.due())
+            write_checkpoint();
     }
 
+    // the core is left uncontracted above all other nodes
+
+    for (int v = 0; v < n; ++v)
+        if (!contracted[v])
+            rank[v] = current_rank++;
+
     // add the original edges
 
+    recorder.phase(CHGraph::PreprocPhase::ASSEMBLY);
+
     for (int u = 0; u < n; ++u) {
         for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e) {
             int v = graph.to[e];
@@ -296,6 +711,9 @@ void CHGraph::preproc_graph_bottom_up(
             preproc_graph.backward_arcs[bpos[a.to]++] =
                 CHArc{a.to, a.from, a.weight, a.mid_node};
     }
+    compute_components(graph, preproc_graph);
+    checkpoints.finish();
+    recorder.finish();
 }
 
 
@@ -326,7 +744,42 @@ static std::vector<int> rank_importance(const std::vector<std::vector<int>> &in_
 
 void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::PreprocGraph &preproc_graph)
 {
+    preproc_graph_top_down(graph, preproc_graph, CHGraph::PreprocOptions{});
+}
+
+void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::PreprocGraph &preproc_graph,
+                                     const CHGraph::PreprocOptions &options)
+{
+    if (options.core_size != 0)
+    {
+        throw std::invalid_argument("Top down contraction can not leave a core");
+    }
+
+    CHGraph::PreprocStats stats;
+    contract_top_down(graph, options.ranks, preproc_graph, options.stats != nullptr ? *options.stats : stats, options.monitor,
+                      options.checkpoint);
+}
+
+// Contraction in the order of the importance ranks or, with order_ranks, in the order of order_ranks
+static void contract_top_down(const CHGraph::Graph &graph, const std::vector<int> *order_ranks, CHGraph::PreprocGraph &preproc_graph,
+                              CHGraph::PreprocStats &stats, CHGraph::PreprocMonitor *monitor, CHGraph::PreprocCheckpoint *checkpoint)
+{
+    using CHGraph::CHArc;
+    using CHGraph::compute_components;
+
+    TRACE_SCOPE("preproc_graph_top_down");
     const int n = graph.first_out.empty() ? 0 : static_cast<int>(graph.first_out.size()) - 1;
+    PreprocRecorder recorder(monitor, n);
+    recorder.phase(CHGraph::PreprocPhase::ADJACENCY);
+
+    CheckpointWriter checkpoints(graph, checkpoint);
+    CHGraph::ContractionState state;
+    const bool resumed = checkpoints.resume(CHGraph::ContractionMethod::TOP_DOWN, state);
+
+    // order_ranks may be preproc_graph.ranks, which is reset below
+    std::vector<int> given_ranks;
+    if (order_ranks != nullptr)
+        given_ranks = *order_ranks;
 
     preproc_graph = CHGraph::PreprocGraph{};
     preproc_graph.ranks.assign(n, 0);
@@ -341,7 +794,14 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
     std::vector<std::vector<OverlayEdge>> out_edges(n);
     std::vector<std::vector<OverlayEdge>> in_edges(n);
 
-    if (n > 0 && static_cast<int>(graph.first_out.size()) >= n + 1)
+    if (resumed)
+    {
+        restore_adjacency(state.out_first_out, state.out_arcs, out_edges,
+                          [](const CHArc &a) { return OverlayEdge{a.to, a.weight, a.mid_node}; });
+        restore_adjacency(state.in_first_out, state.in_arcs, in_edges,
+                          [](const CHArc &a) { return OverlayEdge{a.from, a.weight, a.mid_node}; });
+    }
+    else if (n > 0 && static_cast<int>(graph.first_out.size()) >= n + 1)
     {
         for (int u = 0; u < n; ++u)
         {
@@ -379,7 +839,11 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
             }
         }
         if (!found)
+        {
             out_edges[from].push_back(OverlayEdge{to, weight, mid_node});
+            SEARCH_STATS_ADD(stats.shortcuts_added, 1);
+            recorder.add_shortcut();
+        }
 
         found = false;
         for (std::size_t i = 0; i < in_edges[to].size(); ++i)
@@ -399,15 +863,45 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
             in_edges[to].push_back(OverlayEdge{from, weight, mid_node});
     };
 
-    std::vector<std::vector<int>> in_deg(n), out_deg(n);
-    for (int v = 0; v < n; ++v) {
-        for (auto &e : in_edges[v])
-            in_deg[v].push_back(e.to);
-        for (auto &e : out_edges[v])
-            out_deg[v].push_back(e.to);
+    // arcs between distinct nodes, the ones a contraction removes
+    auto active_arcs = [&](int v, const std::vector<unsigned char> &contracted)
+    {
+        long long arcs = 0;
+        for (std::size_t i = 0; i < out_edges[v].size(); ++i)
+        {
+            const int w = out_edges[v][i].to;
+            arcs += (w != v && 0 <= w && w < n && !contracted[w]);
+        }
+        for (std::size_t i = 0; i < in_edges[v].size(); ++i)
+        {
+            const int u = in_edges[v][i].to;
+            arcs += (u != v && !contracted[u]);
+        }
+        return arcs;
+    };
+
+    recorder.phase(CHGraph::PreprocPhase::PRIORITIES);
+    if (order_ranks != nullptr)
+    {
+        nodes_by_rank(given_ranks, n);
+        preproc_graph.ranks = std::move(given_ranks);
     }
+    else if (resumed)
+    {
+        preproc_graph.ranks = state.ranks;
+    }
+    else
+    {
+        std::vector<std::vector<int>> in_deg(n), out_deg(n);
+        for (int v = 0; v < n; ++v) {
+            for (auto &e : in_edges[v])
+                in_deg[v].push_back(e.to);
+            for (auto &e : out_edges[v])
+                out_deg[v].push_back(e.to);
+        }
 
-    preproc_graph.ranks = rank_importance(in_deg, out_deg);
+        preproc_graph.ranks = rank_importance(in_deg, out_deg);
+    }
 
     std::vector<int> order(n);
     for (int i = 0; i < n; ++i) order[i] = i;
@@ -416,6 +910,37 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
     });
 
     std::vector<unsigned char> contracted(n, 0);
+    int first_position = 0;
+    if (resumed)
+    {
+        contracted = state.contracted;
+        first_position = state.contracted_nodes;
+        recorder.skip_nodes(first_position);
+        state = CHGraph::ContractionState{};
+    }
+
+    // The overlay and the contracted nodes, the order follows from the ranks
+    auto write_checkpoint = [&](int position)
+    {
+        state.method = CHGraph::ContractionMethod::TOP_DOWN;
+        state.contracted_nodes = position;
+        state.ranks = preproc_graph.ranks;
+        state.contracted = contracted;
+        flatten_adjacency(out_edges, state.out_first_out, state.out_arcs,
+                          [](int v, const OverlayEdge &e) { return CHArc{v, e.to, e.weight, e.mid}; });
+        flatten_adjacency(in_edges, state.in_first_out, state.in_arcs,
+                          [](int v, const OverlayEdge &e) { return CHArc{e.to, v, e.weight, e.mid}; });
+        checkpoints.write(state);
+        state = CHGraph::ContractionState{};
+    };
+
+    if (recorder.active())
+    {
+        long long arcs = 0;
+        for (int v = 0; v < n; ++v)
+            arcs += active_arcs(v, contracted);
+        recorder.add_arcs(arcs / 2);
+    }
 
     const double INF = std::numeric_limits<double>::infinity();
     std::vector<double> dist(n, INF);
@@ -432,11 +957,17 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
     typedef std::pair<double, int> QItem;
     std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
 
-    for (int idx = 0; idx < n; ++idx)
+    recorder.phase(CHGraph::PreprocPhase::CONTRACTION);
+    for (int idx = first_position; idx < n; ++idx)
     {
+        if (idx > first_position && checkpoints.due())
+            write_checkpoint(idx);
+
         const int v = order[idx];
         if (contracted[v])
             continue;
+        recorder.begin_node();
+        const long long removed_arcs = recorder.active() ? active_arcs(v, contracted) : 0;
 
         std::vector<std::pair<int, double>> incoming;
         incoming.reserve(in_edges[v].size());
@@ -489,6 +1020,7 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
         if (incoming.empty() || outgoing.empty())
         {
             contracted[v] = 1;
+            recorder.end_node(removed_arcs);
             continue;
         }
 
@@ -514,6 +1046,7 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
             if (targets.empty())
                 continue;
 
+            SEARCH_STATS_ADD(stats.witness_searches, 1);
             reset_dist();
             while (!pq.empty())
                 pq.pop();
@@ -537,6 +1070,7 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
                     continue;
                 if (contracted[x] && x != u)
                     continue;
+                SEARCH_STATS_ADD(stats.witness_settled_nodes, 1);
 
                 for (std::size_t ei = 0; ei < out_edges[x].size(); ++ei)
                 {
@@ -568,8 +1102,11 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
         }
 
         contracted[v] = 1;
+        recorder.end_node(removed_arcs);
     }
 
+    recorder.phase(CHGraph::PreprocPhase::ASSEMBLY);
+
     std::vector<std::vector<CHGraph::CHArc>> f_adj(n), b_adj(n);
 
     for (int u = 0; u < n; ++u)
@@ -612,10 +1149,22 @@ void CHGraph::preproc_graph_top_down(const CHGraph::Graph &graph, CHGraph::Prepr
             preproc_graph.backward_first_out[i] + static_cast<int>(b_adj[i].size());
         preproc_graph.backward_arcs.insert(preproc_graph.backward_arcs.end(), b_adj[i].begin(), b_adj[i].end());
     }
+    compute_components(graph, preproc_graph);
+    checkpoints.finish();
+    recorder.finish();
 }
 
-void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph, const CHGraph::Destination &destination, CHGraph::Route &route)
+// Bidirectional upward search, arcs rejected by the filters are not relaxed
+template <typename ForwardFilter, typename BackwardFilter>
+static void bidirectional_upward_search(const CHGraph::PreprocGraph &preproc_graph, const CHGraph::Destination &destination,
+                                        CHGraph::Route &route, int &settled_nodes, CHGraph::QueryStats &stats,
+                                        ForwardFilter forward_filter, BackwardFilter backward_filter)
 {
+    using CHGraph::CHArc;
+    using CHGraph::stall_forward;
+    using CHGraph::stall_backward;
+
+    settled_nodes = 0;
     route.nodes.clear();
     route.total_weight = std::numeric_limits<double>::infinity();
 
@@ -632,6 +1181,9 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
         return; 
     }
 
+    // Different components in the wrong order or not connected in the condensation
+    if (!CHGraph::may_reach(preproc_graph, s, t)) return;
+
 
     const double INF = std::numeric_limits<double>::infinity();
 
@@ -647,6 +1199,7 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
 
     dist_f[s] = 0.0; pqf.push(QItem(0.0, s));
     dist_b[t] = 0.0; pqb.push(QItem(0.0, t));
+    SEARCH_STATS_ADD(stats.queue_pushes, 2);
 
     double best_dist = INF; //set current best distance from s to t
     int meeting_node = -1;  // stores node where both searches meet and achieve best distance
@@ -673,9 +1226,12 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
             pqf.pop();  //Remove element from the queue
 
             if (d > dist_f[u]) continue; // Skip if already settled with better distance
+            ++settled_nodes;
+            SEARCH_STATS_ADD(stats.settled_nodes, 1);
 
             // Stall-on-demand: check if better path via lower-ranked neighbor exists
             if (stall_forward(u, dist_f, preproc_graph)) {
+                SEARCH_STATS_ADD(stats.stalled_nodes, 1);
                 // Check for meeting point settled in both directions
                 if (dist_b[u] < INF) {
                     double candidate_distance = dist_f[u] + dist_b[u];
@@ -686,6 +1242,8 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
 
             // Expand outgoing upward arcs
             for (int e = preproc_graph.forward_first_out[u]; e < preproc_graph.forward_first_out[u + 1]; ++e) {
+                if (!forward_filter(e)) continue;
+                SEARCH_STATS_ADD(stats.relaxed_arcs, 1);
                 const CHArc &arc = preproc_graph.forward_arcs[e];
                 int v = arc.to;
                 double new_distance = d + arc.weight; 
@@ -693,6 +1251,7 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
                     dist_f[v] = new_distance;
                     prev_f[v] = u;
                     pqf.push(QItem(new_distance, v));
+                    SEARCH_STATS_ADD(stats.queue_pushes, 1);
                 }
             }
             
@@ -707,9 +1266,12 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
             auto [d,u] = pqb.top();  // d = node distance,  u = node index
             pqb.pop(); //Remove element from the  queue
             if (d > dist_b[u]) continue;
+            ++settled_nodes;
+            SEARCH_STATS_ADD(stats.settled_nodes, 1);
 
             // Stall-on-demand on backward search
             if (stall_backward(u, dist_b, preproc_graph)) {
+                SEARCH_STATS_ADD(stats.stalled_nodes, 1);
                 if (dist_f[u] < INF) {
                     double candidate_distance = dist_f[u] + dist_b[u];
                     if (candidate_distance < best_dist) { best_dist = candidate_distance; meeting_node = u; }
@@ -719,6 +1281,8 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
 
             // Expand outgoing arcs in backwards search
             for (int e = preproc_graph.backward_first_out[u]; e < preproc_graph.backward_first_out[u + 1]; ++e) {
+                if (!backward_filter(e)) continue;
+                SEARCH_STATS_ADD(stats.relaxed_arcs, 1);
                 const CHArc &arc = preproc_graph.backward_arcs[e];
                 int v = arc.to; 
                 double new_distance = d + arc.weight;
@@ -726,6 +1290,7 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
                     dist_b[v] = new_distance;
                     prev_b[v] = u;
                     pqb.push(QItem(new_distance, v));
+                    SEARCH_STATS_ADD(stats.queue_pushes, 1);
                 }
             }
 
@@ -740,3 +1305,49 @@ void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGra
     route.total_weight = best_dist;
 }
 
+void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph, const CHGraph::Destination &destination, CHGraph::Route &route)
+{
+    CHGraph::QueryStats stats;
+    query_route(graph, preproc_graph, destination, route, stats);
+}
+
+void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph, const CHGraph::Destination &destination,
+                          CHGraph::Route &route, CHGraph::QueryStats &stats)
+{
+    int settled_nodes;
+    bidirectional_upward_search(preproc_graph, destination, route, settled_nodes, stats,
+                                [](int) { return true; }, [](int) { return true; });
+}
+
+void CHGraph::query_route(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph, const CHGraph::ArcFlags &arc_flags,
+                          const CHGraph::Destination &destination, CHGraph::Route &route)
+{
+    int settled_nodes;
+    query_route_search_space(preproc_graph, &arc_flags, destination, route, settled_nodes);
+}
+
+void CHGraph::query_route_search_space(const CHGraph::PreprocGraph &preproc_graph, const CHGraph::ArcFlags *arc_flags,
+                                       const CHGraph::Destination &destination, CHGraph::Route &route, int &settled_nodes)
+{
+    const int n = static_cast<int>(preproc_graph.ranks.size());
+    const int s = destination.source;
+    const int t = destination.target;
+
+    CHGraph::QueryStats stats;
+    if (arc_flags == nullptr || s < 0 || s >= n || t < 0 || t >= n)
+    {
+        bidirectional_upward_search(preproc_graph, destination, route, settled_nodes, stats,
+                                    [](int) { return true; }, [](int) { return true; });
+        return;
+    }
+
+    // forward arcs have to lead towards the target cell, backward arcs have to come from the source cell
+    const std::uint64_t target_mask = std::uint64_t{1} << arc_flags->cells[t];
+    const std::uint64_t source_mask = std::uint64_t{1} << arc_flags->cells[s];
+    const std::uint64_t *forward_flags = arc_flags->forward_flags.data();
+    const std::uint64_t *backward_flags = arc_flags->backward_flags.data();
+
+    bidirectional_upward_search(preproc_graph, destination, route, settled_nodes, stats,
+                                [=](int e) { return (forward_flags[e] & target_mask) != 0; },
+                                [=](int e) { return (backward_flags[e] & source_mask) != 0; });
+}
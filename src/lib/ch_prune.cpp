@@ -0,0 +1,183 @@
+#include "ch_graph.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <functional>
+#include <utility>
+#include <algorithm>
+
+
+namespace
+{
+    // Search state of one thread, reset through touched after every source
+    struct PruneSearch
+    {
+        std::vector<double> dist;
+        std::vector<char> indirect; // some path of weight dist[node] has at least two arcs
+        std::vector<int> touched;
+        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<>> queue;
+
+        explicit PruneSearch(const int node_number)
+            : dist(node_number, std::numeric_limits<double>::infinity()), indirect(node_number, 0)
+        {
+        }
+    };
+
+    // Upward Dijkstra from source over arcs up to max_weight. A shortcut source -> v of weight w is redundant if
+    // another upward path of weight at most w exists; it can stand in for the shortcut in every up-down path, and
+    // since it only visits nodes between source and v in rank, two arcs can never be each other's witness.
+    void mark_redundant_shortcuts(const std::vector<int> &first_out, const std::vector<CHGraph::CHArc> &arcs,
+                                  const int source, PruneSearch &search, std::vector<char> &redundant)
+    {
+        double max_weight = -1.0;
+        for (int e = first_out[source]; e < first_out[source + 1]; ++e)
+            if (arcs[e].mid_node != -1)
+                max_weight = std::max(max_weight, arcs[e].weight);
+        if (max_weight < 0.0)
+            return;
+
+        search.dist[source] = 0.0;
+        search.touched.push_back(source);
+        search.queue.emplace(0.0, source);
+
+        while (!search.queue.empty())
+        {
+            const auto [d, x] = search.queue.top();
+            search.queue.pop();
+            if (d > max_weight)
+                break;
+            if (d > search.dist[x])
+                continue;
+
+            for (int e = first_out[x]; e < first_out[x + 1]; ++e)
+            {
+                const int y = arcs[e].to;
+                const double new_dist = d + arcs[e].weight;
+                if (new_dist < search.dist[y])
+                {
+                    if (search.dist[y] == std::numeric_limits<double>::infinity())
+                        search.touched.push_back(y);
+                    search.dist[y] = new_dist;
+                    search.indirect[y] = (x != source);
+                    search.queue.emplace(new_dist, y);
+                }
+                else if (new_dist == search.dist[y] && x != source)
+                {
+                    search.indirect[y] = 1;
+                }
+            }
+        }
+
+        for (int e = first_out[source]; e < first_out[source + 1]; ++e)
+        {
+            const CHGraph::CHArc &arc = arcs[e];
+            if (arc.mid_node != -1 && (search.dist[arc.to] < arc.weight || (search.dist[arc.to] == arc.weight && search.indirect[arc.to])))
+                redundant[e] = 1;
+        }
+
+        for (const int node : search.touched)
+        {
+            search.dist[node] = std::numeric_limits<double>::infinity();
+            search.indirect[node] = 0;
+        }
+        search.touched.clear();
+        search.queue = {};
+    }
+
+    void mark_redundant_shortcuts(const std::vector<int> &first_out, const std::vector<CHGraph::CHArc> &arcs,
+                                  std::vector<char> &redundant)
+    {
+        const int n = static_cast<int>(first_out.size()) - 1;
+        redundant.assign(arcs.size(), 0);
+
+        const int chunk_number = std::max(1, std::min(Parallel::thread_number(), n / Parallel::MIN_PARALLEL_RANGE));
+        Parallel::parallel_for(0, chunk_number, [&](int chunk)
+        {
+            PruneSearch search(n);
+            const int begin = static_cast<int>(static_cast<long long>(n) * chunk / chunk_number);
+            const int end = static_cast<int>(static_cast<long long>(n) * (chunk + 1) / chunk_number);
+            for (int source = begin; source < end; ++source)
+                mark_redundant_shortcuts(first_out, arcs, source, search, redundant);
+        }, 1);
+    }
+
+    // Index of the arc unpack_arc picks for node -> to, -1 if there is none
+    int lightest_arc(const std::vector<int> &first_out, const std::vector<CHGraph::CHArc> &arcs, const int node, const int to)
+    {
+        int lightest = -1;
+        for (int e = first_out[node]; e < first_out[node + 1]; ++e)
+            if (arcs[e].to == to && (lightest == -1 || arcs[e].weight < arcs[lightest].weight))
+                lightest = e;
+        return lightest;
+    }
+
+    void remove_arcs(std::vector<int> &first_out, std::vector<CHGraph::CHArc> &arcs, const std::vector<char> &redundant)
+    {
+        const int n = static_cast<int>(first_out.size()) - 1;
+        std::size_t kept = 0;
+        int first = 0;
+        for (int node = 0; node < n; ++node)
+        {
+            const int last = first_out[node + 1];
+            first_out[node] = static_cast<int>(kept);
+            for (int e = first; e < last; ++e)
+                if (!redundant[e])
+                    arcs[kept++] = arcs[e];
+            first = last;
+        }
+        first_out[n] = static_cast<int>(kept);
+        arcs.resize(kept);
+    }
+}
+
+long long CHGraph::prune_redundant_shortcuts(CHGraph::PreprocGraph &preproc_graph)
+{
+    std::vector<char> forward_redundant, backward_redundant;
+    mark_redundant_shortcuts(preproc_graph.forward_first_out, preproc_graph.forward_arcs, forward_redundant);
+    mark_redundant_shortcuts(preproc_graph.backward_first_out, preproc_graph.backward_arcs, backward_redundant);
+
+    // Unpacking a kept shortcut from -> to via m needs the arcs m -> to (forward at m) and from -> m (backward at m),
+    // so they are kept even if they are redundant themselves. The stack holds kept shortcuts, backward ones as ~index.
+    std::vector<int> stack;
+    for (int e = 0; e < static_cast<int>(preproc_graph.forward_arcs.size()); ++e)
+        if (preproc_graph.forward_arcs[e].mid_node != -1 && !forward_redundant[e])
+            stack.push_back(e);
+    for (int e = 0; e < static_cast<int>(preproc_graph.backward_arcs.size()); ++e)
+        if (preproc_graph.backward_arcs[e].mid_node != -1 && !backward_redundant[e])
+            stack.push_back(~e);
+
+    while (!stack.empty())
+    {
+        const int item = stack.back();
+        stack.pop_back();
+
+        // backward arcs to -> from are stored at the head of the input arc from -> to
+        const CHGraph::CHArc &arc = (item >= 0) ? preproc_graph.forward_arcs[item] : preproc_graph.backward_arcs[~item];
+        const int from = (item >= 0) ? arc.from : arc.to;
+        const int to = (item >= 0) ? arc.to : arc.from;
+        const int m = arc.mid_node;
+
+        const int forward_child = lightest_arc(preproc_graph.forward_first_out, preproc_graph.forward_arcs, m, to);
+        if (forward_child != -1 && forward_redundant[forward_child])
+        {
+            forward_redundant[forward_child] = 0;
+            stack.push_back(forward_child);
+        }
+
+        const int backward_child = lightest_arc(preproc_graph.backward_first_out, preproc_graph.backward_arcs, m, from);
+        if (backward_child != -1 && backward_redundant[backward_child])
+        {
+            backward_redundant[backward_child] = 0;
+            stack.push_back(~backward_child);
+        }
+    }
+
+    const long long pruned_arcs = std::count(forward_redundant.begin(), forward_redundant.end(), 1) +
+                                  std::count(backward_redundant.begin(), backward_redundant.end(), 1);
+    remove_arcs(preproc_graph.forward_first_out, preproc_graph.forward_arcs, forward_redundant);
+    remove_arcs(preproc_graph.backward_first_out, preproc_graph.backward_arcs, backward_redundant);
+
+    return pruned_arcs;
+}
@@ -0,0 +1,450 @@
+#include "ch_graph.hpp"
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <functional>
+#include <utility>
+#include <algorithm>
+
+
+namespace
+{
+    struct DynamicArc
+    {
+        int from;
+        int to;
+        double weight;
+        double original; // minimal weight of input arcs from -> to, infinity if there is none
+        int mid_node;
+        bool dirty;
+    };
+
+    // Mutable copy of the hierarchy, every arc is listed at both of its end points
+    struct DynamicHierarchy
+    {
+        const std::vector<int> &ranks;
+        std::vector<DynamicArc> arcs;
+        std::vector<std::vector<int>> up_out;   // up_out[x]: arcs x -> y, ranks[y] > ranks[x]
+        std::vector<std::vector<int>> up_in;    // up_in[x]: arcs y -> x, ranks[y] > ranks[x]
+        std::vector<std::vector<int>> down_out; // down_out[x]: arcs x -> y, ranks[y] < ranks[x]
+        std::vector<std::vector<int>> down_in;  // down_in[x]: arcs y -> x, ranks[y] < ranks[x]
+
+        explicit DynamicHierarchy(const std::vector<int> &node_ranks)
+            : ranks(node_ranks), up_out(node_ranks.size()), up_in(node_ranks.size()),
+              down_out(node_ranks.size()), down_in(node_ranks.size())
+        {
+        }
+
+        int lower(const DynamicArc &arc) const
+        {
+            return ranks[arc.from] < ranks[arc.to] ? arc.from : arc.to;
+        }
+
+        int find_arc(int from, int to) const
+        {
+            const std::vector<int> &candidates = ranks[from] < ranks[to] ? up_out[from] : up_in[to];
+            for (int a : candidates)
+                if (arcs[a].from == from && arcs[a].to == to)
+                    return a;
+            return -1;
+        }
+
+        int add_arc(int from, int to, double weight, double original, int mid_node)
+        {
+            const int a = static_cast<int>(arcs.size());
+            arcs.push_back(DynamicArc{from, to, weight, original, mid_node, false});
+
+            if (ranks[from] < ranks[to])
+            {
+                up_out[from].push_back(a);
+                down_in[to].push_back(a);
+            }
+            else
+            {
+                up_in[to].push_back(a);
+                down_out[from].push_back(a);
+            }
+            return a;
+        }
+    };
+}
+
+
+void CHGraph::update_preproc_graph(const CHGraph::Graph &graph, CHGraph::PreprocGraph &preproc_graph,
+                                   const std::vector<int> &changed_arcs)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const int n = static_cast<int>(preproc_graph.ranks.size());
+    const std::vector<int> &ranks = preproc_graph.ranks;
+
+    if (n <= 0 || changed_arcs.empty())
+        return;
+
+    // Load the hierarchy, parallel arcs are merged keeping the smaller weight
+
+    DynamicHierarchy hierarchy(ranks);
+
+    auto load_arc = [&](int from, int to, double weight, int mid_node)
+    {
+        const int a = hierarchy.find_arc(from, to);
+        if (a == -1)
+            hierarchy.add_arc(from, to, weight, INF, mid_node);
+        else if (weight < hierarchy.arcs[a].weight)
+        {
+            hierarchy.arcs[a].weight = weight;
+            hierarchy.arcs[a].mid_node = mid_node;
+        }
+    };
+
+    for (int x = 0; x < n; ++x)
+    {
+        for (int e = preproc_graph.forward_first_out[x]; e < preproc_graph.forward_first_out[x + 1]; ++e)
+        {
+            const CHArc &arc = preproc_graph.forward_arcs[e];
+            load_arc(x, arc.to, arc.weight, arc.mid_node);
+        }
+        for (int e = preproc_graph.backward_first_out[x]; e < preproc_graph.backward_first_out[x + 1]; ++e)
+        {
+            const CHArc &arc = preproc_graph.backward_arcs[e];
+            load_arc(arc.to, x, arc.weight, arc.mid_node);
+        }
+    }
+
+    std::vector<int> arc_of_input(graph.to.size(), -1);
+    for (int u = 0; u < n; ++u)
+    {
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+        {
+            const int v = graph.to[e];
+            if (u == v)
+                continue;
+
+            int a = hierarchy.find_arc(u, v);
+            if (a == -1)
+                a = hierarchy.add_arc(u, v, INF, INF, -1);
+
+            arc_of_input[e] = a;
+            hierarchy.arcs[a].original = std::min(hierarchy.arcs[a].original, graph.weights[e]);
+        }
+    }
+
+    // Nodes are processed in rank order, an arc is processed at its lower end point
+
+    std::vector<char> queued(n, 0);
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> pq;
+
+    auto push_node = [&](int x)
+    {
+        if (!queued[x])
+        {
+            queued[x] = 1;
+            pq.emplace(ranks[x], x);
+        }
+    };
+
+    auto mark_dirty = [&](int a)
+    {
+        hierarchy.arcs[a].dirty = true;
+        push_node(hierarchy.lower(hierarchy.arcs[a]));
+    };
+
+    for (int e : changed_arcs)
+    {
+        if (e < 0 || e >= static_cast<int>(arc_of_input.size()) || arc_of_input[e] == -1)
+            continue;
+        mark_dirty(arc_of_input[e]);
+    }
+
+    // Weight of arc from -> to: original arc or best path from -> m -> to over
+    // lower common neighbours m (the mid_node dependencies)
+
+    std::vector<double> via_weight(n, INF);
+    std::vector<int> via_stamp(n, -1);
+    int stamp = 0;
+
+    auto recompute = [&](int a)
+    {
+        const int from = hierarchy.arcs[a].from;
+        const int to = hierarchy.arcs[a].to;
+        const int current_stamp = stamp++;
+
+        for (int b : hierarchy.down_out[from])
+        {
+            via_stamp[hierarchy.arcs[b].to] = current_stamp;
+            via_weight[hierarchy.arcs[b].to] = hierarchy.arcs[b].weight;
+        }
+
+        double weight = hierarchy.arcs[a].original;
+        int mid_node = -1;
+        for (int b : hierarchy.down_in[to])
+        {
+            const int m = hierarchy.arcs[b].from;
+            if (via_stamp[m] != current_stamp)
+                continue;
+
+            const double candidate = via_weight[m] + hierarchy.arcs[b].weight;
+            if (candidate < weight)
+            {
+                weight = candidate;
+                mid_node = m;
+            }
+        }
+
+        hierarchy.arcs[a].dirty = false;
+        hierarchy.arcs[a].mid_node = mid_node;
+        return weight;
+    };
+
+    // Arcs that use arc a (stored at x) as one of their halves with mid node x
+    auto mark_dependents = [&](int a, int x)
+    {
+        const DynamicArc arc = hierarchy.arcs[a];
+        if (arc.from == x)
+        {
+            for (int b : hierarchy.up_in[x])
+            {
+                const int y = hierarchy.arcs[b].from;
+                const int dependent = y == arc.to ? -1 : hierarchy.find_arc(y, arc.to);
+                if (dependent != -1)
+                    mark_dirty(dependent);
+            }
+        }
+        else
+        {
+            for (int b : hierarchy.up_out[x])
+            {
+                const int y = hierarchy.arcs[b].to;
+                const int dependent = y == arc.from ? -1 : hierarchy.find_arc(arc.from, y);
+                if (dependent != -1)
+                    mark_dirty(dependent);
+            }
+        }
+    };
+
+    // Pass 1: repair weights of affected shortcuts bottom up
+
+    std::vector<char> witness_check(n, 0);
+    std::vector<int> increased_up, increased_down; // lower end points of arcs that became heavier
+
+    while (!pq.empty())
+    {
+        const int x = pq.top().second;
+        pq.pop();
+        queued[x] = 0;
+
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            const std::vector<int> &arcs_at_x = pass == 0 ? hierarchy.up_out[x] : hierarchy.up_in[x];
+            for (std::size_t ind = 0; ind < arcs_at_x.size(); ++ind)
+            {
+                const int a = arcs_at_x[ind];
+                if (!hierarchy.arcs[a].dirty)
+                    continue;
+
+                const double old_weight = hierarchy.arcs[a].weight;
+                const double new_weight = recompute(a);
+                if (new_weight == old_weight)
+                    continue;
+
+                hierarchy.arcs[a].weight = new_weight;
+                if (new_weight < old_weight)
+                    witness_check[x] = 1;
+                else
+                    (pass == 0 ? increased_up : increased_down).push_back(x);
+
+                mark_dependents(a, x);
+            }
+        }
+    }
+
+    // Witnesses may have used heavier arcs. A witness in the hierarchy is an up-down
+    // path, so only nodes whose upper neighbours reach such an arc need a new check
+
+    {
+        std::vector<char> reached(n, 0);
+        auto closure = [&](std::vector<int> &stack, bool forward)
+        {
+            std::fill(reached.begin(), reached.end(), 0);
+            for (int x : stack)
+                reached[x] = 1;
+
+            while (!stack.empty())
+            {
+                const int x = stack.back();
+                stack.pop_back();
+
+                // forward: upper in-neighbour u of v reaches x upwards, v in down_out[u]
+                // backward: upper out-neighbour w of v reaches x upwards in reverse, v in down_in[w]
+                for (int b : forward ? hierarchy.down_out[x] : hierarchy.down_in[x])
+                {
+                    const int v = forward ? hierarchy.arcs[b].to : hierarchy.arcs[b].from;
+                    witness_check[v] = 1;
+                }
+
+                for (int b : forward ? hierarchy.down_in[x] : hierarchy.down_out[x])
+                {
+                    const int y = forward ? hierarchy.arcs[b].from : hierarchy.arcs[b].to;
+                    if (!reached[y])
+                    {
+                        reached[y] = 1;
+                        stack.push_back(y);
+                    }
+                }
+            }
+        };
+
+        closure(increased_up, true);
+        closure(increased_down, false);
+    }
+
+    for (int x = 0; x < n; ++x)
+        if (witness_check[x])
+            push_node(x);
+
+    // Pass 2: repeat witness searches of affected nodes, weights can only decrease from now on
+
+    std::vector<double> dist(n, INF);
+    std::vector<int> touched;
+    using QItem = std::pair<double, int>;
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> dpq;
+
+    auto witness_search = [&](int v, int u, double max_dist)
+    {
+        for (int y : touched)
+            dist[y] = INF;
+        touched.clear();
+
+        dist[u] = 0.0;
+        touched.push_back(u);
+        dpq.push(QItem(0.0, u));
+
+        while (!dpq.empty())
+        {
+            const auto [d, y] = dpq.top();
+            dpq.pop();
+
+            if (d != dist[y])
+                continue;
+            if (d > max_dist)
+                break;
+
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                for (int b : pass == 0 ? hierarchy.up_out[y] : hierarchy.down_out[y])
+                {
+                    const int z = hierarchy.arcs[b].to;
+                    if (z == v || ranks[z] <= ranks[v])
+                        continue;
+
+                    const double nd = d + hierarchy.arcs[b].weight;
+                    if (nd <= max_dist && nd < dist[z])
+                    {
+                        if (dist[z] == INF)
+                            touched.push_back(z);
+                        dist[z] = nd;
+                        dpq.push(QItem(nd, z));
+                    }
+                }
+            }
+        }
+        while (!dpq.empty())
+            dpq.pop();
+    };
+
+    while (!pq.empty())
+    {
+        const int v = pq.top().second;
+        pq.pop();
+        queued[v] = 0;
+
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            const std::vector<int> &arcs_at_v = pass == 0 ? hierarchy.up_out[v] : hierarchy.up_in[v];
+            for (std::size_t ind = 0; ind < arcs_at_v.size(); ++ind)
+            {
+                const int a = arcs_at_v[ind];
+                if (!hierarchy.arcs[a].dirty)
+                    continue;
+
+                const double old_weight = hierarchy.arcs[a].weight;
+                const double new_weight = recompute(a);
+                if (new_weight < old_weight)
+                {
+                    hierarchy.arcs[a].weight = new_weight;
+                    witness_check[v] = 1;
+                    mark_dependents(a, v);
+                }
+            }
+        }
+
+        if (!witness_check[v])
+            continue;
+        witness_check[v] = 0;
+
+        // Copies, adding shortcuts may reallocate the adjacency of upper nodes
+        const std::vector<int> incoming = hierarchy.up_in[v];
+        const std::vector<int> outgoing = hierarchy.up_out[v];
+
+        for (int in_a : incoming)
+        {
+            const int u = hierarchy.arcs[in_a].from;
+            const double w_uv = hierarchy.arcs[in_a].weight;
+            if (w_uv == INF)
+                continue;
+
+            std::vector<std::pair<int, double>> targets;
+            double max_dist = 0.0;
+            for (int out_a : outgoing)
+            {
+                const int w = hierarchy.arcs[out_a].to;
+                const double shortcut_weight = w_uv + hierarchy.arcs[out_a].weight;
+                if (w == u || shortcut_weight == INF || hierarchy.find_arc(u, w) != -1)
+                    continue;
+
+                targets.emplace_back(w, shortcut_weight);
+                max_dist = std::max(max_dist, shortcut_weight);
+            }
+            if (targets.empty())
+                continue;
+
+            witness_search(v, u, max_dist);
+
+            for (auto &[w, shortcut_weight] : targets)
+            {
+                if (dist[w] <= shortcut_weight)
+                    continue;
+
+                // New shortcut starts heavy and gets its weight when its lower end point is processed
+                const int a = hierarchy.add_arc(u, w, INF, INF, v);
+                mark_dirty(a);
+            }
+        }
+    }
+
+    // Build the forward and backward graphs
+
+    preproc_graph.forward_first_out.assign(n + 1, 0);
+    preproc_graph.backward_first_out.assign(n + 1, 0);
+    preproc_graph.forward_arcs.clear();
+    preproc_graph.backward_arcs.clear();
+
+    for (int x = 0; x < n; ++x)
+    {
+        for (int a : hierarchy.up_out[x])
+        {
+            const DynamicArc &arc = hierarchy.arcs[a];
+            preproc_graph.forward_arcs.push_back(CHGraph::CHArc{x, arc.to, arc.weight, arc.mid_node});
+        }
+        for (int a : hierarchy.up_in[x])
+        {
+            const DynamicArc &arc = hierarchy.arcs[a];
+            preproc_graph.backward_arcs.push_back(CHGraph::CHArc{x, arc.from, arc.weight, arc.mid_node});
+        }
+        preproc_graph.forward_first_out[x + 1] = static_cast<int>(preproc_graph.forward_arcs.size());
+        preproc_graph.backward_first_out[x + 1] = static_cast<int>(preproc_graph.backward_arcs.size());
+    }
+
+    // Opened or closed arcs change which nodes reach each other
+    CHGraph::compute_components(graph, preproc_graph);
+}
@@ -0,0 +1,252 @@
+#include "chain_compression.hpp"
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+    enum class ChainType : char
+    {
+        NONE,
+        ONE_WAY,
+        TWO_WAY
+    };
+
+    struct Attachment
+    {
+        int node;     // compressed id of a kept node
+        double dist;
+    };
+
+    double arc_weight(const CHGraph::Graph &graph, const int from, const int to)
+    {
+        for (int e = graph.first_out[from]; e < graph.first_out[from + 1]; ++e)
+            if (graph.to[e] == to)
+                return graph.weights[e];
+        return std::numeric_limits<double>::infinity();
+    }
+
+    int chain_of(const CHGraph::ChainCompression &compression, const int position)
+    {
+        return static_cast<int>(std::upper_bound(compression.chain_first.begin(), compression.chain_first.end(), position) -
+                                compression.chain_first.begin()) - 1;
+    }
+
+    // Kept nodes reachable from node (leaving) or reaching node (!leaving) without passing another kept node
+    int attachments(const CHGraph::ChainCompression &compression, const int node, const bool leaving, Attachment result[2])
+    {
+        if (compression.mapping.to_normalized[node] != -1)
+        {
+            result[0] = Attachment{compression.mapping.to_normalized[node], 0.0};
+            return 1;
+        }
+
+        const int position = compression.node_position[node];
+        if (position == -1)
+            return 0;
+
+        const int chain = chain_of(compression, position);
+        const double tail_dist = leaving ? compression.to_tail[position] : compression.from_tail[position];
+        const double head_dist = leaving ? compression.to_head[position] : compression.from_head[position];
+
+        int count = 0;
+        if (!std::isinf(tail_dist))
+            result[count++] = Attachment{compression.mapping.to_normalized[compression.chain_tail[chain]], tail_dist};
+        if (!std::isinf(head_dist))
+            result[count++] = Attachment{compression.mapping.to_normalized[compression.chain_head[chain]], head_dist};
+        return count;
+    }
+}
+
+void CHGraph::compress_chains(const CHGraph::Graph &input_graph, CHGraph::ChainCompression &compression)
+{
+    // Parallel arcs and self loops would hide chain nodes, normalization keeps the ids
+    CHGraph::Graph graph;
+    CHGraph::NodeMapping identity;
+    CHGraph::normalize_graph(input_graph, graph, identity);
+
+    const int n = static_cast<int>(identity.to_original.size());
+    const int m = static_cast<int>(graph.to.size());
+
+    // Incoming arcs, sorted by tail like the outgoing ones are by head
+    std::vector<int> in_first(n + 1, 0), in_from(m);
+    for (int e = 0; e < m; ++e)
+        ++in_first[graph.to[e] + 1];
+    for (int v = 0; v < n; ++v)
+        in_first[v + 1] += in_first[v];
+    std::vector<int> next_in(in_first.begin(), in_first.end() - 1);
+    for (int e = 0; e < m; ++e)
+        in_from[next_in[graph.to[e]]++] = graph.from[e];
+
+    std::vector<ChainType> chain_type(n, ChainType::NONE);
+    for (int v = 0; v < n; ++v)
+    {
+        const int out_degree = graph.first_out[v + 1] - graph.first_out[v];
+        const int in_degree = in_first[v + 1] - in_first[v];
+        const int *out = graph.to.data() + graph.first_out[v];
+        const int *in = in_from.data() + in_first[v];
+
+        if (out_degree == 1 && in_degree == 1 && out[0] != in[0])
+            chain_type[v] = ChainType::ONE_WAY;
+        else if (out_degree == 2 && in_degree == 2 && out[0] == in[0] && out[1] == in[1])
+            chain_type[v] = ChainType::TWO_WAY;
+    }
+
+    compression = CHGraph::ChainCompression{};
+    compression.chain_first.push_back(0);
+    compression.node_position.assign(n, -1);
+
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<std::vector<std::pair<int, double>>> chain_arcs(n);
+    std::vector<int> path;
+    std::vector<double> forward, backward; // forward[i] = weight of path[i] -> path[i + 1], backward the reverse
+
+    for (int x = 0; x < n; ++x)
+    {
+        if (chain_type[x] != ChainType::NONE)
+            continue;
+
+        for (int e = graph.first_out[x]; e < graph.first_out[x + 1]; ++e)
+        {
+            const int first = graph.to[e];
+            if (chain_type[first] == ChainType::NONE || compression.node_position[first] != -1)
+                continue;
+
+            // A chain reached from a kept node can not be a cycle of chain nodes, so the walk ends at a kept node
+            path.assign(1, x);
+            int prev = x, cur = first;
+            while (chain_type[cur] != ChainType::NONE)
+            {
+                path.push_back(cur);
+                const int *out = graph.to.data() + graph.first_out[cur];
+                const int next = (chain_type[cur] == ChainType::ONE_WAY || out[0] != prev) ? out[0] : out[1];
+                prev = cur;
+                cur = next;
+            }
+            path.push_back(cur);
+
+            if (cur == x)
+                continue;
+
+            const int k = static_cast<int>(path.size()) - 1;
+            forward.resize(k);
+            backward.resize(k);
+            for (int i = 0; i < k; ++i)
+            {
+                forward[i] = arc_weight(graph, path[i], path[i + 1]);
+                backward[i] = (chain_type[first] == ChainType::TWO_WAY) ? arc_weight(graph, path[i + 1], path[i]) : INF;
+            }
+
+            const int offset = static_cast<int>(compression.chain_nodes.size());
+            compression.chain_tail.push_back(x);
+            compression.chain_head.push_back(cur);
+            compression.chain_nodes.insert(compression.chain_nodes.end(), path.begin() + 1, path.end() - 1);
+            compression.chain_first.push_back(offset + k - 1);
+            compression.from_tail.resize(offset + k - 1);
+            compression.to_tail.resize(offset + k - 1);
+            compression.to_head.resize(offset + k - 1);
+            compression.from_head.resize(offset + k - 1);
+
+            double from_tail = 0.0, to_tail = 0.0;
+            for (int i = 1; i < k; ++i)
+            {
+                from_tail += forward[i - 1];
+                to_tail += backward[i - 1];
+                compression.from_tail[offset + i - 1] = from_tail;
+                compression.to_tail[offset + i - 1] = to_tail;
+                compression.node_position[path[i]] = offset + i - 1;
+            }
+            double to_head = 0.0, from_head = 0.0;
+            for (int i = k - 1; i >= 1; --i)
+            {
+                to_head += forward[i];
+                from_head += backward[i];
+                compression.to_head[offset + i - 1] = to_head;
+                compression.from_head[offset + i - 1] = from_head;
+            }
+
+            chain_arcs[x].emplace_back(cur, from_tail + forward[k - 1]);
+            if (chain_type[first] == ChainType::TWO_WAY)
+                chain_arcs[cur].emplace_back(x, to_tail + backward[k - 1]);
+        }
+    }
+
+    // Kept arcs and chain arcs in original ids, normalization merges parallel arcs and drops the chain nodes
+    CHGraph::Graph kept_graph;
+    kept_graph.first_out.assign(n + 1, 0);
+    for (int u = 0; u < n; ++u)
+    {
+        if (compression.node_position[u] == -1)
+        {
+            for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+            {
+                if (compression.node_position[graph.to[e]] != -1)
+                    continue;
+                kept_graph.from.push_back(u);
+                kept_graph.to.push_back(graph.to[e]);
+                kept_graph.weights.push_back(graph.weights[e]);
+            }
+            for (const auto &[to, weight] : chain_arcs[u])
+            {
+                kept_graph.from.push_back(u);
+                kept_graph.to.push_back(to);
+                kept_graph.weights.push_back(weight);
+            }
+        }
+        kept_graph.first_out[u + 1] = static_cast<int>(kept_graph.to.size());
+    }
+
+    CHGraph::normalize_graph(kept_graph, compression.graph, compression.mapping, true);
+}
+
+void CHGraph::query_route(const CHGraph::ChainCompression &compression, const CHGraph::PreprocGraph &preproc_graph,
+                          const CHGraph::Destination &destination, CHGraph::Route &route)
+{
+    route.nodes.clear();
+    route.total_weight = std::numeric_limits<double>::infinity();
+
+    const int n = static_cast<int>(compression.node_position.size());
+    const int s = destination.source;
+    const int t = destination.target;
+    if (s < 0 || s >= n || t < 0 || t >= n)
+        return;
+    if (s == t)
+    {
+        route.total_weight = 0.0;
+        return;
+    }
+
+    // Both in the same chain, directly along it
+    const int s_position = compression.node_position[s];
+    const int t_position = compression.node_position[t];
+    if (s_position != -1 && t_position != -1 && chain_of(compression, s_position) == chain_of(compression, t_position))
+    {
+        if (s_position < t_position)
+            route.total_weight = compression.from_tail[t_position] - compression.from_tail[s_position];
+        else if (!std::isinf(compression.to_tail[s_position]))
+            route.total_weight = compression.to_tail[s_position] - compression.to_tail[t_position];
+    }
+
+    Attachment exits[2], entries[2];
+    const int exit_number = attachments(compression, s, true, exits);
+    const int entry_number = attachments(compression, t, false, entries);
+
+    for (int i = 0; i < exit_number; ++i)
+    {
+        for (int j = 0; j < entry_number; ++j)
+        {
+            double between = 0.0;
+            if (exits[i].node != entries[j].node)
+            {
+                CHGraph::Route part;
+                CHGraph::query_route(compression.graph, preproc_graph, CHGraph::Destination{.source = exits[i].node, .target = entries[j].node}, part);
+                between = part.total_weight;
+            }
+            route.total_weight = std::min(route.total_weight, exits[i].dist + between + entries[j].dist);
+        }
+    }
+}
@@ -0,0 +1,273 @@
+#include "compressed_graph.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+
+// Largest weight that is still bit-packed, every integer up to it is exact as double
+constexpr double MAX_PACKED_WEIGHT = 9007199254740992.0; // 2^53
+
+
+static void append_varint(std::uint64_t value, std::vector<std::uint8_t> &bytes)
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<std::uint8_t>(value));
+}
+
+// adjacency[node] lists (head, weight) of every arc leaving node
+static void compress_arcs(std::vector<std::vector<std::pair<int, double>>> &adjacency, CHGraph::CompressedArcs &arcs)
+{
+    const int n = static_cast<int>(adjacency.size());
+
+    arcs = CHGraph::CompressedArcs();
+    arcs.first_out.assign(n + 1, 0);
+    arcs.first_byte.assign(n + 1, 0);
+
+    std::vector<double> weights;
+    for (int u = 0; u < n; ++u)
+    {
+        std::sort(adjacency[u].begin(), adjacency[u].end());
+
+        std::int64_t previous = u;
+        for (size_t i = 0; i < adjacency[u].size(); ++i)
+        {
+            const std::int64_t delta = adjacency[u][i].first - previous;
+            previous = adjacency[u][i].first;
+            // only the first delta can be negative
+            append_varint(i == 0 ? (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63)
+                                 : static_cast<std::uint64_t>(delta), arcs.heads);
+            weights.push_back(adjacency[u][i].second);
+        }
+
+        if (arcs.heads.size() > std::numeric_limits<std::uint32_t>::max())
+            throw std::runtime_error("Compressed adjacency exceeds 4 GiB");
+
+        arcs.first_out[u + 1] = static_cast<int>(weights.size());
+        arcs.first_byte[u + 1] = static_cast<std::uint32_t>(arcs.heads.size());
+    }
+    arcs.heads.shrink_to_fit();
+
+    double max_weight = 0.0;
+    for (double weight : weights)
+    {
+        if (!(weight >= 0.0 && weight <= MAX_PACKED_WEIGHT && weight == std::floor(weight)))
+        {
+            arcs.packed_weights = false;
+            arcs.raw_weights = std::move(weights);
+            return;
+        }
+        max_weight = std::max(max_weight, weight);
+    }
+
+    const std::uint64_t max_value = static_cast<std::uint64_t>(max_weight);
+    while (arcs.weight_bits < 64 && (max_value >> arcs.weight_bits) != 0)
+        ++arcs.weight_bits;
+
+    arcs.weight_words.assign((weights.size() * arcs.weight_bits + 63) / 64 + 1, 0);
+    for (size_t e = 0; e < weights.size() && arcs.weight_bits > 0; ++e)
+    {
+        const std::uint64_t value = static_cast<std::uint64_t>(weights[e]);
+        const std::uint64_t bit = e * arcs.weight_bits;
+        const int shift = static_cast<int>(bit % 64);
+
+        arcs.weight_words[bit / 64] |= value << shift;
+        if (shift + arcs.weight_bits > 64)
+            arcs.weight_words[bit / 64 + 1] |= value >> (64 - shift);
+    }
+}
+
+static void compress_ch_arcs(const std::vector<int> &first_out, const std::vector<CHGraph::CHArc> &ch_arcs,
+                             CHGraph::CompressedArcs &arcs)
+{
+    const int n = static_cast<int>(first_out.size()) - 1;
+    std::vector<std::vector<std::pair<int, double>>> adjacency(std::max(n, 0));
+    for (int u = 0; u < n; ++u)
+        for (int e = first_out[u]; e < first_out[u + 1]; ++e)
+            adjacency[u].emplace_back(ch_arcs[e].to, ch_arcs[e].weight);
+
+    compress_arcs(adjacency, arcs);
+}
+
+void CHGraph::compress_graph(const CHGraph::Graph &graph, CHGraph::CompressedGraph &compressed_graph)
+{
+    const int n = static_cast<int>(graph.first_out.size()) - 1;
+    std::vector<std::vector<std::pair<int, double>>> adjacency(std::max(n, 0));
+    for (int u = 0; u < n; ++u)
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+            adjacency[u].emplace_back(graph.to[e], graph.weights[e]);
+
+    compress_arcs(adjacency, compressed_graph.arcs);
+}
+
+void CHGraph::compress_preproc_graph(const CHGraph::PreprocGraph &preproc_graph, CHGraph::CompressedPreprocGraph &compressed_graph)
+{
+    compress_ch_arcs(preproc_graph.forward_first_out, preproc_graph.forward_arcs, compressed_graph.forward_arcs);
+    compress_ch_arcs(preproc_graph.backward_first_out, preproc_graph.backward_arcs, compressed_graph.backward_arcs);
+}
+
+// Same search as bidirectional_upward_search in ch_graph.cpp, decoding the arcs on the fly
+void CHGraph::query_route(const CHGraph::CompressedPreprocGraph &compressed_graph, const CHGraph::Destination &destination,
+                          CHGraph::Route &route)
+{
+    route.nodes.clear();
+    route.total_weight = std::numeric_limits<double>::infinity();
+
+    const CompressedArcs &forward_arcs = compressed_graph.forward_arcs;
+    const CompressedArcs &backward_arcs = compressed_graph.backward_arcs;
+    const int n = static_cast<int>(forward_arcs.first_out.size()) - 1;
+    const int s = destination.source;
+    const int t = destination.target;
+
+    if (n <= 0 || s < 0 || s >= n || t < 0 || t >= n) return;
+
+    if (s == t)
+    {
+        route.total_weight = 0.0;
+        return;
+    }
+
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> dist_f(n, INF), dist_b(n, INF);
+
+    using QItem = std::pair<double, int>;
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pqf, pqb;
+
+    dist_f[s] = 0.0; pqf.push(QItem(0.0, s));
+    dist_b[t] = 0.0; pqb.push(QItem(0.0, t));
+
+    double best_dist = INF;
+    auto top_dist = [](const auto &pq) -> double { return pq.empty() ? std::numeric_limits<double>::infinity() : pq.top().first; };
+
+    // A node is stalled if a higher ranked neighbor already reaches it on a shorter path
+    auto stalled = [](const CompressedArcs &arcs, int v, const std::vector<double> &dist) {
+        bool stall = false;
+        for_each_compressed_arc(arcs, v, [&](int u, double w) {
+            if (dist[u] < std::numeric_limits<double>::infinity() && dist[u] + w < dist[v])
+                stall = true;
+        });
+        return stall;
+    };
+
+    // Settles the top node of pq, relaxing its arcs unless the node is stalled
+    auto settle = [&](auto &pq, std::vector<double> &dist, const std::vector<double> &other_dist,
+                      const CompressedArcs &arcs, const CompressedArcs &stall_arcs) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u]) return;
+
+        if (!stalled(stall_arcs, u, dist))
+        {
+            for_each_compressed_arc(arcs, u, [&](int v, double w) {
+                if (d + w < dist[v])
+                {
+                    dist[v] = d + w;
+                    pq.push(QItem(d + w, v));
+                }
+            });
+        }
+
+        if (other_dist[u] < INF)
+            best_dist = std::min(best_dist, dist[u] + other_dist[u]);
+    };
+
+    while (!pqf.empty() || !pqb.empty())
+    {
+        const double forward_min_dist = top_dist(pqf);
+        const double backward_min_dist = top_dist(pqb);
+        const bool forward_can_improve = forward_min_dist < best_dist;
+        const bool backward_can_improve = backward_min_dist < best_dist;
+
+        if (!forward_can_improve && !backward_can_improve) break;
+
+        if (forward_can_improve && (!backward_can_improve || forward_min_dist <= backward_min_dist))
+            settle(pqf, dist_f, dist_b, forward_arcs, backward_arcs);
+        else
+            settle(pqb, dist_b, dist_f, backward_arcs, forward_arcs);
+    }
+
+    route.total_weight = best_dist;
+}
+
+// for_each_arc(u, func) calls func(head, weight) for every arc leaving u
+template <typename ForEachArc>
+static void dijkstra(const int n, const CHGraph::Destination &destination, CHGraph::Route &route, ForEachArc for_each_arc)
+{
+    route.nodes.clear();
+    route.total_weight = std::numeric_limits<double>::infinity();
+
+    const int s = destination.source;
+    const int t = destination.target;
+    if (n <= 0 || s < 0 || s >= n || t < 0 || t >= n) return;
+
+    std::vector<double> dist(n, std::numeric_limits<double>::infinity());
+
+    using QItem = std::pair<double, int>;
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
+
+    dist[s] = 0.0;
+    pq.push(QItem(0.0, s));
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.top();
+        pq.pop();
+
+        if (d > dist[u]) continue;
+        if (u == t) break;
+
+        for_each_arc(u, [&](int v, double w) {
+            if (d + w < dist[v])
+            {
+                dist[v] = d + w;
+                pq.push(QItem(d + w, v));
+            }
+        });
+    }
+
+    route.total_weight = dist[t];
+}
+
+void CHGraph::query_route_dijkstra(const CHGraph::Graph &graph, const CHGraph::Destination &destination, CHGraph::Route &route)
+{
+    dijkstra(static_cast<int>(graph.first_out.size()) - 1, destination, route, [&](int u, auto func) {
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+            func(graph.to[e], graph.weights[e]);
+    });
+}
+
+void CHGraph::query_route_dijkstra(const CHGraph::CompressedGraph &compressed_graph, const CHGraph::Destination &destination,
+                                   CHGraph::Route &route)
+{
+    const CompressedArcs &arcs = compressed_graph.arcs;
+    dijkstra(static_cast<int>(arcs.first_out.size()) - 1, destination, route, [&](int u, auto func) {
+        for_each_compressed_arc(arcs, u, func);
+    });
+}
+
+std::size_t CHGraph::graph_memory(const CHGraph::Graph &graph)
+{
+    return (graph.first_out.size() + graph.from.size() + graph.to.size()) * sizeof(int) +
+           graph.weights.size() * sizeof(double);
+}
+
+std::size_t CHGraph::preproc_graph_memory(const CHGraph::PreprocGraph &preproc_graph)
+{
+    return (preproc_graph.ranks.size() + preproc_graph.forward_first_out.size() + preproc_graph.backward_first_out.size() +
+            preproc_graph.components.size()) * sizeof(int) +
+           (preproc_graph.forward_arcs.size() + preproc_graph.backward_arcs.size()) * sizeof(CHGraph::CHArc) +
+           preproc_graph.component_reachability.size() * sizeof(std::uint64_t);
+}
+
+std::size_t CHGraph::compressed_arcs_memory(const CHGraph::CompressedArcs &arcs)
+{
+    return arcs.first_out.size() * sizeof(int) + arcs.first_byte.size() * sizeof(std::uint32_t) +
+           arcs.heads.size() * sizeof(std::uint8_t) + arcs.weight_words.size() * sizeof(std::uint64_t) +
+           arcs.raw_weights.size() * sizeof(double);
+}
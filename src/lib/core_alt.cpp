@@ -0,0 +1,353 @@
+#include "core_alt.hpp"
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <functional>
+#include <utility>
+#include <algorithm>
+
+
+// Dijkstra on the core graph (or its reverse) from core node source, dist is indexed by core index
+static void core_dijkstra(const CHGraph::CoreALTGraph &core_graph, int source, bool forward, std::vector<double> &dist)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const std::vector<int> &first_out = forward ? core_graph.core_first_out : core_graph.core_backward_first_out;
+    const std::vector<CHGraph::CHArc> &arcs = forward ? core_graph.core_arcs : core_graph.core_backward_arcs;
+
+    std::fill(dist.begin(), dist.end(), INF);
+
+    using QItem = std::pair<double, int>;
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
+
+    dist[core_graph.core_index[source]] = 0.0;
+    pq.push(QItem(0.0, source));
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.top();
+        pq.pop();
+
+        if (d > dist[core_graph.core_index[u]])
+            continue;
+
+        for (int e = first_out[u]; e < first_out[u + 1]; ++e)
+        {
+            const int v = arcs[e].to;
+            const double nd = d + arcs[e].weight;
+            if (nd < dist[core_graph.core_index[v]])
+            {
+                dist[core_graph.core_index[v]] = nd;
+                pq.push(QItem(nd, v));
+            }
+        }
+    }
+}
+
+void CHGraph::preproc_graph_core_alt(const CHGraph::Graph &graph, const int core_size, const int landmark_number,
+                                     CHGraph::CoreALTGraph &core_graph)
+{
+    const int n = graph.first_out.empty() ? 0 : static_cast<int>(graph.first_out.size()) - 1;
+    const double INF = std::numeric_limits<double>::infinity();
+
+    core_graph = CHGraph::CoreALTGraph{};
+
+    // Bottom up contraction until only core_size nodes remain, core nodes get the highest ranks
+
+    CHGraph::PreprocGraph overlay;
+    CHGraph::preproc_graph_bottom_up(graph, overlay, CHGraph::PreprocOptions{.core_size = core_size});
+
+    const int core_number = std::clamp(core_size, 0, n);
+    const int first_core_rank = n - core_number;
+
+    core_graph.core_index.assign(n, -1);
+    for (int v = 0; v < n; ++v)
+        if (overlay.ranks[v] >= first_core_rank)
+            core_graph.core_index[v] = overlay.ranks[v] - first_core_rank;
+
+    // Split arcs into hierarchy (forward / backward) and core graph
+
+    CHGraph::PreprocGraph &hierarchy = core_graph.hierarchy;
+    hierarchy.ranks = std::move(overlay.ranks);
+
+    auto in_core = [&core_graph](const CHGraph::CHArc &arc)
+    { return core_graph.core_index[arc.from] != -1 && core_graph.core_index[arc.to] != -1; };
+
+    std::vector<std::vector<CHGraph::CHArc>> f_adj(n), b_adj(n), core_adj(n), core_rev_adj(n);
+    for (const CHGraph::CHArc &arc : overlay.forward_arcs)
+    {
+        if (in_core(arc))
+        {
+            core_adj[arc.from].push_back(arc);
+            core_rev_adj[arc.to].push_back(CHGraph::CHArc{arc.to, arc.from, arc.weight, arc.mid_node});
+        }
+        else
+            f_adj[arc.from].push_back(arc);
+    }
+    // backward arcs are reversed, arc.to -> arc.from is the original direction
+    for (const CHGraph::CHArc &arc : overlay.backward_arcs)
+    {
+        if (in_core(arc))
+        {
+            core_adj[arc.to].push_back(CHGraph::CHArc{arc.to, arc.from, arc.weight, arc.mid_node});
+            core_rev_adj[arc.from].push_back(arc);
+        }
+        else
+            b_adj[arc.from].push_back(arc);
+    }
+
+    auto to_csr = [n](const std::vector<std::vector<CHGraph::CHArc>> &adj, std::vector<int> &first_out,
+                      std::vector<CHGraph::CHArc> &arcs)
+    {
+        first_out.assign(n + 1, 0);
+        arcs.clear();
+        for (int u = 0; u < n; ++u)
+        {
+            arcs.insert(arcs.end(), adj[u].begin(), adj[u].end());
+            first_out[u + 1] = static_cast<int>(arcs.size());
+        }
+    };
+
+    to_csr(f_adj, hierarchy.forward_first_out, hierarchy.forward_arcs);
+    to_csr(b_adj, hierarchy.backward_first_out, hierarchy.backward_arcs);
+    to_csr(core_adj, core_graph.core_first_out, core_graph.core_arcs);
+    to_csr(core_rev_adj, core_graph.core_backward_first_out, core_graph.core_backward_arcs);
+
+    // Farthest point landmark selection on the core
+
+    if (core_number == 0 || landmark_number <= 0)
+        return;
+
+    std::vector<int> core_nodes(core_number);
+    for (int v = 0; v < n; ++v)
+        if (core_graph.core_index[v] != -1)
+            core_nodes[core_graph.core_index[v]] = v;
+
+    const int selected_number = std::min(landmark_number, core_number);
+    core_graph.landmark_from.assign(static_cast<std::size_t>(selected_number) * core_number, INF);
+    core_graph.landmark_to.assign(static_cast<std::size_t>(selected_number) * core_number, INF);
+
+    std::vector<double> from_dist(core_number), to_dist(core_number);
+    std::vector<double> separation(core_number, INF); // min over landmarks of round trip distance
+
+    // Start from the node farthest away from an arbitrary core node
+    core_dijkstra(core_graph, core_nodes[0], true, from_dist);
+    int next = 0;
+    for (int ind = 0; ind < core_number; ++ind)
+        if (from_dist[ind] > from_dist[next])
+            next = ind;
+
+    for (int l = 0; l < selected_number; ++l)
+    {
+        const int landmark = core_nodes[next];
+        core_graph.landmarks.push_back(landmark);
+
+        core_dijkstra(core_graph, landmark, true, from_dist);
+        core_dijkstra(core_graph, landmark, false, to_dist);
+        std::copy(from_dist.begin(), from_dist.end(), core_graph.landmark_from.begin() + static_cast<std::size_t>(l) * core_number);
+        std::copy(to_dist.begin(), to_dist.end(), core_graph.landmark_to.begin() + static_cast<std::size_t>(l) * core_number);
+
+        separation[next] = -1.0;
+        next = -1;
+        for (int ind = 0; ind < core_number; ++ind)
+        {
+            if (separation[ind] < 0.0)
+                continue;
+            separation[ind] = std::min(separation[ind], from_dist[ind] + to_dist[ind]);
+            if (next == -1 || separation[ind] > separation[next])
+                next = ind;
+        }
+        if (next == -1)
+            break;
+    }
+}
+
+void CHGraph::query_route_core_alt(const CHGraph::CoreALTGraph &core_graph, const CHGraph::Destination &destination,
+                                   CHGraph::Route &route)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const CHGraph::PreprocGraph &hierarchy = core_graph.hierarchy;
+    const int n = static_cast<int>(hierarchy.ranks.size());
+    const int s = destination.source;
+    const int t = destination.target;
+
+    route.nodes.clear();
+    route.total_weight = INF;
+
+    if (n <= 0 || s < 0 || s >= n || t < 0 || t >= n)
+        return;
+
+    if (s == t)
+    {
+        route.total_weight = 0.0;
+        return;
+    }
+
+    std::vector<double> dist_f(n, INF), dist_b(n, INF);
+    std::vector<int> entries_f, entries_b;
+
+    using QItem = std::pair<double, int>;
+
+    // Upward searches in the contracted part, core nodes are reached but not expanded
+    auto upward_search = [&](int source, bool forward, std::vector<double> &dist, std::vector<int> &entries)
+    {
+        const std::vector<int> &first_out = forward ? hierarchy.forward_first_out : hierarchy.backward_first_out;
+        const std::vector<CHGraph::CHArc> &arcs = forward ? hierarchy.forward_arcs : hierarchy.backward_arcs;
+        std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
+
+        dist[source] = 0.0;
+        pq.push(QItem(0.0, source));
+
+        while (!pq.empty())
+        {
+            auto [d, u] = pq.top();
+            pq.pop();
+
+            if (d > dist[u])
+                continue;
+
+            if (core_graph.core_index[u] != -1)
+            {
+                entries.push_back(u);
+                continue;
+            }
+
+            for (int e = first_out[u]; e < first_out[u + 1]; ++e)
+            {
+                const double nd = d + arcs[e].weight;
+                if (nd < dist[arcs[e].to])
+                {
+                    dist[arcs[e].to] = nd;
+                    pq.push(QItem(nd, arcs[e].to));
+                }
+            }
+        }
+    };
+
+    upward_search(s, true, dist_f, entries_f);
+    upward_search(t, false, dist_b, entries_b);
+
+    double best_dist = INF;
+    for (int v = 0; v < n; ++v)
+        if (dist_f[v] < INF && dist_b[v] < INF)
+            best_dist = std::min(best_dist, dist_f[v] + dist_b[v]);
+
+    if (entries_f.empty() || entries_b.empty())
+    {
+        route.total_weight = best_dist;
+        return;
+    }
+
+    // Landmark lower bound on dist(x, y) for core nodes
+    const int landmark_number = static_cast<int>(core_graph.landmarks.size());
+    const std::size_t core_number = landmark_number == 0 ? 0 : core_graph.landmark_from.size() / landmark_number;
+
+    auto lower_bound = [&](int x, int y)
+    {
+        const std::size_t cx = core_graph.core_index[x];
+        const std::size_t cy = core_graph.core_index[y];
+        double bound = 0.0;
+
+        for (int l = 0; l < landmark_number; ++l)
+        {
+            const double to_x = core_graph.landmark_to[l * core_number + cx];
+            const double to_y = core_graph.landmark_to[l * core_number + cy];
+            const double from_x = core_graph.landmark_from[l * core_number + cx];
+            const double from_y = core_graph.landmark_from[l * core_number + cy];
+
+            // dist(x, L) <= dist(x, y) + dist(y, L)
+            if (to_x == INF && to_y < INF)
+                return INF;
+            if (to_x < INF && to_y < INF)
+                bound = std::max(bound, to_x - to_y);
+
+            // dist(L, y) <= dist(L, x) + dist(x, y)
+            if (from_y == INF && from_x < INF)
+                return INF;
+            if (from_x < INF && from_y < INF)
+                bound = std::max(bound, from_y - from_x);
+        }
+        return bound;
+    };
+
+    // Potentials towards the set of exits (forward) and from the set of entries (backward)
+    std::vector<double> potential_f(n, -1.0), potential_b(n, -1.0);
+
+    auto get_potential_f = [&](int x)
+    {
+        if (potential_f[x] < 0.0)
+        {
+            double p = INF;
+            for (int c : entries_b)
+                p = std::min(p, lower_bound(x, c) + dist_b[c]);
+            potential_f[x] = p;
+        }
+        return potential_f[x];
+    };
+
+    auto get_potential_b = [&](int x)
+    {
+        if (potential_b[x] < 0.0)
+        {
+            double p = INF;
+            for (int c : entries_f)
+                p = std::min(p, dist_f[c] + lower_bound(c, x));
+            potential_b[x] = p;
+        }
+        return potential_b[x];
+    };
+
+    // Bidirectional A* in the core (symmetric approach)
+
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pqf, pqb;
+    for (int c : entries_f)
+        pqf.push(QItem(dist_f[c] + get_potential_f(c), c));
+    for (int c : entries_b)
+        pqb.push(QItem(dist_b[c] + get_potential_b(c), c));
+
+    std::vector<char> settled_f(n, 0), settled_b(n, 0);
+
+    auto top_key = [](const auto &pq) -> double { return pq.empty() ? std::numeric_limits<double>::infinity() : pq.top().first; };
+
+    while (!pqf.empty() || !pqb.empty())
+    {
+        const double key_f = top_key(pqf);
+        const double key_b = top_key(pqb);
+
+        if (key_f >= best_dist || key_b >= best_dist)
+            break;
+
+        const bool forward = key_f <= key_b;
+        auto &pq = forward ? pqf : pqb;
+        std::vector<double> &dist = forward ? dist_f : dist_b;
+        std::vector<double> &other_dist = forward ? dist_b : dist_f;
+        std::vector<char> &settled = forward ? settled_f : settled_b;
+        const std::vector<int> &first_out = forward ? core_graph.core_first_out : core_graph.core_backward_first_out;
+        const std::vector<CHGraph::CHArc> &arcs = forward ? core_graph.core_arcs : core_graph.core_backward_arcs;
+
+        const int u = pq.top().second;
+        pq.pop();
+
+        if (settled[u])
+            continue;
+        settled[u] = 1;
+
+        for (int e = first_out[u]; e < first_out[u + 1]; ++e)
+        {
+            const int v = arcs[e].to;
+            const double nd = dist[u] + arcs[e].weight;
+            if (nd >= dist[v])
+                continue;
+
+            dist[v] = nd;
+            if (other_dist[v] < INF)
+                best_dist = std::min(best_dist, nd + other_dist[v]);
+
+            const double potential = forward ? get_potential_f(v) : get_potential_b(v);
+            if (potential < INF)
+                pq.push(QItem(nd + potential, v));
+        }
+    }
+
+    route.total_weight = best_dist;
+}
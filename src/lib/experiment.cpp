@@ -2,10 +2,28 @@
 #include "file_facilities.hpp"
 #include "measurement.hpp"
 #include "ch_graph.hpp"
+#include "cch_graph.hpp"
+#include "core_alt.hpp"
+#include "arc_flags.hpp"
+#include "overlay_graph.hpp"
+#include "compressed_graph.hpp"
+#include "query_pipeline.hpp"
+#include "hierarchy_quality.hpp"
+#include "graph_normalization.hpp"
+#include "chain_compression.hpp"
+#include "preproc_checkpoint.hpp"
 #include "timer.hpp"
+#include "perf_counters.hpp"
+#include "trace.hpp"
 #include <vector>
 #include <string>
 #include <iostream>
+#include <limits>
+#include <filesystem>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <utility>
 
 
 #define MEASURE_TIME(func, stopwatch) \
@@ -15,19 +33,205 @@
         stopwatch.stop();             \
     };
 
+// Every metric recorded by the experiment, registered in this order so that the enum value is the MetricId
+#define EXPERIMENT_METRICS(METRIC) \
+    METRIC(READ_GRAPH, "read_graph") \
+    METRIC(NORMALIZE_GRAPH, "normalize_graph") \
+    METRIC(COMPUTE_COMPONENTS, "compute_components") \
+    METRIC(COMPONENTS, "components") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP, "preproc_graph_bottom_up") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_ADJACENCY, "preproc_graph_bottom_up_adjacency") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_PRIORITIES, "preproc_graph_bottom_up_priorities") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_CONTRACTION, "preproc_graph_bottom_up_contraction") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_ASSEMBLY, "preproc_graph_bottom_up_assembly") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_CONTRACTION_COST, "preproc_graph_bottom_up_contraction_cost") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_GIVEN_ORDER, "preproc_graph_bottom_up_given_order") \
+    METRIC(QUERY_ROUTE_BOTTOM_UP, "query_route_bottom_up") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_WITNESS_SEARCHES, "preproc_graph_bottom_up_witness_searches") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_WITNESS_SETTLED_NODES, "preproc_graph_bottom_up_witness_settled_nodes") \
+    METRIC(PREPROC_GRAPH_BOTTOM_UP_SHORTCUTS_ADDED, "preproc_graph_bottom_up_shortcuts_added") \
+    METRIC(QUERY_ROUTE_BOTTOM_UP_SETTLED_NODES, "query_route_bottom_up_settled_nodes") \
+    METRIC(QUERY_ROUTE_BOTTOM_UP_STALLED_NODES, "query_route_bottom_up_stalled_nodes") \
+    METRIC(QUERY_ROUTE_BOTTOM_UP_RELAXED_ARCS, "query_route_bottom_up_relaxed_arcs") \
+    METRIC(QUERY_ROUTE_BOTTOM_UP_QUEUE_PUSHES, "query_route_bottom_up_queue_pushes") \
+    METRIC(HIERARCHY_BOTTOM_UP_ARCS, "hierarchy_bottom_up_arcs") \
+    METRIC(HIERARCHY_BOTTOM_UP_SHORTCUTS, "hierarchy_bottom_up_shortcuts") \
+    METRIC(HIERARCHY_BOTTOM_UP_FORWARD_SEARCH_SPACE, "hierarchy_bottom_up_forward_search_space") \
+    METRIC(HIERARCHY_BOTTOM_UP_BACKWARD_SEARCH_SPACE, "hierarchy_bottom_up_backward_search_space") \
+    METRIC(HIERARCHY_BOTTOM_UP_FORWARD_SEARCH_ARCS, "hierarchy_bottom_up_forward_search_arcs") \
+    METRIC(HIERARCHY_BOTTOM_UP_BACKWARD_SEARCH_ARCS, "hierarchy_bottom_up_backward_search_arcs") \
+    METRIC(HIERARCHY_BOTTOM_UP_FORWARD_DEGREE, "hierarchy_bottom_up_forward_degree") \
+    METRIC(HIERARCHY_BOTTOM_UP_BACKWARD_DEGREE, "hierarchy_bottom_up_backward_degree") \
+    METRIC(HIERARCHY_BOTTOM_UP_DEPTH, "hierarchy_bottom_up_depth") \
+    METRIC(LOAD_PREPROC_GRAPH_TOP_DOWN, "load_preproc_graph_top_down") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN, "preproc_graph_top_down") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_ADJACENCY, "preproc_graph_top_down_adjacency") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_PRIORITIES, "preproc_graph_top_down_priorities") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_CONTRACTION, "preproc_graph_top_down_contraction") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_ASSEMBLY, "preproc_graph_top_down_assembly") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_CONTRACTION_COST, "preproc_graph_top_down_contraction_cost") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_GIVEN_ORDER, "preproc_graph_top_down_given_order") \
+    METRIC(SAVE_PREPROC_GRAPH_TOP_DOWN, "save_preproc_graph_top_down") \
+    METRIC(QUERY_ROUTE_TOP_DOWN, "query_route_top_down") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_WITNESS_SEARCHES, "preproc_graph_top_down_witness_searches") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_WITNESS_SETTLED_NODES, "preproc_graph_top_down_witness_settled_nodes") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_SHORTCUTS_ADDED, "preproc_graph_top_down_shortcuts_added") \
+    METRIC(QUERY_ROUTE_TOP_DOWN_SETTLED_NODES, "query_route_top_down_settled_nodes") \
+    METRIC(QUERY_ROUTE_TOP_DOWN_STALLED_NODES, "query_route_top_down_stalled_nodes") \
+    METRIC(QUERY_ROUTE_TOP_DOWN_RELAXED_ARCS, "query_route_top_down_relaxed_arcs") \
+    METRIC(QUERY_ROUTE_TOP_DOWN_QUEUE_PUSHES, "query_route_top_down_queue_pushes") \
+    METRIC(HIERARCHY_TOP_DOWN_ARCS, "hierarchy_top_down_arcs") \
+    METRIC(HIERARCHY_TOP_DOWN_SHORTCUTS, "hierarchy_top_down_shortcuts") \
+    METRIC(HIERARCHY_TOP_DOWN_FORWARD_SEARCH_SPACE, "hierarchy_top_down_forward_search_space") \
+    METRIC(HIERARCHY_TOP_DOWN_BACKWARD_SEARCH_SPACE, "hierarchy_top_down_backward_search_space") \
+    METRIC(HIERARCHY_TOP_DOWN_FORWARD_SEARCH_ARCS, "hierarchy_top_down_forward_search_arcs") \
+    METRIC(HIERARCHY_TOP_DOWN_BACKWARD_SEARCH_ARCS, "hierarchy_top_down_backward_search_arcs") \
+    METRIC(HIERARCHY_TOP_DOWN_FORWARD_DEGREE, "hierarchy_top_down_forward_degree") \
+    METRIC(HIERARCHY_TOP_DOWN_BACKWARD_DEGREE, "hierarchy_top_down_backward_degree") \
+    METRIC(HIERARCHY_TOP_DOWN_DEPTH, "hierarchy_top_down_depth") \
+    METRIC(PRUNE_SHORTCUTS_TOP_DOWN, "prune_shortcuts_top_down") \
+    METRIC(PRUNED_SHORTCUTS_TOP_DOWN, "pruned_shortcuts_top_down") \
+    METRIC(QUERY_ROUTE_PRUNED_TOP_DOWN, "query_route_pruned_top_down") \
+    METRIC(QUERY_ROUTE_PRUNED_TOP_DOWN_SETTLED_NODES, "query_route_pruned_top_down_settled_nodes") \
+    METRIC(QUERY_ROUTE_PRUNED_TOP_DOWN_STALLED_NODES, "query_route_pruned_top_down_stalled_nodes") \
+    METRIC(QUERY_ROUTE_PRUNED_TOP_DOWN_RELAXED_ARCS, "query_route_pruned_top_down_relaxed_arcs") \
+    METRIC(QUERY_ROUTE_PRUNED_TOP_DOWN_QUEUE_PUSHES, "query_route_pruned_top_down_queue_pushes") \
+    METRIC(COMPRESS_CHAINS, "compress_chains") \
+    METRIC(CHAIN_NODES, "chain_nodes") \
+    METRIC(PREPROC_GRAPH_CHAINS_TOP_DOWN, "preproc_graph_chains_top_down") \
+    METRIC(QUERY_ROUTE_CHAINS_TOP_DOWN, "query_route_chains_top_down") \
+    METRIC(COMPRESS_GRAPH, "compress_graph") \
+    METRIC(COMPRESS_PREPROC_GRAPH_TOP_DOWN, "compress_preproc_graph_top_down") \
+    METRIC(GRAPH_MEMORY_BYTES, "graph_memory_bytes") \
+    METRIC(COMPRESSED_GRAPH_MEMORY_BYTES, "compressed_graph_memory_bytes") \
+    METRIC(PREPROC_GRAPH_TOP_DOWN_MEMORY_BYTES, "preproc_graph_top_down_memory_bytes") \
+    METRIC(COMPRESSED_PREPROC_GRAPH_TOP_DOWN_MEMORY_BYTES, "compressed_preproc_graph_top_down_memory_bytes") \
+    METRIC(QUERY_ROUTE_COMPRESSED_TOP_DOWN, "query_route_compressed_top_down") \
+    METRIC(QUERY_ROUTE_DIJKSTRA, "query_route_dijkstra") \
+    METRIC(QUERY_ROUTE_DIJKSTRA_COMPRESSED, "query_route_dijkstra_compressed") \
+    METRIC(QUERY_PIPELINE_TOP_DOWN, "query_pipeline_top_down") \
+    METRIC(QUERY_PIPELINE_TOP_DOWN_QUERIES, "query_pipeline_top_down_queries") \
+    METRIC(QUERY_ALTERNATIVE_ROUTES_TOP_DOWN, "query_alternative_routes_top_down") \
+    METRIC(PREPROC_ARC_FLAGS, "preproc_arc_flags") \
+    METRIC(ARC_FLAGS_MEMORY_BYTES, "arc_flags_memory_bytes") \
+    METRIC(QUERY_ROUTE_ARC_FLAGS, "query_route_arc_flags") \
+    METRIC(SEARCH_SPACE_TOP_DOWN, "search_space_top_down") \
+    METRIC(SEARCH_SPACE_ARC_FLAGS, "search_space_arc_flags") \
+    METRIC(UPDATE_PREPROC_GRAPH_TOP_DOWN, "update_preproc_graph_top_down") \
+    METRIC(UPDATE_FULL_PREPROC_GRAPH_TOP_DOWN, "update_full_preproc_graph_top_down") \
+    METRIC(PREPROC_GRAPH_CCH, "preproc_graph_cch") \
+    METRIC(CUSTOMIZE_CCH, "customize_cch") \
+    METRIC(QUERY_ROUTE_CCH, "query_route_cch") \
+    METRIC(QUERY_ROUTE_CCH_SETTLED_NODES, "query_route_cch_settled_nodes") \
+    METRIC(QUERY_ROUTE_CCH_STALLED_NODES, "query_route_cch_stalled_nodes") \
+    METRIC(QUERY_ROUTE_CCH_RELAXED_ARCS, "query_route_cch_relaxed_arcs") \
+    METRIC(QUERY_ROUTE_CCH_QUEUE_PUSHES, "query_route_cch_queue_pushes") \
+    METRIC(PREPROC_GRAPH_CORE_ALT, "preproc_graph_core_alt") \
+    METRIC(QUERY_ROUTE_CORE_ALT, "query_route_core_alt") \
+    METRIC(PREPROC_OVERLAY_PARTITION, "preproc_overlay_partition") \
+    METRIC(CUSTOMIZE_OVERLAY, "customize_overlay") \
+    METRIC(QUERY_ROUTE_OVERLAY, "query_route_overlay")
 
-constexpr int DEFAULT_FORMAT_STRING_SIZE = 2;
+#define METRIC_ID(id, name) id,
+enum ExperimentMetric : MetricId
+{
+    EXPERIMENT_METRICS(METRIC_ID)
+    METRIC_NUMBER
+};
+#undef METRIC_ID
+
+
+// Number of arcs changed by the update benchmark, every other one is closed
+constexpr int UPDATE_ARC_NUMBER = 10;
+constexpr int ALTERNATIVE_ROUTE_NUMBER = 2;
+// Core-ALT keeps this share of nodes uncontracted
+constexpr double CORE_ALT_CORE_SHARE = 0.05;
+constexpr int CORE_ALT_LANDMARK_NUMBER = 16;
+constexpr int ARC_FLAGS_CELL_NUMBER = 32;
+// Minimum time between two progress lines of a preprocessing run
+constexpr ChronoTime PREPROC_PROGRESS_INTERVAL = std::chrono::seconds(5);
+// Nodes whose upward search spaces are explored by the hierarchy quality report
+constexpr int HIERARCHY_SAMPLE_SIZE = 10000;
+// Suffix of the Chrome trace written next to output_file in builds with TRACE=1
+const std::string TRACE_EXTENSION = ".trace.json";
+// Suffix of the contraction checkpoints written next to output_file, and the time between two of them
+const std::string CHECKPOINT_EXTENSION = ".checkpoint";
+constexpr ChronoTime PREPROC_CHECKPOINT_INTERVAL = std::chrono::minutes(5);
+// Suffix of the contraction orders written next to output_file
+const std::string RANKS_EXTENSION = ".ranks";
+// Destinations per batch of the pipelined query runner
+constexpr std::size_t QUERY_PIPELINE_BATCH_SIZE = 256;
+// Cells per overlay level, finest level first
+static const std::vector<int> OVERLAY_CELL_NUMBERS = {64, 16, 4};
 
 
-static std::string format_numb(const int numb, const int string_size);
+static void register_metrics(Measurement &measurement, const bool count_events);
+static MetricId counter_metric(const MetricId metric, const PerfEvent event);
+static void record_time(Measurement &measurement, const MetricId metric, const Timer &timer);
 static void log(const std::string &message);
+static void record_query_stats(Measurement &measurement, const MetricId first_metric, const CHGraph::QueryStats &stats);
+static void record_preproc_stats(Measurement &measurement, const MetricId first_metric, const CHGraph::PreprocStats &stats);
+static CHGraph::PreprocMonitor make_preproc_monitor(const std::string &name);
+static void record_preproc_profile(Measurement &measurement, const MetricId first_metric, const CHGraph::PreprocProfile &profile);
+static void record_hierarchy_quality(const std::string &name, const MetricId first_metric, const CHGraph::PreprocGraph &preproc_graph,
+                                     Measurement &measurement);
+template <typename Result = CHGraph::Route, typename Query, typename Inspect>
+static void measure_queries(const std::string &name, const MetricId metric, const std::vector<CHGraph::Destination> &destinations,
+                            const int run_number, Measurement &measurement, Timer &timer, Query query, Inspect inspect);
+template <typename Result = CHGraph::Route, typename Query>
+static void measure_queries(const std::string &name, const MetricId metric, const std::vector<CHGraph::Destination> &destinations,
+                            const int run_number, Measurement &measurement, Timer &timer, Query query);
+static void measure_ch_queries(const std::string &name, const MetricId metric, const MetricId stats_metric, const CHGraph::Graph &graph,
+                               const CHGraph::PreprocGraph &preproc_graph, const std::vector<CHGraph::Destination> &destinations,
+                               const int run_number, Measurement &measurement, Timer &timer);
+using Preproc = void (*)(const CHGraph::Graph &, CHGraph::PreprocGraph &, const CHGraph::PreprocOptions &);
+static void profile_preproc(const std::string &name, Preproc preproc, const CHGraph::Graph &graph,
+                            const std::string &checkpoint_file, const MetricId first_profile_metric, Measurement &measurement,
+                            CHGraph::PreprocGraph &preproc_graph);
+static void measure_given_order(const std::string &name, const MetricId metric, const MetricId given_order_metric, Preproc preproc,
+                                const CHGraph::Graph &graph, const std::vector<int> &ranks, const std::string &ranks_file,
+                                const int run_number, Measurement &measurement, Timer &timer);
+
+
+// Counter metrics follow the time metrics, PERF_EVENT_NUMBER per time metric
+static void register_metrics(Measurement &measurement, const bool count_events)
+{
+#define REGISTER_METRIC(id, name) measurement.register_metric(name);
+    EXPERIMENT_METRICS(REGISTER_METRIC)
+#undef REGISTER_METRIC
+
+    if (!count_events)
+        return;
+
+    for (MetricId metric = 0; metric < METRIC_NUMBER; ++metric)
+    {
+        for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+        {
+            const std::string event_name = PerfCounters::event_name(static_cast<PerfEvent>(event));
+            measurement.register_metric(measurement.metric_names[metric] + "_" + event_name);
+        }
+    }
+}
 
+static MetricId counter_metric(const MetricId metric, const PerfEvent event)
+{
+    return METRIC_NUMBER + metric * PERF_EVENT_NUMBER + static_cast<int>(event);
+}
 
-static std::string format_numb(const int numb, const int string_size)
+// Records the time of the last measured region and every counter that is available
+static void record_time(Measurement &measurement, const MetricId metric, const Timer &timer)
 {
-    const std::string str_numb = std::to_string(numb);
-    const int zero_fill_size = (string_size > str_numb.size()) ? (string_size - str_numb.size()) : 0;
-    return std::string(zero_fill_size, '0')  + str_numb;
+    measurement.record(metric, timer.get_result());
+
+    const PerfCounters *counters = timer.counters();
+    if (counters == nullptr)
+        return;
+
+    for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+    {
+        if (counters->available(static_cast<PerfEvent>(event)))
+            measurement.record(counter_metric(metric, static_cast<PerfEvent>(event)), counters->get_result(static_cast<PerfEvent>(event)));
+    }
 }
 
 static void log(const std::string &message)
@@ -35,86 +239,512 @@ static void log(const std::string &message)
     std::cout << "LOG: " << message << std::endl;
 }
 
+// QueryStats fields are recorded to first_metric and the following metrics, in declaration order
+static void record_query_stats(Measurement &measurement, const MetricId first_metric, const CHGraph::QueryStats &stats)
+{
+    measurement.record(first_metric, stats.settled_nodes);
+    measurement.record(first_metric + 1, stats.stalled_nodes);
+    measurement.record(first_metric + 2, stats.relaxed_arcs);
+    measurement.record(first_metric + 3, stats.queue_pushes);
+}
+
+static void record_preproc_stats(Measurement &measurement, const MetricId first_metric, const CHGraph::PreprocStats &stats)
+{
+    measurement.record(first_metric, stats.witness_searches);
+    measurement.record(first_metric + 1, stats.witness_settled_nodes);
+    measurement.record(first_metric + 2, stats.shortcuts_added);
+}
+
+// Logs the progress of the contraction as name
+static CHGraph::PreprocMonitor make_preproc_monitor(const std::string &name)
+{
+    CHGraph::PreprocMonitor monitor;
+    monitor.progress_interval = PREPROC_PROGRESS_INTERVAL;
+    monitor.progress = [name](const CHGraph::PreprocProgress &progress) {
+        std::ostringstream message;
+        message << std::fixed << std::setprecision(1) << name << ": " << progress.contracted_nodes << "/"
+                << progress.node_number << " nodes contracted, " << progress.remaining_arcs << " arcs left, average degree "
+                << progress.average_degree << ", " << progress.shortcuts << " shortcuts, elapsed " << progress.elapsed / 1e9
+                << " s, ETA " << progress.eta / 1e9 << " s.";
+        log(message.str());
+    };
+    return monitor;
+}
+
+// Phase times are recorded to first_metric and the following metrics in PreprocPhase order, then the contraction costs
+static void record_preproc_profile(Measurement &measurement, const MetricId first_metric, const CHGraph::PreprocProfile &profile)
+{
+    for (int phase = 0; phase < CHGraph::PREPROC_PHASE_NUMBER; ++phase)
+    {
+        measurement.record(first_metric + phase, profile.phase_times[phase]);
+    }
+    measurement.record(first_metric + CHGraph::PREPROC_PHASE_NUMBER, profile.contraction_costs);
+}
+
+// Hierarchy quality is recorded to first_metric and the following metrics in the order of the HIERARCHY_*_ entries
+static void record_hierarchy_quality(const std::string &name, const MetricId first_metric, const CHGraph::PreprocGraph &preproc_graph,
+                                     Measurement &measurement)
+{
+    log("Analyzing " + name + " hierarchy started.");
+    CHGraph::HierarchyQuality quality;
+    CHGraph::analyze_hierarchy(preproc_graph, quality, HIERARCHY_SAMPLE_SIZE);
+
+    measurement.record(first_metric, quality.forward_arcs + quality.backward_arcs);
+    measurement.record(first_metric + 1, quality.shortcuts);
+    measurement.record(first_metric + 2, quality.forward_search_space);
+    measurement.record(first_metric + 3, quality.backward_search_space);
+    measurement.record(first_metric + 4, quality.forward_search_arcs);
+    measurement.record(first_metric + 5, quality.backward_search_arcs);
+    measurement.record(first_metric + 6, quality.forward_degree);
+    measurement.record(first_metric + 7, quality.backward_degree);
+    measurement.record(first_metric + 8, quality.depth);
+    log("Analyzing " + name + " hierarchy finished.");
+}
+
+// Times query(destination, result) run_number times per destination into metric, every run with a new Result.
+// inspect(destination) runs once per destination outside the measured runs, for example for search statistics.
+template <typename Result, typename Query, typename Inspect>
+static void measure_queries(const std::string &name, const MetricId metric, const std::vector<CHGraph::Destination> &destinations,
+                            const int run_number, Measurement &measurement, Timer &timer, Query query, Inspect inspect)
+{
+    TRACE_SCOPE(Trace::intern("queries_" + name));
+    [[maybe_unused]] const char *query_trace_name = Trace::intern("query_route_" + name);
+
+    for (std::size_t dest_ind = 0; dest_ind < destinations.size(); ++dest_ind)
+    {
+        log("Quering route " + std::to_string(dest_ind) + " with " + name + " started.");
+
+        for (int ind = 0; ind < run_number; ++ind)
+        {
+            Result result;
+            {
+                TRACE_SCOPE(query_trace_name);
+                MEASURE_TIME(query(destinations[dest_ind], result), timer);
+            }
+            record_time(measurement, metric, timer);
+        }
+
+        inspect(destinations[dest_ind]);
+        log("Quering route " + std::to_string(dest_ind) + " with " + name + " finished.");
+    }
+}
+
+template <typename Result, typename Query>
+static void measure_queries(const std::string &name, const MetricId metric, const std::vector<CHGraph::Destination> &destinations,
+                            const int run_number, Measurement &measurement, Timer &timer, Query query)
+{
+    measure_queries<Result>(name, metric, destinations, run_number, measurement, timer, query, [](const CHGraph::Destination &) {});
+}
+
+static void measure_ch_queries(const std::string &name, const MetricId metric, const MetricId stats_metric, const CHGraph::Graph &graph,
+                               const CHGraph::PreprocGraph &preproc_graph, const std::vector<CHGraph::Destination> &destinations,
+                               const int run_number, Measurement &measurement, Timer &timer)
+{
+    measure_queries(name, metric, destinations, run_number, measurement, timer,
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route) { CHGraph::query_route(graph, preproc_graph, destination, route); },
+        [&](const CHGraph::Destination &destination)
+        {
+            if constexpr (SEARCH_STATS_ENABLED)
+            {
+                CHGraph::Route route;
+                CHGraph::QueryStats stats;
+                CHGraph::query_route(graph, preproc_graph, destination, route, stats);
+                record_query_stats(measurement, stats_metric, stats);
+            }
+        });
+}
+
+// The hierarchy the experiment keeps comes from one unmeasured contraction with progress monitor and checkpoints,
+// which resumes the checkpoint of an interrupted experiment. Its phase and node contraction profile is recorded to
+// first_profile_metric and the following metrics unless it was resumed. The measured runs go without both.
+static void profile_preproc(const std::string &name, Preproc preproc, const CHGraph::Graph &graph,
+                            const std::string &checkpoint_file, const MetricId first_profile_metric, Measurement &measurement,
+                            CHGraph::PreprocGraph &preproc_graph)
+{
+    log("Profiled " + name + " contraction started.");
+    CHGraph::PreprocMonitor monitor = make_preproc_monitor("Profiled " + name + " contraction");
+    CHGraph::PreprocCheckpoint checkpoint{.file = checkpoint_file, .interval = PREPROC_CHECKPOINT_INTERVAL};
+    preproc(graph, preproc_graph, CHGraph::PreprocOptions{.monitor = &monitor, .checkpoint = &checkpoint});
+    if (checkpoint.resumed_nodes > 0)
+        log("Interrupted " + name + " contraction resumed after " + std::to_string(checkpoint.resumed_nodes) + " nodes, profile not recorded.");
+    else
+        record_preproc_profile(measurement, first_profile_metric, monitor.profile);
+    log("Profiled " + name + " contraction finished.");
+}
+
+// Saves ranks to ranks_file and contracts graph again in the order read back from it, as a later run with
+// new weights would. Like the runs of metric, these have no monitor and no checkpoints.
+static void measure_given_order(const std::string &name, const MetricId metric, const MetricId given_order_metric, Preproc preproc,
+                                const CHGraph::Graph &graph, const std::vector<int> &ranks, const std::string &ranks_file,
+                                const int run_number, Measurement &measurement, Timer &timer)
+{
+    log("Preproccessing graph by " + name + " approach in the saved order started.");
+    FileFacilities::save_ranks(ranks, ranks_file);
+    std::vector<int> saved_ranks;
+    FileFacilities::load_ranks(ranks_file, saved_ranks);
+
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        CHGraph::PreprocGraph preproc_graph;
+        MEASURE_TIME(preproc(graph, preproc_graph, CHGraph::PreprocOptions{.ranks = &saved_ranks}), timer);
+        record_time(measurement, given_order_metric, timer);
+    }
+
+    const double mean = measurement.histograms[metric].mean();
+    if (mean > 0.0)
+    {
+        std::ostringstream message;
+        message << std::fixed << std::setprecision(1) << "The saved order changed the " << name << " preprocessing time by "
+                << 100.0 * (measurement.histograms[given_order_metric].mean() - mean) / mean << "%.";
+        log(message.str());
+    }
+    log("Preproccessing graph by " + name + " approach in the saved order finished.");
+}
+
 void Experiment::run(const std::string &graph_file, const std::string &destinations_file,
-                     const std::string &output_file, const int run_number)
+                     const std::string &output_file, const int run_number, const std::string &preproc_file,
+                     const bool rebuild_graph_cache, const TimerBackend timer_backend, const bool count_events)
 {
     CHGraph::Graph graph;
     std::vector<CHGraph::Destination> destinations;
 
     log("Experiment started.");
 
+    Measurement measurement;
+    Timer timer(timer_backend, count_events);
+    register_metrics(measurement, timer.counters() != nullptr);
+    if (count_events && timer.counters() == nullptr)
+        log("Hardware counters are not available, measuring time only.");
+    if constexpr (TRACE_ENABLED)
+        Trace::start(output_file + TRACE_EXTENSION);
+
     log("Graph file reading started.");
-    FileFacilities::read_graph(graph_file, graph);
+    const FileFacilities::GraphCacheMode cache_mode =
+        rebuild_graph_cache ? FileFacilities::GraphCacheMode::REBUILD : FileFacilities::GraphCacheMode::ENABLED;
+    MEASURE_TIME(FileFacilities::read_graph(graph_file, graph, cache_mode), timer);
+    record_time(measurement, READ_GRAPH, timer);
     log("Graph file reading finished.");
 
+    // Node ids are kept, so destinations and results need no mapping
+    log("Graph normalization started.");
+    CHGraph::Graph normalized_graph;
+    CHGraph::NodeMapping node_mapping;
+    MEASURE_TIME(CHGraph::normalize_graph(graph, normalized_graph, node_mapping), timer);
+    record_time(measurement, NORMALIZE_GRAPH, timer);
+    log("Removed " + std::to_string(graph.to.size() - normalized_graph.to.size()) + " parallel arcs and self loops.");
+    graph = std::move(normalized_graph);
+    log("Graph normalization finished.");
+
+    // Both preprocessors compute the components as well, this measures them on their own
+    log("Strongly connected components started.");
+    CHGraph::PreprocGraph reachability;
+    MEASURE_TIME(CHGraph::compute_components(graph, reachability), timer);
+    record_time(measurement, COMPUTE_COMPONENTS, timer);
+    measurement.record(COMPONENTS, static_cast<TimerTime>(reachability.component_number));
+    log("Found " + std::to_string(reachability.component_number) + " strongly connected components" +
+        (reachability.component_reachability.empty() ? "." : ", condensation reachability built."));
+    log("Strongly connected components finished.");
+
     log("Destinations file reading started.");
     FileFacilities::read_destinations(destinations_file, destinations);
     log("Destinations file reading finished.");
 
     CHGraph::PreprocGraph bottom_up_graph, top_down_graph;
-    Measurement measurement;
-    Timer timer;
+
+    profile_preproc("bottom up", &CHGraph::preproc_graph_bottom_up, graph, output_file + ".bottom_up" + CHECKPOINT_EXTENSION,
+                    PREPROC_GRAPH_BOTTOM_UP_ADJACENCY, measurement, bottom_up_graph);
+    log("Bottom up preprocced graph saved.");
 
     log("Preproccessing graph by bottom up approach started.");
     for (int ind = 0; ind < run_number; ++ind)
     {
         CHGraph::PreprocGraph preproc_graph;
-        MEASURE_TIME(CHGraph::preproc_graph_bottom_up(graph, preproc_graph), timer);
-        measurement.data["preproc_graph_bottom_up"].push_back(timer.get_result());
+        CHGraph::PreprocStats stats;
+        MEASURE_TIME(CHGraph::preproc_graph_bottom_up(graph, preproc_graph, CHGraph::PreprocOptions{.stats = &stats}), timer);
+        record_time(measurement, PREPROC_GRAPH_BOTTOM_UP, timer);
+        if constexpr (SEARCH_STATS_ENABLED)
+            record_preproc_stats(measurement, PREPROC_GRAPH_BOTTOM_UP_WITNESS_SEARCHES, stats);
+    }
+    log("Preproccessing graph by bottom up approach finished.");
 
-        if (ind == run_number - 1)
+    measure_given_order("bottom up", PREPROC_GRAPH_BOTTOM_UP, PREPROC_GRAPH_BOTTOM_UP_GIVEN_ORDER, &CHGraph::preproc_graph_bottom_up,
+                        graph, bottom_up_graph.ranks, output_file + ".bottom_up" + RANKS_EXTENSION, run_number, measurement, timer);
+
+    record_hierarchy_quality("bottom up", HIERARCHY_BOTTOM_UP_ARCS, bottom_up_graph, measurement);
+    measure_ch_queries("bottom_up", QUERY_ROUTE_BOTTOM_UP, QUERY_ROUTE_BOTTOM_UP_SETTLED_NODES, graph, bottom_up_graph, destinations, run_number, measurement, timer);
+
+    if (!preproc_file.empty() && std::filesystem::exists(preproc_file))
+    {
+        log("Loading top down preprocced graph started.");
+        for (int ind = 0; ind < run_number; ++ind)
         {
-            bottom_up_graph = preproc_graph;
-            log("Bottom up preprocced graph saved.");
+            MEASURE_TIME(FileFacilities::load_preproc_graph(preproc_file, graph, top_down_graph), timer);
+            record_time(measurement, LOAD_PREPROC_GRAPH_TOP_DOWN, timer);
         }
+        // The file has no reachability filter
+        top_down_graph.components = reachability.components;
+        top_down_graph.component_number = reachability.component_number;
+        top_down_graph.component_reachability = reachability.component_reachability;
+        log("Loading top down preprocced graph finished.");
     }
-    log("Preproccessing graph by bottom up approach finished.");
-
-    for (int dest_ind = 0; dest_ind < destinations.size(); ++dest_ind)
+    else
     {
-        log("Quering route " + std::to_string(dest_ind) + " in bottom up preprocced graph started.");
-        const std::string dest_str_numb = format_numb(dest_ind, DEFAULT_FORMAT_STRING_SIZE);
+        profile_preproc("top down", &CHGraph::preproc_graph_top_down, graph, output_file + ".top_down" + CHECKPOINT_EXTENSION,
+                        PREPROC_GRAPH_TOP_DOWN_ADJACENCY, measurement, top_down_graph);
+        log("Top down preprocced graph saved.");
 
+        log("Preproccessing graph by top down approach started.");
         for (int ind = 0; ind < run_number; ++ind)
+        {
+            CHGraph::PreprocGraph preproc_graph;
+            CHGraph::PreprocStats stats;
+            MEASURE_TIME(CHGraph::preproc_graph_top_down(graph, preproc_graph, CHGraph::PreprocOptions{.stats = &stats}), timer);
+            record_time(measurement, PREPROC_GRAPH_TOP_DOWN, timer);
+            if constexpr (SEARCH_STATS_ENABLED)
+                record_preproc_stats(measurement, PREPROC_GRAPH_TOP_DOWN_WITNESS_SEARCHES, stats);
+        }
+        log("Preproccessing graph by top down approach finished.");
+
+        if (!preproc_file.empty())
+        {
+            log("Saving top down preprocced graph started.");
+            MEASURE_TIME(FileFacilities::save_preproc_graph(graph, top_down_graph, preproc_file), timer);
+            record_time(measurement, SAVE_PREPROC_GRAPH_TOP_DOWN, timer);
+            log("Saving top down preprocced graph finished.");
+        }
+    }
+
+    measure_given_order("top down", PREPROC_GRAPH_TOP_DOWN, PREPROC_GRAPH_TOP_DOWN_GIVEN_ORDER, &CHGraph::preproc_graph_top_down,
+                        graph, top_down_graph.ranks, output_file + ".top_down" + RANKS_EXTENSION, run_number, measurement, timer);
+
+    record_hierarchy_quality("top down", HIERARCHY_TOP_DOWN_ARCS, top_down_graph, measurement);
+    measure_ch_queries("top_down", QUERY_ROUTE_TOP_DOWN, QUERY_ROUTE_TOP_DOWN_SETTLED_NODES, graph, top_down_graph, destinations, run_number, measurement, timer);
+
+    // Pruning works on a copy, the update benchmark needs every shortcut of top_down_graph
+    log("Pruning top down shortcuts started.");
+    CHGraph::PreprocGraph pruned_top_down_graph;
+    long long pruned_arcs = 0;
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        pruned_top_down_graph = top_down_graph;
+        MEASURE_TIME(pruned_arcs = CHGraph::prune_redundant_shortcuts(pruned_top_down_graph), timer);
+        record_time(measurement, PRUNE_SHORTCUTS_TOP_DOWN, timer);
+    }
+    measurement.record(PRUNED_SHORTCUTS_TOP_DOWN, pruned_arcs);
+    log("Pruned " + std::to_string(pruned_arcs) + " of " +
+        std::to_string(top_down_graph.forward_arcs.size() + top_down_graph.backward_arcs.size()) + " top down arcs.");
+    log("Pruning top down shortcuts finished.");
+
+    measure_ch_queries("pruned_top_down", QUERY_ROUTE_PRUNED_TOP_DOWN, QUERY_ROUTE_PRUNED_TOP_DOWN_SETTLED_NODES, graph, pruned_top_down_graph,
+                       destinations, run_number, measurement, timer);
+
+    const double top_down_mean = measurement.histograms[QUERY_ROUTE_TOP_DOWN].mean();
+    const double pruned_mean = measurement.histograms[QUERY_ROUTE_PRUNED_TOP_DOWN].mean();
+    if (top_down_mean > 0.0)
+    {
+        std::ostringstream message;
+        message << std::fixed << std::setprecision(1) << "Pruning changed the mean top down query time by "
+                << 100.0 * (pruned_mean - top_down_mean) / top_down_mean << "%.";
+        log(message.str());
+    }
+
+    log("Chain compression started.");
+    CHGraph::ChainCompression chain_compression;
+    CHGraph::PreprocGraph chains_top_down_graph;
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        MEASURE_TIME(CHGraph::compress_chains(graph, chain_compression), timer);
+        record_time(measurement, COMPRESS_CHAINS, timer);
+        MEASURE_TIME(CHGraph::preproc_graph_top_down(chain_compression.graph, chains_top_down_graph), timer);
+        record_time(measurement, PREPROC_GRAPH_CHAINS_TOP_DOWN, timer);
+    }
+    measurement.record(CHAIN_NODES, static_cast<TimerTime>(chain_compression.chain_nodes.size()));
+    log("Removed " + std::to_string(chain_compression.chain_nodes.size()) + " chain nodes in " +
+        std::to_string(chain_compression.chain_tail.size()) + " chains.");
+    log("Chain compression finished.");
+
+    measure_queries("chains_top_down", QUERY_ROUTE_CHAINS_TOP_DOWN, destinations, run_number, measurement, timer,
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route)
+        { CHGraph::query_route(chain_compression, chains_top_down_graph, destination, route); });
+
+    log("Compressing graphs started.");
+    CHGraph::CompressedGraph compressed_graph;
+    CHGraph::CompressedPreprocGraph compressed_top_down_graph;
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        MEASURE_TIME(CHGraph::compress_graph(graph, compressed_graph), timer);
+        record_time(measurement, COMPRESS_GRAPH, timer);
+        MEASURE_TIME(CHGraph::compress_preproc_graph(top_down_graph, compressed_top_down_graph), timer);
+        record_time(measurement, COMPRESS_PREPROC_GRAPH_TOP_DOWN, timer);
+    }
+    measurement.record(GRAPH_MEMORY_BYTES, CHGraph::graph_memory(graph));
+    measurement.record(COMPRESSED_GRAPH_MEMORY_BYTES, CHGraph::compressed_arcs_memory(compressed_graph.arcs));
+    measurement.record(PREPROC_GRAPH_TOP_DOWN_MEMORY_BYTES, CHGraph::preproc_graph_memory(top_down_graph));
+    measurement.record(COMPRESSED_PREPROC_GRAPH_TOP_DOWN_MEMORY_BYTES,
+        CHGraph::compressed_arcs_memory(compressed_top_down_graph.forward_arcs) +
+        CHGraph::compressed_arcs_memory(compressed_top_down_graph.backward_arcs));
+    log("Compressing graphs finished.");
+
+    measure_queries("compressed_top_down", QUERY_ROUTE_COMPRESSED_TOP_DOWN, destinations, run_number, measurement, timer,
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route)
+        { CHGraph::query_route(compressed_top_down_graph, destination, route); });
+    measure_queries("dijkstra", QUERY_ROUTE_DIJKSTRA, destinations, run_number, measurement, timer,
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route) { CHGraph::query_route_dijkstra(graph, destination, route); });
+    measure_queries("dijkstra_compressed", QUERY_ROUTE_DIJKSTRA_COMPRESSED, destinations, run_number, measurement, timer,
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route)
+        { CHGraph::query_route_dijkstra(compressed_graph, destination, route); });
+
+    log("Pipelined top down queries started.");
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        FileFacilities::DestinationReader reader(destinations_file);
+        std::size_t answered = 0;
+
+        MEASURE_TIME(CHGraph::run_query_pipeline(
+            [&](std::vector<CHGraph::Destination> &batch) { return reader.next_batch(batch, QUERY_PIPELINE_BATCH_SIZE); },
+            [&](const CHGraph::Destination &destination, CHGraph::Route &route) { CHGraph::query_route(graph, top_down_graph, destination, route); },
+            [&](const std::vector<CHGraph::QueryResult> &results) { answered += results.size(); }), timer);
+        record_time(measurement, QUERY_PIPELINE_TOP_DOWN, timer);
+        measurement.record(QUERY_PIPELINE_TOP_DOWN_QUERIES, answered);
+    }
+    log("Pipelined top down queries finished.");
+
+    measure_queries<std::vector<CHGraph::Route>>("alternative_routes_top_down", QUERY_ALTERNATIVE_ROUTES_TOP_DOWN, destinations, run_number,
+        measurement, timer, [&](const CHGraph::Destination &destination, std::vector<CHGraph::Route> &routes)
+        { CHGraph::query_alternative_routes(graph, top_down_graph, destination, ALTERNATIVE_ROUTE_NUMBER, routes); });
+
+    log("Computing arc flags for top down preprocced graph started.");
+    CHGraph::ArcFlags arc_flags;
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        MEASURE_TIME(CHGraph::preproc_arc_flags(graph, top_down_graph, ARC_FLAGS_CELL_NUMBER, arc_flags), timer);
+        record_time(measurement, PREPROC_ARC_FLAGS, timer);
+    }
+    measurement.record(ARC_FLAGS_MEMORY_BYTES, CHGraph::arc_flags_memory(arc_flags));
+    log("Computing arc flags for top down preprocced graph finished.");
+
+    measure_queries("arc_flags", QUERY_ROUTE_ARC_FLAGS, destinations, run_number, measurement, timer,
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route)
+        { CHGraph::query_route(graph, top_down_graph, arc_flags, destination, route); },
+        [&](const CHGraph::Destination &destination)
         {
             CHGraph::Route route;
-            MEASURE_TIME(CHGraph::query_route(graph, bottom_up_graph, destinations[dest_ind], route), timer);
-            measurement.data["query_route_bottom_up_" + dest_str_numb].push_back(timer.get_result());
+            int settled_nodes;
+            CHGraph::query_route_search_space(top_down_graph, nullptr, destination, route, settled_nodes);
+            measurement.record(SEARCH_SPACE_TOP_DOWN, settled_nodes);
+            CHGraph::query_route_search_space(top_down_graph, &arc_flags, destination, route, settled_nodes);
+            measurement.record(SEARCH_SPACE_ARC_FLAGS, settled_nodes);
+        });
+
+    log("Updating top down preprocced graph started.");
+    {
+        CHGraph::Graph updated_graph = graph;
+        std::vector<int> changed_arcs;
+        const int arc_number = static_cast<int>(graph.to.size());
+        for (int ind = 0; ind < UPDATE_ARC_NUMBER && ind < arc_number; ++ind)
+        {
+            const int arc = static_cast<int>((static_cast<long long>(ind) * arc_number) / UPDATE_ARC_NUMBER);
+            updated_graph.weights[arc] = (ind % 2 == 0) ? std::numeric_limits<double>::infinity() : 2 * graph.weights[arc];
+            changed_arcs.push_back(arc);
+        }
+
+        for (int ind = 0; ind < run_number; ++ind)
+        {
+            CHGraph::PreprocGraph preproc_graph = top_down_graph;
+            MEASURE_TIME(CHGraph::update_preproc_graph(updated_graph, preproc_graph, changed_arcs), timer);
+            record_time(measurement, UPDATE_PREPROC_GRAPH_TOP_DOWN, timer);
+        }
+
+        for (int ind = 0; ind < run_number; ++ind)
+        {
+            CHGraph::PreprocGraph preproc_graph;
+            MEASURE_TIME(CHGraph::preproc_graph_top_down(updated_graph, preproc_graph), timer);
+            record_time(measurement, UPDATE_FULL_PREPROC_GRAPH_TOP_DOWN, timer);
         }
-        log("Quering route " + std::to_string(dest_ind) + " in bottom up preprocced graph finished.");
     }
+    log("Updating top down preprocced graph finished.");
 
-    log("Preproccessing graph by top down approach started.");
+    log("Preproccessing graph by CCH approach started.");
+    CHGraph::CCHTopology cch_topology;
     for (int ind = 0; ind < run_number; ++ind)
     {
-        CHGraph::PreprocGraph preproc_graph;
-        MEASURE_TIME(CHGraph::preproc_graph_top_down(graph, preproc_graph), timer);
-        measurement.data["preproc_graph_top_down"].push_back(timer.get_result());
+        CHGraph::CCHTopology topology;
+        MEASURE_TIME(CHGraph::preproc_graph_cch(graph, topology), timer);
+        record_time(measurement, PREPROC_GRAPH_CCH, timer);
 
         if (ind == run_number - 1)
         {
-            top_down_graph = preproc_graph;
-            log("Top down preprocced graph saved.");
+            cch_topology = topology;
+            log("CCH topology saved.");
         }
     }
-    log("Preproccessing graph by top down approach finished.");
+    log("Preproccessing graph by CCH approach finished.");
 
-    for (int dest_ind = 0; dest_ind < destinations.size(); ++dest_ind)
+    log("Customizing CCH started.");
+    CHGraph::PreprocGraph cch_graph;
+    for (int ind = 0; ind < run_number; ++ind)
     {
-        log("Quering route " + std::to_string(dest_ind) + " in top down preprocced graph started.");
-        const std::string dest_str_numb = format_numb(dest_ind, DEFAULT_FORMAT_STRING_SIZE);
+        MEASURE_TIME(CHGraph::customize_cch(cch_topology, graph.weights, cch_graph), timer);
+        record_time(measurement, CUSTOMIZE_CCH, timer);
+    }
+    log("Customizing CCH finished.");
 
-        for (int ind = 0; ind < run_number; ++ind)
+    measure_ch_queries("cch", QUERY_ROUTE_CCH, QUERY_ROUTE_CCH_SETTLED_NODES, graph, cch_graph, destinations, run_number, measurement, timer);
+
+    log("Preproccessing graph by Core-ALT approach started.");
+    CHGraph::CoreALTGraph core_alt_graph;
+    const int core_size = static_cast<int>(CORE_ALT_CORE_SHARE * (graph.first_out.size() - 1));
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        CHGraph::CoreALTGraph core_graph;
+        MEASURE_TIME(CHGraph::preproc_graph_core_alt(graph, core_size, CORE_ALT_LANDMARK_NUMBER, core_graph), timer);
+        record_time(measurement, PREPROC_GRAPH_CORE_ALT, timer);
+
+        if (ind == run_number - 1)
         {
-            CHGraph::Route route;
-            MEASURE_TIME(CHGraph::query_route(graph, top_down_graph, destinations[dest_ind], route), timer);
-            measurement.data["query_route_top_down_" + dest_str_numb].push_back(timer.get_result());
+            core_alt_graph = core_graph;
+            log("Core-ALT preprocced graph saved.");
         }
-        log("Quering route " + std::to_string(dest_ind) + " in top down preprocced graph finished.");
     }
+    log("Preproccessing graph by Core-ALT approach finished.");
+
+    measure_queries("core_alt", QUERY_ROUTE_CORE_ALT, destinations, run_number, measurement, timer,
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route) { CHGraph::query_route_core_alt(core_alt_graph, destination, route); });
+
+    log("Partitioning graph for multi-level overlay started.");
+    CHGraph::OverlayPartition overlay_partition;
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        CHGraph::OverlayPartition partition;
+        MEASURE_TIME(CHGraph::preproc_overlay_partition(graph, OVERLAY_CELL_NUMBERS, partition), timer);
+        record_time(measurement, PREPROC_OVERLAY_PARTITION, timer);
+
+        if (ind == run_number - 1)
+        {
+            overlay_partition = partition;
+            log("Overlay partition saved.");
+        }
+    }
+    log("Partitioning graph for multi-level overlay finished.");
+
+    log("Customizing multi-level overlay started.");
+    CHGraph::OverlayMetric overlay_metric;
+    for (int ind = 0; ind < run_number; ++ind)
+    {
+        MEASURE_TIME(CHGraph::customize_overlay(graph, overlay_partition, graph.weights, overlay_metric), timer);
+        record_time(measurement, CUSTOMIZE_OVERLAY, timer);
+    }
+    log("Customizing multi-level overlay finished.");
+
+    measure_queries("overlay", QUERY_ROUTE_OVERLAY, destinations, run_number, measurement, timer,
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route)
+        { CHGraph::query_route_overlay(graph, overlay_partition, overlay_metric, destination, route); });
 
     log("Saving measurements started.");
-    FileFacilities::dump_measurement(measurement, output_file);
+    FileFacilities::dump_measurement_summary(measurement, output_file);
+    FileFacilities::dump_measurement_json(measurement, output_file + ".json");
+    if constexpr (TRACE_ENABLED)
+        Trace::stop();
     log("Saving measurements finished.");
     
     log("Experiment finished.");
@@ -1,14 +1,27 @@
 #include <algorithm>
 #include <stdexcept>
 #include "ch_graph.hpp"
+#include "preproc_checkpoint.hpp"
 #include "file_facilities.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <vector>
 #include <string>
-#include <unordered_map>
 #include <utility>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
 
 
 constexpr char DESTINATION_SYMBOL = 'd';
@@ -20,39 +33,289 @@ constexpr char EDGE_SYMBOL = 'a';
 const std::string CSV_NEW_LINE_SYMBOL = "\n";
 const std::string CSV_NEW_COLUMN_SYMBOL = ";";
 
+constexpr std::uint32_t BINARY_FILE_BYTE_ORDER = 0x01020304;
+constexpr std::size_t BINARY_FILE_ALIGNMENT = 64;
+constexpr std::uint64_t BINARY_FILE_CHECKSUM_SEED = 0xcbf29ce484222325ULL;
 
-void FileFacilities::read_graph(const std::string &graph_file, CHGraph::Graph &graph)
+constexpr char PREPROC_FILE_MAGIC[8] = {'C', 'H', 'P', 'R', 'E', 'P', 'R', 'O'};
+constexpr std::uint32_t PREPROC_FILE_VERSION = 2;
+constexpr int PREPROC_FILE_SECTION_NUMBER = 5;
+
+constexpr char GRAPH_CACHE_MAGIC[8] = {'C', 'H', 'G', 'R', 'A', 'P', 'H', 'C'};
+constexpr std::uint32_t GRAPH_CACHE_VERSION = 1;
+constexpr int GRAPH_CACHE_SECTION_NUMBER = 4;
+const std::string GRAPH_CACHE_EXTENSION = ".cache";
+
+constexpr char CHECKPOINT_FILE_MAGIC[8] = {'C', 'H', 'C', 'H', 'E', 'C', 'K', 'P'};
+constexpr std::uint32_t CHECKPOINT_FILE_VERSION = 1;
+constexpr int CHECKPOINT_FILE_SECTION_NUMBER = 9;
+
+constexpr char RANKS_FILE_MAGIC[8] = {'C', 'H', 'O', 'R', 'D', 'E', 'R', 'S'};
+constexpr std::uint32_t RANKS_FILE_VERSION = 1;
+
+
+// Read only memory mapping of a whole file
+class MappedFile
 {
-    std::ifstream file(graph_file);
+private:
+    const char *m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_open = false;
+public:
+    explicit MappedFile(const std::string &path)
+    {
+        const int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0)
+            return;
 
-    if (!file.is_open())
+        struct stat file_stat;
+        if (::fstat(descriptor, &file_stat) == 0)
+        {
+            m_size = static_cast<std::size_t>(file_stat.st_size);
+            if (m_size == 0)
+            {
+                m_open = true;
+            }
+            else
+            {
+                void *mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    ::madvise(mapping, m_size, MADV_SEQUENTIAL);
+                    m_data = static_cast<const char *>(mapping);
+                    m_open = true;
+                }
+            }
+        }
+
+        ::close(descriptor);
+    }
+
+    ~MappedFile()
     {
-        throw std::runtime_error("Can not open destinations file " + graph_file);
+        if (m_data != nullptr)
+            ::munmap(const_cast<char *>(m_data), m_size);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool is_open() const { return m_open; }
+    const char *begin() const { return m_data; }
+    const char *end() const { return m_data + m_size; }
+};
+
+static void skip_blanks(const char *&pos, const char *end)
+{
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+        ++pos;
+}
+
+// Parses the next blank separated number of the line, false if there is none
+template <typename Number>
+static bool parse_number(const char *&pos, const char *end, Number &number)
+{
+    skip_blanks(pos, end);
+    const auto [number_end, error] = std::from_chars(pos, end, number);
+    if (error != std::errc())
+        return false;
+    pos = number_end;
+    return true;
+}
+
+static bool parse_word(const char *&pos, const char *end, std::string_view &word)
+{
+    skip_blanks(pos, end);
+    const char *word_begin = pos;
+    while (pos < end && *pos != ' ' && *pos != '\t' && *pos != '\r')
+        ++pos;
+    word = std::string_view(word_begin, pos - word_begin);
+    return !word.empty();
+}
+
+// Calls func(line_begin, line_end) for every line in [begin, end) until it returns false
+template <typename Func>
+static void for_each_line(const char *begin, const char *end, Func func)
+{
+    const char *line_begin = begin;
+    while (line_begin < end)
+    {
+        const char *line_end = static_cast<const char *>(std::memchr(line_begin, '\n', end - line_begin));
+        if (line_end == nullptr)
+            line_end = end;
+        if (!func(line_begin, line_end))
+            return;
+        line_begin = line_end + 1;
+    }
+}
+
+// Files are split into chunks of at least this many bytes, a few chunks per thread balance the load
+constexpr std::size_t MIN_CHUNK_SIZE = 1 << 20;
+constexpr int CHUNKS_PER_THREAD = 4;
+constexpr std::size_t DESTINATION_READER_BUFFER_SIZE = 1 << 16;
+
+enum class LineStatus
+{
+    CORRECT,
+    INCORRECT_SYMBOL,
+    INCORRECT_FORMAT
+};
+
+struct LineError
+{
+    int line = -1; // 0-based index of the first incorrect line, -1 if all lines are correct
+    LineStatus status = LineStatus::CORRECT;
+};
+
+// Splits [begin, end) into at most max_chunk_number chunks starting right after a new line
+static std::vector<const char *> split_chunks(const char *begin, const char *end,
+                                              const std::size_t max_chunk_number = static_cast<std::size_t>(CHUNKS_PER_THREAD) * Parallel::thread_number())
+{
+    const std::size_t size = end - begin;
+    const int chunk_number = static_cast<int>(std::max<std::size_t>(1, std::min(max_chunk_number, size / MIN_CHUNK_SIZE)));
+
+    std::vector<const char *> bounds{begin};
+    for (int chunk = 1; chunk < chunk_number; ++chunk)
+    {
+        const char *bound = std::max(bounds.back(), begin + size * chunk / chunk_number);
+        const char *new_line = static_cast<const char *>(std::memchr(bound, '\n', end - bound));
+        bound = new_line == nullptr ? end : new_line + 1;
+        if (bound < end && bound > bounds.back())
+            bounds.push_back(bound);
+    }
+    bounds.push_back(end);
+
+    return bounds;
+}
+
+// Parses the lines of the chunks between bounds in parallel, parse_line(line_begin, line_end, buffer)
+// appends the line to the buffer of its chunk. Chunk buffers follow the file order, buffers that are
+// already there are kept for another pass over the same bounds.
+template <typename Buffer, typename ParseLine>
+static LineError parse_chunks(const std::vector<const char *> &bounds, std::vector<Buffer> &buffers, ParseLine parse_line)
+{
+    const int chunk_number = static_cast<int>(bounds.size()) - 1;
+
+    buffers.resize(chunk_number);
+    std::vector<int> line_numbers(chunk_number, 0);
+    std::vector<LineError> errors(chunk_number);
+
+    Parallel::parallel_for(0, chunk_number, [&](int chunk)
+    {
+        int line = 0;
+        for_each_line(bounds[chunk], bounds[chunk + 1], [&](const char *line_begin, const char *line_end)
+        {
+            const LineStatus status = parse_line(line_begin, line_end, buffers[chunk]);
+            if (status != LineStatus::CORRECT)
+            {
+                errors[chunk] = LineError{.line = line, .status = status};
+                return false;
+            }
+            ++line;
+            return true;
+        });
+        line_numbers[chunk] = line;
+    }, 1);
+
+    // Chunks before the first incorrect one were read completely
+    int line_offset = 0;
+    for (int chunk = 0; chunk < chunk_number; ++chunk)
+    {
+        if (errors[chunk].status != LineStatus::CORRECT)
+            return LineError{.line = line_offset + errors[chunk].line, .status = errors[chunk].status};
+        line_offset += line_numbers[chunk];
+    }
+
+    return LineError{};
+}
+
+template <typename Buffer, typename ParseLine>
+static LineError parse_chunks(const char *begin, const char *end, std::vector<Buffer> &buffers, ParseLine parse_line)
+{
+    buffers.clear();
+    return parse_chunks(split_chunks(begin, end), buffers, parse_line);
+}
+
+// Appends the chunk buffers to result, copying them in parallel
+template <typename Item>
+static void merge_chunks(const std::vector<std::vector<Item>> &buffers, std::vector<Item> &result)
+{
+    std::vector<std::size_t> offsets(buffers.size() + 1, result.size());
+    for (std::size_t chunk = 0; chunk < buffers.size(); ++chunk)
+        offsets[chunk + 1] = offsets[chunk] + buffers[chunk].size();
+
+    result.resize(offsets.back());
+    Parallel::parallel_for(0, static_cast<int>(buffers.size()), [&](int chunk)
+    {
+        std::copy(buffers[chunk].begin(), buffers[chunk].end(), result.begin() + offsets[chunk]);
+    }, 1);
+}
+
+// Returns the symbol of the line and moves pos behind it, '\0' for blank lines
+static char read_symbol(const char *&pos, const char *end)
+{
+    skip_blanks(pos, end);
+    return pos < end ? *pos++ : '\0';
+}
+
+// Per chunk out degree counts take node_number ints each, there are at most this many counts per edge
+constexpr std::size_t MAX_DEGREE_COUNTS_PER_EDGE = 2;
+
+// Parses a line after the summary line, node_from is -1 for blank and comment lines. Node ids are 0-based.
+static LineStatus parse_edge_line(const char *pos, const char *end, const int node_number, int &node_from, int &node_to,
+                                  double &weight)
+{
+    node_from = -1;
+    switch (read_symbol(pos, end))
+    {
+        case '\0':
+        case COMMENT_SYMBOL:
+        {
+            return LineStatus::CORRECT;
+        }
+        case EDGE_SYMBOL:
+        {
+            int from, to;
+
+            if (!parse_number(pos, end, from) || !parse_number(pos, end, to) || !parse_number(pos, end, weight) ||
+                (from <= 0 || node_number < from) || (to <= 0 || node_number < to) || weight < 0)
+            {
+                return LineStatus::INCORRECT_FORMAT;
+            }
+
+            node_from = from - 1;
+            node_to = to - 1;
+            return LineStatus::CORRECT;
+        }
+        default:
+        {
+            return LineStatus::INCORRECT_SYMBOL;
+        }
     }
+}
 
-    std::string line;
+// Parses the text of a DIMACS graph file
+static void parse_graph(const MappedFile &file, const std::string &graph_file, CHGraph::Graph &graph)
+{
     int line_number = 1;
     bool summary_read = false;
-    int node_number, edge_number;
+    int node_number = 0, edge_number = 0;
+    const char *edges_begin = file.end();
 
-    while (std::getline(file, line))
+    for_each_line(file.begin(), file.end(), [&](const char *pos, const char *end)
     {
-        std::istringstream string_stream(line);
-        char symbol;
-        string_stream >> symbol;
-
-        switch (symbol)
+        switch (read_symbol(pos, end))
         {
+            case '\0':
             case COMMENT_SYMBOL:
             {
                 break;
             }
             case GRAPH_SUMMARY_SYMBOL:
             {
-                std::string sp_symbols;
-                string_stream >> sp_symbols >> node_number >> edge_number;
-                
-                if (string_stream.fail() || sp_symbols != "sp" || node_number < 0 || edge_number < 0)
+                std::string_view sp_symbols;
+                if (!parse_word(pos, end, sp_symbols) || !parse_number(pos, end, node_number) || !parse_number(pos, end, edge_number) ||
+                    sp_symbols != "sp" || node_number < 0 || edge_number < 0)
                 {
                     throw std::runtime_error("Incorrect summary line on line " + std::to_string(line_number) + " in graph file " + graph_file);
                 }
@@ -70,187 +333,272 @@ void FileFacilities::read_graph(const std::string &graph_file, CHGraph::Graph &g
 
         if (summary_read)
         {
-            break;
+            edges_begin = end < file.end() ? end + 1 : end;
         }
-    }
+
+        return !summary_read;
+    });
 
     if(!summary_read)
     {
         throw std::runtime_error("No summary line in graph file " + graph_file);
     }
 
-    int actual_edge_number = 0;
-    std::unordered_map<int, std::vector<std::pair<int, double>>> edge_map;
+    const std::size_t max_chunk_number = std::max<std::size_t>(1, MAX_DEGREE_COUNTS_PER_EDGE * edge_number / std::max(1, node_number));
+    const std::vector<const char *> bounds =
+        split_chunks(edges_begin, file.end(), std::min<std::size_t>(max_chunk_number, static_cast<std::size_t>(CHUNKS_PER_THREAD) * Parallel::thread_number()));
 
-    while (std::getline(file, line))
+    // First pass checks the edges and counts the out degrees of every chunk, chunks without edges keep no counts
+    std::vector<std::vector<int>> chunk_degrees;
+    const LineError error = parse_chunks(bounds, chunk_degrees, [node_number](const char *pos, const char *end, std::vector<int> &degrees)
     {
-        std::istringstream string_stream(line);
-        char symbol;
-        string_stream >> symbol;
-
-        switch (symbol)
+        int node_from, node_to;
+        double weight;
+        const LineStatus status = parse_edge_line(pos, end, node_number, node_from, node_to, weight);
+        if (status == LineStatus::CORRECT && node_from != -1)
         {
-            case COMMENT_SYMBOL:
-            {
-                break;
-            }
-            case EDGE_SYMBOL:
-            {
-                int node_from, node_to;
-                double weight;
-                string_stream >> node_from >> node_to >> weight;
-                
-                if (string_stream.fail() || (node_from <= 0 || node_number < node_from) || (node_to <= 0 || node_number < node_to) || weight < 0)
-                {
-                    throw std::runtime_error("Incorrect edge format on line " + std::to_string(line_number) + " in graph file " + graph_file);
-                }
+            if (degrees.empty())
+                degrees.assign(node_number, 0);
+            ++degrees[node_from];
+        }
+        return status;
+    });
 
-                node_from -= 1;
-                node_to -= 1;
+    if (error.status == LineStatus::INCORRECT_FORMAT)
+    {
+        throw std::runtime_error("Incorrect edge format on line " + std::to_string(line_number + error.line) + " in graph file " + graph_file);
+    }
+    if (error.status == LineStatus::INCORRECT_SYMBOL)
+    {
+        throw std::runtime_error("Incorrect symbol on line " + std::to_string(line_number + error.line) + " in graph file " + graph_file);
+    }
 
-                edge_map[node_from].emplace_back(node_to, weight);
-                ++actual_edge_number;
-                break;
-            }
-            default:
-            {
-                throw std::runtime_error("Incorrect symbol on line " + std::to_string(line_number) + " in graph file " + graph_file);
-            }
+    // The counts of a chunk become the offsets of its edges among the edges of the same node, so edges of a
+    // node keep their order in the file
+    std::vector<int> first_out(node_number + 1, 0);
+    Parallel::parallel_for(0, node_number, [&chunk_degrees, &first_out](int node)
+    {
+        int degree = 0;
+        for (std::vector<int> &degrees : chunk_degrees)
+        {
+            if (degrees.empty())
+                continue;
+            const int chunk_degree = degrees[node];
+            degrees[node] = degree;
+            degree += chunk_degree;
         }
+        first_out[node + 1] = degree;
+    });
 
-        ++line_number;
+    std::size_t actual_edge_number = 0;
+    for (int node = 0; node < node_number; ++node)
+    {
+        actual_edge_number += first_out[node + 1];
     }
-    
-    if (actual_edge_number != edge_number)
+
+    if (actual_edge_number != static_cast<std::size_t>(edge_number))
     {
         throw std::runtime_error("Actual number of edges and number of edges from summary line are not equal in graph file " + graph_file);
     }
 
-    graph.first_out.reserve(node_number + 1);
-    graph.from.reserve(edge_number);
-    graph.to.reserve(edge_number);
-    graph.weights.reserve(edge_number);
+    for (int node = 0; node < node_number; ++node)
+    {
+        first_out[node + 1] += first_out[node];
+    }
+
+    // Second pass writes every edge to its slot, the lines are known to be correct
+    graph.from.resize(edge_number);
+    graph.to.resize(edge_number);
+    graph.weights.resize(edge_number);
+
+    parse_chunks(bounds, chunk_degrees, [node_number, &first_out, &graph](const char *pos, const char *end, std::vector<int> &next_slot)
+    {
+        int node_from, node_to;
+        double weight;
+        parse_edge_line(pos, end, node_number, node_from, node_to, weight);
+        if (node_from != -1)
+        {
+            const int slot = first_out[node_from] + next_slot[node_from]++;
+            graph.from[slot] = node_from;
+            graph.to[slot] = node_to;
+            graph.weights[slot] = weight;
+        }
+        return LineStatus::CORRECT;
+    });
+
+    graph.first_out = std::move(first_out);
+}
 
-    for (int node_from = 0; node_from < node_number; ++node_from)
+static LineStatus parse_destination_line(const char *pos, const char *end, std::vector<CHGraph::Destination> &destinations)
+{
+    switch (read_symbol(pos, end))
     {
-        graph.first_out.push_back(graph.from.size());
-        
-        if (edge_map.find(node_from) != edge_map.end())
+        case '\0':
+        case COMMENT_SYMBOL:
         {
-            for (auto &edge_pair: edge_map[node_from])
+            return LineStatus::CORRECT;
+        }
+        case DESTINATION_SYMBOL:
+        {
+            int node_from, node_to;
+
+            if (!parse_number(pos, end, node_from) || !parse_number(pos, end, node_to) || node_from < 0 || node_to < 0)
             {
-                graph.from.push_back(node_from);
-                graph.to.push_back(edge_pair.first);
-                graph.weights.push_back(edge_pair.second);
+                return LineStatus::INCORRECT_FORMAT;
             }
+
+            destinations.push_back(CHGraph::Destination{.source = node_from, .target = node_to});
+            return LineStatus::CORRECT;
+        }
+        default:
+        {
+            return LineStatus::INCORRECT_SYMBOL;
         }
     }
-    
-    // Add sentinel entry for first_out[n]
-    graph.first_out.push_back(graph.from.size());
+}
 
-    file.close();
+static void throw_destination_error(const LineStatus status, const int line_number, const std::string &destinations_file)
+{
+    if (status == LineStatus::INCORRECT_FORMAT)
+    {
+        throw std::runtime_error("Incorrect destination format on line " + std::to_string(line_number) + " in destinations file " + destinations_file);
+    }
+    throw std::runtime_error("Incorrect format on line " + std::to_string(line_number) + " in destinations file " + destinations_file);
 }
 
 void FileFacilities::read_destinations(const std::string &destinations_file, std::vector<CHGraph::Destination> &destinations)
 {
-    std::ifstream file(destinations_file);
-    std::string line;
+    MappedFile file(destinations_file);
 
     if (!file.is_open())
     {
         throw std::runtime_error("Can not open destinations file " + destinations_file);
     }
 
-    int line_number = 1;
-    
-    while (std::getline(file, line))
+    std::vector<std::vector<CHGraph::Destination>> chunks;
+    const LineError error = parse_chunks(file.begin(), file.end(), chunks, parse_destination_line);
+
+    if (error.status != LineStatus::CORRECT)
+    {
+        throw_destination_error(error.status, error.line + 1, destinations_file);
+    }
+
+    merge_chunks(chunks, destinations);
+}
+
+FileFacilities::DestinationReader::DestinationReader(const std::string &destinations_file)
+    : m_destinations_file(destinations_file), m_file(destinations_file, std::ios::binary), m_buffer(DESTINATION_READER_BUFFER_SIZE)
+{
+    if (!m_file.is_open())
+    {
+        throw std::runtime_error("Can not open destinations file " + destinations_file);
+    }
+}
+
+bool FileFacilities::DestinationReader::next_line(const char *&line_begin, const char *&line_end)
+{
+    while (true)
     {
-        std::istringstream string_stream(line);
-        char symbol;
-        string_stream >> symbol;
+        const char *begin = m_buffer.data() + m_begin;
+        const char *end = m_buffer.data() + m_end;
+        const char *new_line = static_cast<const char *>(std::memchr(begin, '\n', end - begin));
 
-        switch (symbol)
+        if (new_line != nullptr || (m_eof && begin < end))
         {
-            case COMMENT_SYMBOL:
-            {
-                break;
-            }
-            case DESTINATION_SYMBOL:
-            {
-                int node_from, node_to;
-                string_stream >> node_from >> node_to;
-                
-                if (string_stream.fail() || node_from < 0 || node_to < 0)
-                {
-                    throw std::runtime_error("Incorrect destination format on line " + std::to_string(line_number) + " in destinations file " + destinations_file);
-                }
+            line_begin = begin;
+            line_end = new_line != nullptr ? new_line : end;
+            m_begin = line_end - m_buffer.data() + (new_line != nullptr ? 1 : 0);
+            return true;
+        }
 
-                CHGraph::Destination destination{.source = node_from, .target = node_to};
-                destinations.push_back(destination);
-                break;
-            }
-            default:
-            {
-                throw std::runtime_error("Incorrect format on line " + std::to_string(line_number) + " in destinations file " + destinations_file);
-            }
+        if (m_eof)
+        {
+            return false;
         }
 
-        ++line_number;
+        // Keep the incomplete line and refill behind it, lines longer than the buffer grow it
+        std::memmove(m_buffer.data(), begin, end - begin);
+        m_end -= m_begin;
+        m_begin = 0;
+        if (m_end == m_buffer.size())
+        {
+            m_buffer.resize(2 * m_buffer.size());
+        }
+
+        m_file.read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+        m_end += m_file.gcount();
+        m_eof = m_file.eof() || m_file.gcount() == 0;
+    }
+}
+
+bool FileFacilities::DestinationReader::next_batch(std::vector<CHGraph::Destination> &batch, const std::size_t max_batch_size)
+{
+    batch.clear();
+    const char *line_begin, *line_end;
+
+    while (batch.size() < max_batch_size && next_line(line_begin, line_end))
+    {
+        const LineStatus status = parse_destination_line(line_begin, line_end, batch);
+        if (status != LineStatus::CORRECT)
+        {
+            throw_destination_error(status, m_line_number, m_destinations_file);
+        }
+        ++m_line_number;
     }
 
-    file.close();
+    return !batch.empty();
 }
 
 void FileFacilities::read_solutions(const std::string &solutions_file, std::vector<CHGraph::Solution> &solutions)
 {
-    std::ifstream file(solutions_file);
-    std::string line;
+    MappedFile file(solutions_file);
 
     if (!file.is_open())
     {
         throw std::runtime_error("Can not open solutions file " + solutions_file);
     }
 
-    int line_number = 1;
-    
-    while (std::getline(file, line))
+    std::vector<std::vector<CHGraph::Solution>> chunks;
+    const LineError error = parse_chunks(file.begin(), file.end(), chunks, [](const char *pos, const char *end, std::vector<CHGraph::Solution> &chunk)
     {
-        std::istringstream string_stream(line);
-        char symbol;
-        string_stream >> symbol;
-
-        switch (symbol)
+        switch (read_symbol(pos, end))
         {
+            case '\0':
             case COMMENT_SYMBOL:
             {
-                break;
+                return LineStatus::CORRECT;
             }
             case DESTINATION_SYMBOL:
             {
                 int node_from, node_to;
                 double weight;
-                string_stream >> node_from >> node_to >> weight;
-                
-                if (string_stream.fail() || node_from < 0 || node_to < 0 || weight < 0)
+
+                if (!parse_number(pos, end, node_from) || !parse_number(pos, end, node_to) || !parse_number(pos, end, weight) ||
+                    node_from < 0 || node_to < 0 || weight < 0)
                 {
-                    throw std::runtime_error("Incorrect solution format on line " + std::to_string(line_number) + " in solutions file " + solutions_file);
+                    return LineStatus::INCORRECT_FORMAT;
                 }
 
-                CHGraph::Solution solution{.source = node_from, .target = node_to, .expected_weight = weight};
-                solutions.push_back(solution);
-                break;
+                chunk.push_back(CHGraph::Solution{.source = node_from, .target = node_to, .expected_weight = weight});
+                return LineStatus::CORRECT;
             }
             default:
             {
-                throw std::runtime_error("Incorrect format on line " + std::to_string(line_number) + " in solutions file " + solutions_file);
+                return LineStatus::INCORRECT_SYMBOL;
             }
         }
+    });
 
-        ++line_number;
+    if (error.status == LineStatus::INCORRECT_FORMAT)
+    {
+        throw std::runtime_error("Incorrect solution format on line " + std::to_string(error.line + 1) + " in solutions file " + solutions_file);
+    }
+    if (error.status == LineStatus::INCORRECT_SYMBOL)
+    {
+        throw std::runtime_error("Incorrect format on line " + std::to_string(error.line + 1) + " in solutions file " + solutions_file);
     }
 
-    file.close();
+    merge_chunks(chunks, solutions);
 }
 
 void FileFacilities::dump_measurement(const Measurement &measurement, const std::string &output_file)
@@ -300,4 +648,768 @@ void FileFacilities::dump_measurement(const Measurement &measurement, const std:
     }
 
     file.close();
-}
\ No newline at end of file
+}
+
+// Percentiles reported by the measurement summaries, next to count, min, max and mean
+static const std::vector<std::pair<std::string, double>> SUMMARY_PERCENTILES = {
+    {"median", 50.0}, {"p90", 90.0}, {"p99", 99.0}};
+
+// Registered metric ids with at least one value, sorted by metric name
+static std::vector<MetricId> sorted_metrics(const Measurement &measurement)
+{
+    std::vector<MetricId> metrics;
+    for (MetricId metric = 0; metric < static_cast<MetricId>(measurement.metric_names.size()); ++metric)
+    {
+        if (measurement.histograms[metric].count() > 0)
+            metrics.push_back(metric);
+    }
+
+    std::sort(metrics.begin(), metrics.end(), [&](MetricId a, MetricId b) {
+        return measurement.metric_names[a] < measurement.metric_names[b];
+    });
+    return metrics;
+}
+
+// (statistic, value) pairs of one histogram, in output order
+static std::vector<std::pair<std::string, std::string>> summary_statistics(const Histogram &histogram)
+{
+    std::vector<std::pair<std::string, std::string>> statistics = {
+        {"count", std::to_string(histogram.count())},
+        {"min", std::to_string(histogram.min())}};
+
+    for (const auto &[name, percentile] : SUMMARY_PERCENTILES)
+    {
+        statistics.emplace_back(name, std::to_string(histogram.value_at_percentile(percentile)));
+    }
+
+    std::ostringstream mean;
+    mean << std::fixed << std::setprecision(3) << histogram.mean();
+    statistics.emplace_back("max", std::to_string(histogram.max()));
+    statistics.emplace_back("mean", mean.str());
+    return statistics;
+}
+
+static std::string json_string(const std::string &text)
+{
+    std::ostringstream result;
+    result << '"';
+    for (const char symbol : text)
+    {
+        if (symbol == '"' || symbol == '\\')
+        {
+            result << '\\' << symbol;
+        }
+        else if (static_cast<unsigned char>(symbol) < 0x20)
+        {
+            result << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(symbol) << std::dec;
+        }
+        else
+        {
+            result << symbol;
+        }
+    }
+    result << '"';
+    return result.str();
+}
+
+void FileFacilities::dump_measurement_summary(const Measurement &measurement, const std::string &output_file)
+{
+    std::ofstream file(output_file);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not create output file " + output_file);
+    }
+
+    file << "metric" << CSV_NEW_COLUMN_SYMBOL << "statistic" << CSV_NEW_COLUMN_SYMBOL << "value" << CSV_NEW_LINE_SYMBOL;
+
+    for (const MetricId metric : sorted_metrics(measurement))
+    {
+        for (const auto &[statistic, value] : summary_statistics(measurement.histograms[metric]))
+        {
+            file << measurement.metric_names[metric] << CSV_NEW_COLUMN_SYMBOL << statistic << CSV_NEW_COLUMN_SYMBOL
+                 << value << CSV_NEW_LINE_SYMBOL;
+        }
+    }
+
+    file.close();
+}
+
+void FileFacilities::dump_measurement_json(const Measurement &measurement, const std::string &output_file)
+{
+    std::ofstream file(output_file);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not create output file " + output_file);
+    }
+
+    const std::vector<MetricId> metrics = sorted_metrics(measurement);
+
+    file << "{\n";
+    for (size_t ind = 0; ind < metrics.size(); ++ind)
+    {
+        file << "  " << json_string(measurement.metric_names[metrics[ind]]) << ": {";
+
+        const auto statistics = summary_statistics(measurement.histograms[metrics[ind]]);
+        for (size_t stat = 0; stat < statistics.size(); ++stat)
+        {
+            file << (stat == 0 ? "" : ", ") << json_string(statistics[stat].first) << ": " << statistics[stat].second;
+        }
+
+        file << "}" << (ind + 1 < metrics.size() ? "," : "") << "\n";
+    }
+    file << "}\n";
+
+    file.close();
+}
+
+// Header of a preproc graph file, followed by ranks, forward_first_out, forward_arcs,
+// backward_first_out and backward_arcs
+struct PreprocFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t section_lengths[PREPROC_FILE_SECTION_NUMBER]; // number of elements per section
+    std::uint64_t payload_size;
+    std::uint64_t checksum; // over the payload, see checksum_words
+    std::uint64_t graph_checksum; // over first_out, to and weights of the preprocessed graph
+    std::uint64_t reserved[6];
+};
+
+// On disk layout of CHGraph::CHArc with explicit, zeroed padding
+struct StoredArc
+{
+    std::int32_t from;
+    std::int32_t to;
+    double weight;
+    std::int32_t mid_node;
+    std::int32_t padding;
+};
+
+static_assert(sizeof(PreprocFileHeader) % BINARY_FILE_ALIGNMENT == 0);
+static_assert(sizeof(StoredArc) == sizeof(CHGraph::CHArc) && offsetof(StoredArc, from) == offsetof(CHGraph::CHArc, from) &&
+              offsetof(StoredArc, to) == offsetof(CHGraph::CHArc, to) && offsetof(StoredArc, weight) == offsetof(CHGraph::CHArc, weight) &&
+              offsetof(StoredArc, mid_node) == offsetof(CHGraph::CHArc, mid_node), "CHArc layout differs from the file format");
+
+static std::size_t aligned_size(const std::size_t size)
+{
+    return (size + BINARY_FILE_ALIGNMENT - 1) / BINARY_FILE_ALIGNMENT * BINARY_FILE_ALIGNMENT;
+}
+
+// FNV-1a over 64 bit words, a trailing partial word is padded with zeros
+static std::uint64_t checksum_words(const char *data, const std::size_t size, std::uint64_t hash = BINARY_FILE_CHECKSUM_SEED)
+{
+    for (std::size_t pos = 0; pos < size; pos += sizeof(std::uint64_t))
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data + pos, std::min(sizeof(word), size - pos));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Binary files consist of a header and sections padded with zeros to BINARY_FILE_ALIGNMENT bytes,
+// the checksum covers all sections including the padding
+static void write_section(std::ofstream &file, const void *data, const std::size_t size, std::uint64_t &checksum, std::uint64_t &payload_size)
+{
+    const char *bytes = static_cast<const char *>(data);
+    std::vector<char> buffer(bytes, bytes + size);
+    buffer.resize(aligned_size(size), 0);
+    checksum = checksum_words(buffer.data(), buffer.size(), checksum);
+    payload_size += buffer.size();
+    file.write(buffer.data(), buffer.size());
+}
+
+// Copies length elements from section and moves section to the next one
+template <typename Value>
+static void read_section(const char *&section, const std::size_t length, std::vector<Value> &values)
+{
+    values.resize(length);
+    if (length > 0)
+        std::memcpy(values.data(), section, length * sizeof(Value));
+    section += aligned_size(length * sizeof(Value));
+}
+
+static std::uint64_t graph_checksum(const CHGraph::Graph &graph)
+{
+    std::uint64_t hash = checksum_words(reinterpret_cast<const char *>(graph.first_out.data()), graph.first_out.size() * sizeof(int));
+    hash = checksum_words(reinterpret_cast<const char *>(graph.to.data()), graph.to.size() * sizeof(int), hash);
+    return checksum_words(reinterpret_cast<const char *>(graph.weights.data()), graph.weights.size() * sizeof(double), hash);
+}
+
+void FileFacilities::save_preproc_graph(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph,
+                                        const std::string &preproc_file)
+{
+    std::ofstream file(preproc_file, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not create preproc graph file " + preproc_file);
+    }
+
+    PreprocFileHeader header{};
+    std::memcpy(header.magic, PREPROC_FILE_MAGIC, sizeof(header.magic));
+    header.version = PREPROC_FILE_VERSION;
+    header.byte_order = BINARY_FILE_BYTE_ORDER;
+    header.graph_checksum = graph_checksum(graph);
+    header.section_lengths[0] = preproc_graph.ranks.size();
+    header.section_lengths[1] = preproc_graph.forward_first_out.size();
+    header.section_lengths[2] = preproc_graph.forward_arcs.size();
+    header.section_lengths[3] = preproc_graph.backward_first_out.size();
+    header.section_lengths[4] = preproc_graph.backward_arcs.size();
+    header.checksum = BINARY_FILE_CHECKSUM_SEED;
+
+    // Header is rewritten with the final checksum once the payload is written
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    auto write_ints = [&](const std::vector<int> &values)
+    {
+        write_section(file, values.data(), values.size() * sizeof(int), header.checksum, header.payload_size);
+    };
+
+    auto write_arcs = [&](const std::vector<CHGraph::CHArc> &arcs)
+    {
+        std::vector<StoredArc> stored(arcs.size());
+        for (std::size_t ind = 0; ind < arcs.size(); ++ind)
+            stored[ind] = StoredArc{arcs[ind].from, arcs[ind].to, arcs[ind].weight, arcs[ind].mid_node, 0};
+        write_section(file, stored.data(), stored.size() * sizeof(StoredArc), header.checksum, header.payload_size);
+    };
+
+    write_ints(preproc_graph.ranks);
+    write_ints(preproc_graph.forward_first_out);
+    write_arcs(preproc_graph.forward_arcs);
+    write_ints(preproc_graph.backward_first_out);
+    write_arcs(preproc_graph.backward_arcs);
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    if (!file.good())
+    {
+        throw std::runtime_error("Can not write preproc graph file " + preproc_file);
+    }
+
+    file.close();
+}
+
+void FileFacilities::load_preproc_graph(const std::string &preproc_file, const CHGraph::Graph &graph,
+                                        CHGraph::PreprocGraph &preproc_graph)
+{
+    MappedFile file(preproc_file);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not open preproc graph file " + preproc_file);
+    }
+
+    const std::size_t file_size = file.end() - file.begin();
+    PreprocFileHeader header;
+
+    if (file_size < sizeof(header))
+    {
+        throw std::runtime_error("Incorrect header in preproc graph file " + preproc_file);
+    }
+
+    std::memcpy(&header, file.begin(), sizeof(header));
+
+    if (std::memcmp(header.magic, PREPROC_FILE_MAGIC, sizeof(header.magic)) != 0 || header.byte_order != BINARY_FILE_BYTE_ORDER)
+    {
+        throw std::runtime_error("Incorrect header in preproc graph file " + preproc_file);
+    }
+
+    if (header.version != PREPROC_FILE_VERSION)
+    {
+        throw std::runtime_error("Unsupported version " + std::to_string(header.version) + " of preproc graph file " + preproc_file);
+    }
+
+    if (header.graph_checksum != graph_checksum(graph))
+    {
+        throw std::runtime_error("Preproc graph file " + preproc_file + " belongs to another graph");
+    }
+
+    const std::size_t element_sizes[PREPROC_FILE_SECTION_NUMBER] = {sizeof(int), sizeof(int), sizeof(StoredArc), sizeof(int), sizeof(StoredArc)};
+    std::size_t payload_size = 0;
+    for (int section = 0; section < PREPROC_FILE_SECTION_NUMBER; ++section)
+    {
+        if (header.section_lengths[section] > file_size / element_sizes[section])
+        {
+            throw std::runtime_error("Incorrect size of preproc graph file " + preproc_file);
+        }
+
+        payload_size += aligned_size(header.section_lengths[section] * element_sizes[section]);
+    }
+
+    // Queries index the node arrays by node ids of graph
+    const std::uint64_t node_number = graph.first_out.empty() ? 0 : graph.first_out.size() - 1;
+    if (header.payload_size != payload_size || file_size != sizeof(header) + payload_size ||
+        header.section_lengths[0] != node_number || header.section_lengths[1] != node_number + 1 ||
+        header.section_lengths[3] != node_number + 1)
+    {
+        throw std::runtime_error("Incorrect size of preproc graph file " + preproc_file);
+    }
+
+    const char *payload = file.begin() + sizeof(header);
+
+    if (checksum_words(payload, payload_size) != header.checksum)
+    {
+        throw std::runtime_error("Checksum mismatch in preproc graph file " + preproc_file);
+    }
+
+    // Sections are stored in the in memory layout, loading is one copy per array
+    const char *section = payload;
+    read_section(section, header.section_lengths[0], preproc_graph.ranks);
+    read_section(section, header.section_lengths[1], preproc_graph.forward_first_out);
+    read_section(section, header.section_lengths[2], preproc_graph.forward_arcs);
+    read_section(section, header.section_lengths[3], preproc_graph.backward_first_out);
+    read_section(section, header.section_lengths[4], preproc_graph.backward_arcs);
+
+    preproc_graph.components.clear();
+    preproc_graph.component_number = 0;
+    preproc_graph.component_reachability.clear();
+}
+
+// Header of a graph cache file, followed by first_out, from, to and weights. The source
+// fields identify the text file the cache was built from.
+struct GraphCacheHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t source_size;
+    std::int64_t source_mtime; // nanoseconds since epoch
+    std::uint64_t source_hash;
+    std::uint64_t section_lengths[GRAPH_CACHE_SECTION_NUMBER];
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+    std::uint64_t reserved[5];
+};
+
+static_assert(sizeof(GraphCacheHeader) % BINARY_FILE_ALIGNMENT == 0);
+
+// Fills graph from the cache if it is intact and was built from the source described by source_header
+static bool load_graph_cache(const std::string &cache_file, const GraphCacheHeader &source_header, CHGraph::Graph &graph)
+{
+    MappedFile file(cache_file);
+    const std::size_t file_size = file.end() - file.begin();
+    GraphCacheHeader header;
+
+    if (!file.is_open() || file_size < sizeof(header))
+        return false;
+
+    std::memcpy(&header, file.begin(), sizeof(header));
+
+    if (std::memcmp(header.magic, GRAPH_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != GRAPH_CACHE_VERSION ||
+        header.byte_order != BINARY_FILE_BYTE_ORDER || header.source_size != source_header.source_size ||
+        header.source_mtime != source_header.source_mtime || header.source_hash != source_header.source_hash)
+    {
+        return false;
+    }
+
+    const std::size_t element_sizes[GRAPH_CACHE_SECTION_NUMBER] = {sizeof(int), sizeof(int), sizeof(int), sizeof(double)};
+    std::size_t payload_size = 0;
+    for (int section = 0; section < GRAPH_CACHE_SECTION_NUMBER; ++section)
+    {
+        if (header.section_lengths[section] > file_size / element_sizes[section])
+            return false;
+        payload_size += aligned_size(header.section_lengths[section] * element_sizes[section]);
+    }
+
+    const char *section = file.begin() + sizeof(header);
+    if (header.payload_size != payload_size || file_size != sizeof(header) + payload_size ||
+        checksum_words(section, payload_size) != header.checksum)
+    {
+        return false;
+    }
+
+    read_section(section, header.section_lengths[0], graph.first_out);
+    read_section(section, header.section_lengths[1], graph.from);
+    read_section(section, header.section_lengths[2], graph.to);
+    read_section(section, header.section_lengths[3], graph.weights);
+    return true;
+}
+
+// Writes the cache next to its final name and renames it, so readers never see a partial cache.
+// The cache is only an optimization, failures leave no cache behind.
+static void save_graph_cache(const std::string &cache_file, GraphCacheHeader header, const CHGraph::Graph &graph)
+{
+    const std::string tmp_file = cache_file + ".tmp";
+    {
+        std::ofstream file(tmp_file, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return;
+
+        header.section_lengths[0] = graph.first_out.size();
+        header.section_lengths[1] = graph.from.size();
+        header.section_lengths[2] = graph.to.size();
+        header.section_lengths[3] = graph.weights.size();
+        header.payload_size = 0;
+        header.checksum = BINARY_FILE_CHECKSUM_SEED;
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        write_section(file, graph.first_out.data(), graph.first_out.size() * sizeof(int), header.checksum, header.payload_size);
+        write_section(file, graph.from.data(), graph.from.size() * sizeof(int), header.checksum, header.payload_size);
+        write_section(file, graph.to.data(), graph.to.size() * sizeof(int), header.checksum, header.payload_size);
+        write_section(file, graph.weights.data(), graph.weights.size() * sizeof(double), header.checksum, header.payload_size);
+        file.seekp(0);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        if (!file.good())
+        {
+            file.close();
+            std::remove(tmp_file.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(tmp_file.c_str(), cache_file.c_str()) != 0)
+        std::remove(tmp_file.c_str());
+}
+
+void FileFacilities::read_graph(const std::string &graph_file, CHGraph::Graph &graph, const GraphCacheMode cache_mode)
+{
+    TRACE_SCOPE("read_graph");
+    MappedFile file(graph_file);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not open destinations file " + graph_file);
+    }
+
+    if (cache_mode == GraphCacheMode::DISABLED)
+    {
+        parse_graph(file, graph_file, graph);
+        return;
+    }
+
+    struct stat file_stat;
+    if (::stat(graph_file.c_str(), &file_stat) != 0)
+    {
+        throw std::runtime_error("Can not open destinations file " + graph_file);
+    }
+
+    GraphCacheHeader source_header{};
+    std::memcpy(source_header.magic, GRAPH_CACHE_MAGIC, sizeof(source_header.magic));
+    source_header.version = GRAPH_CACHE_VERSION;
+    source_header.byte_order = BINARY_FILE_BYTE_ORDER;
+    source_header.source_size = static_cast<std::uint64_t>(file_stat.st_size);
+    source_header.source_mtime = static_cast<std::int64_t>(file_stat.st_mtim.tv_sec) * 1000000000LL + file_stat.st_mtim.tv_nsec;
+    source_header.source_hash = checksum_words(file.begin(), file.end() - file.begin());
+
+    const std::string cache_file = graph_file + GRAPH_CACHE_EXTENSION;
+
+    if (cache_mode == GraphCacheMode::ENABLED && load_graph_cache(cache_file, source_header, graph))
+    {
+        return;
+    }
+
+    parse_graph(file, graph_file, graph);
+    save_graph_cache(cache_file, source_header, graph);
+}
+
+// Header of a contraction checkpoint file, followed by ranks, contracted, out_first_out, out_arcs, in_first_out,
+// in_arcs, shortcuts, queue_priorities and queue_nodes of the ContractionState
+struct CheckpointFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t method;
+    std::int32_t contracted_nodes;
+    std::uint64_t graph_checksum; // over first_out, to and weights of the contracted graph
+    std::uint64_t section_lengths[CHECKPOINT_FILE_SECTION_NUMBER];
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+    std::uint64_t reserved[1];
+};
+
+static_assert(sizeof(CheckpointFileHeader) % BINARY_FILE_ALIGNMENT == 0);
+
+void FileFacilities::save_contraction_checkpoint(const CHGraph::Graph &graph, const CHGraph::ContractionState &state,
+                                                 const std::string &checkpoint_file)
+{
+    const std::string tmp_file = checkpoint_file + ".tmp";
+    {
+        std::ofstream file(tmp_file, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Can not create checkpoint file " + tmp_file);
+        }
+
+        CheckpointFileHeader header{};
+        std::memcpy(header.magic, CHECKPOINT_FILE_MAGIC, sizeof(header.magic));
+        header.version = CHECKPOINT_FILE_VERSION;
+        header.byte_order = BINARY_FILE_BYTE_ORDER;
+        header.method = static_cast<std::uint32_t>(state.method);
+        header.contracted_nodes = state.contracted_nodes;
+        header.graph_checksum = graph_checksum(graph);
+        header.section_lengths[0] = state.ranks.size();
+        header.section_lengths[1] = state.contracted.size();
+        header.section_lengths[2] = state.out_first_out.size();
+        header.section_lengths[3] = state.out_arcs.size();
+        header.section_lengths[4] = state.in_first_out.size();
+        header.section_lengths[5] = state.in_arcs.size();
+        header.section_lengths[6] = state.shortcuts.size();
+        header.section_lengths[7] = state.queue_priorities.size();
+        header.section_lengths[8] = state.queue_nodes.size();
+        header.checksum = BINARY_FILE_CHECKSUM_SEED;
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        auto write_values = [&](const auto &values)
+        {
+            write_section(file, values.data(), values.size() * sizeof(values[0]), header.checksum, header.payload_size);
+        };
+
+        auto write_arcs = [&](const std::vector<CHGraph::CHArc> &arcs)
+        {
+            std::vector<StoredArc> stored(arcs.size());
+            for (std::size_t ind = 0; ind < arcs.size(); ++ind)
+                stored[ind] = StoredArc{arcs[ind].from, arcs[ind].to, arcs[ind].weight, arcs[ind].mid_node, 0};
+            write_values(stored);
+        };
+
+        write_values(state.ranks);
+        write_values(state.contracted);
+        write_values(state.out_first_out);
+        write_arcs(state.out_arcs);
+        write_values(state.in_first_out);
+        write_arcs(state.in_arcs);
+        write_arcs(state.shortcuts);
+        write_values(state.queue_priorities);
+        write_values(state.queue_nodes);
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        if (!file.good())
+        {
+            file.close();
+            std::remove(tmp_file.c_str());
+            throw std::runtime_error("Can not write checkpoint file " + tmp_file);
+        }
+    }
+
+    // The previous checkpoint stays intact until the new one is complete
+    if (std::rename(tmp_file.c_str(), checkpoint_file.c_str()) != 0)
+    {
+        std::remove(tmp_file.c_str());
+        throw std::runtime_error("Can not write checkpoint file " + checkpoint_file);
+    }
+}
+
+static bool valid_node(const int node, const int node_number)
+{
+    return node >= 0 && node < node_number;
+}
+
+static bool valid_arcs(const std::vector<CHGraph::CHArc> &arcs, const int node_number)
+{
+    return std::all_of(arcs.begin(), arcs.end(), [&](const CHGraph::CHArc &arc)
+                       { return valid_node(arc.from, node_number) && valid_node(arc.to, node_number) &&
+                                (arc.mid_node == -1 || valid_node(arc.mid_node, node_number)); });
+}
+
+// first_out has to start at 0, never decrease and end at the arc number
+static bool valid_adjacency(const std::vector<int> &first_out, const std::vector<CHGraph::CHArc> &arcs, const int node_number)
+{
+    return first_out.front() == 0 && static_cast<std::size_t>(first_out.back()) == arcs.size() &&
+           std::is_sorted(first_out.begin(), first_out.end()) && valid_arcs(arcs, node_number);
+}
+
+void FileFacilities::load_contraction_checkpoint(const std::string &checkpoint_file, const CHGraph::Graph &graph,
+                                                 CHGraph::ContractionState &state)
+{
+    MappedFile file(checkpoint_file);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not open checkpoint file " + checkpoint_file);
+    }
+
+    const std::size_t file_size = file.end() - file.begin();
+    CheckpointFileHeader header;
+
+    if (file_size < sizeof(header))
+    {
+        throw std::runtime_error("Incorrect header in checkpoint file " + checkpoint_file);
+    }
+
+    std::memcpy(&header, file.begin(), sizeof(header));
+
+    if (std::memcmp(header.magic, CHECKPOINT_FILE_MAGIC, sizeof(header.magic)) != 0 || header.byte_order != BINARY_FILE_BYTE_ORDER)
+    {
+        throw std::runtime_error("Incorrect header in checkpoint file " + checkpoint_file);
+    }
+
+    if (header.version != CHECKPOINT_FILE_VERSION)
+    {
+        throw std::runtime_error("Unsupported version " + std::to_string(header.version) + " of checkpoint file " + checkpoint_file);
+    }
+
+    if (header.graph_checksum != graph_checksum(graph))
+    {
+        throw std::runtime_error("Checkpoint file " + checkpoint_file + " belongs to another graph");
+    }
+
+    const std::size_t element_sizes[CHECKPOINT_FILE_SECTION_NUMBER] = {sizeof(int), sizeof(unsigned char), sizeof(int), sizeof(StoredArc), sizeof(int),
+                                                                       sizeof(StoredArc), sizeof(StoredArc), sizeof(int), sizeof(int)};
+    std::size_t payload_size = 0;
+    for (int section = 0; section < CHECKPOINT_FILE_SECTION_NUMBER; ++section)
+    {
+        if (header.section_lengths[section] > file_size / element_sizes[section])
+        {
+            throw std::runtime_error("Incorrect size of checkpoint file " + checkpoint_file);
+        }
+
+        payload_size += aligned_size(header.section_lengths[section] * element_sizes[section]);
+    }
+
+    // Node arrays have to fit the graph, the checksum covers the rest
+    const std::uint64_t node_number = graph.first_out.empty() ? 0 : graph.first_out.size() - 1;
+    if (header.payload_size != payload_size || file_size != sizeof(header) + payload_size ||
+        header.section_lengths[0] != node_number || header.section_lengths[1] != node_number ||
+        header.section_lengths[2] != node_number + 1 || header.section_lengths[4] != node_number + 1 ||
+        header.section_lengths[7] != header.section_lengths[8])
+    {
+        throw std::runtime_error("Incorrect size of checkpoint file " + checkpoint_file);
+    }
+
+    const char *payload = file.begin() + sizeof(header);
+
+    if (checksum_words(payload, payload_size) != header.checksum)
+    {
+        throw std::runtime_error("Checksum mismatch in checkpoint file " + checkpoint_file);
+    }
+
+    const int n = static_cast<int>(node_number);
+    if (header.method != static_cast<std::uint32_t>(CHGraph::ContractionMethod::BOTTOM_UP) &&
+        header.method != static_cast<std::uint32_t>(CHGraph::ContractionMethod::TOP_DOWN))
+    {
+        throw std::runtime_error("Unknown contraction method " + std::to_string(header.method) + " in checkpoint file " + checkpoint_file);
+    }
+
+    if (header.contracted_nodes < 0 || header.contracted_nodes > n)
+    {
+        throw std::runtime_error("Incorrect number of contracted nodes in checkpoint file " + checkpoint_file);
+    }
+
+    state.method = static_cast<CHGraph::ContractionMethod>(header.method);
+    state.contracted_nodes = header.contracted_nodes;
+
+    const char *section = payload;
+    read_section(section, header.section_lengths[0], state.ranks);
+    read_section(section, header.section_lengths[1], state.contracted);
+    read_section(section, header.section_lengths[2], state.out_first_out);
+    read_section(section, header.section_lengths[3], state.out_arcs);
+    read_section(section, header.section_lengths[4], state.in_first_out);
+    read_section(section, header.section_lengths[5], state.in_arcs);
+    read_section(section, header.section_lengths[6], state.shortcuts);
+    read_section(section, header.section_lengths[7], state.queue_priorities);
+    read_section(section, header.section_lengths[8], state.queue_nodes);
+
+    // The checksum only catches accidental damage, the contraction indexes by these without further checks
+    if (!valid_adjacency(state.out_first_out, state.out_arcs, n) || !valid_adjacency(state.in_first_out, state.in_arcs, n) ||
+        !valid_arcs(state.shortcuts, n))
+    {
+        throw std::runtime_error("Incorrect adjacency lists in checkpoint file " + checkpoint_file);
+    }
+
+    if (!std::all_of(state.ranks.begin(), state.ranks.end(), [&](const int rank)
+                     { return rank == -1 || valid_node(rank, n); }) ||
+        !std::all_of(state.queue_nodes.begin(), state.queue_nodes.end(), [&](const int node)
+                     { return valid_node(node, n); }))
+    {
+        throw std::runtime_error("Incorrect node in checkpoint file " + checkpoint_file);
+    }
+}
+
+// Header of a ranks file, followed by the ranks
+struct RanksFileHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t node_number;
+    std::uint64_t payload_size;
+    std::uint64_t checksum;
+    std::uint64_t reserved[11];
+};
+
+static_assert(sizeof(RanksFileHeader) % BINARY_FILE_ALIGNMENT == 0);
+
+void FileFacilities::save_ranks(const std::vector<int> &ranks, const std::string &ranks_file)
+{
+    std::ofstream file(ranks_file, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not create ranks file " + ranks_file);
+    }
+
+    RanksFileHeader header{};
+    std::memcpy(header.magic, RANKS_FILE_MAGIC, sizeof(header.magic));
+    header.version = RANKS_FILE_VERSION;
+    header.byte_order = BINARY_FILE_BYTE_ORDER;
+    header.node_number = ranks.size();
+    header.checksum = BINARY_FILE_CHECKSUM_SEED;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    write_section(file, ranks.data(), ranks.size() * sizeof(int), header.checksum, header.payload_size);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    if (!file.good())
+    {
+        throw std::runtime_error("Can not write ranks file " + ranks_file);
+    }
+
+    file.close();
+}
+
+void FileFacilities::load_ranks(const std::string &ranks_file, std::vector<int> &ranks)
+{
+    MappedFile file(ranks_file);
+
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not open ranks file " + ranks_file);
+    }
+
+    const std::size_t file_size = file.end() - file.begin();
+    RanksFileHeader header;
+
+    if (file_size < sizeof(header))
+    {
+        throw std::runtime_error("Incorrect header in ranks file " + ranks_file);
+    }
+
+    std::memcpy(&header, file.begin(), sizeof(header));
+
+    if (std::memcmp(header.magic, RANKS_FILE_MAGIC, sizeof(header.magic)) != 0 || header.byte_order != BINARY_FILE_BYTE_ORDER)
+    {
+        throw std::runtime_error("Incorrect header in ranks file " + ranks_file);
+    }
+
+    if (header.version != RANKS_FILE_VERSION)
+    {
+        throw std::runtime_error("Unsupported version " + std::to_string(header.version) + " of ranks file " + ranks_file);
+    }
+
+    if (header.node_number > file_size / sizeof(int) || header.payload_size != aligned_size(header.node_number * sizeof(int)) ||
+        file_size != sizeof(header) + header.payload_size)
+    {
+        throw std::runtime_error("Incorrect size of ranks file " + ranks_file);
+    }
+
+    const char *payload = file.begin() + sizeof(header);
+
+    if (checksum_words(payload, header.payload_size) != header.checksum)
+    {
+        throw std::runtime_error("Checksum mismatch in ranks file " + ranks_file);
+    }
+
+    read_section(payload, header.node_number, ranks);
+}
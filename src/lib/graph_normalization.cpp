@@ -0,0 +1,94 @@
+#include "graph_normalization.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+
+void CHGraph::normalize_graph(const CHGraph::Graph &graph, CHGraph::Graph &normalized_graph, CHGraph::NodeMapping &mapping,
+                              const bool remove_isolated_nodes)
+{
+    const int n = graph.first_out.empty() ? 0 : static_cast<int>(graph.first_out.size()) - 1;
+    if (graph.to.size() != graph.weights.size() || (n > 0 && graph.first_out[n] != static_cast<int>(graph.to.size())))
+    {
+        throw std::invalid_argument("Graph arrays have inconsistent sizes");
+    }
+
+    // Every node sorts and deduplicates its own range, kept[node] arcs stay at its front
+    std::vector<std::pair<int, double>> arcs(graph.to.size());
+    std::vector<int> kept(n, 0);
+    Parallel::parallel_for(0, n, [&](int node)
+    {
+        int last = graph.first_out[node];
+        for (int e = graph.first_out[node]; e < graph.first_out[node + 1]; ++e)
+            if (graph.to[e] != node)
+                arcs[last++] = std::make_pair(graph.to[e], graph.weights[e]);
+
+        const auto begin = arcs.begin() + graph.first_out[node];
+        std::sort(begin, arcs.begin() + last);
+        // the lightest arc to every target comes first
+        kept[node] = static_cast<int>(std::unique(begin, arcs.begin() + last,
+                                                  [](const auto &a, const auto &b) { return a.first == b.first; }) - begin);
+    });
+
+    std::vector<char> has_arcs(n, 0);
+    for (int node = 0; node < n; ++node)
+    {
+        has_arcs[node] |= (kept[node] > 0);
+        for (int e = graph.first_out[node]; e < graph.first_out[node] + kept[node]; ++e)
+            has_arcs[arcs[e].first] = 1;
+    }
+
+    mapping.to_normalized.assign(n, -1);
+    mapping.to_original.clear();
+    for (int node = 0; node < n; ++node)
+    {
+        if (remove_isolated_nodes && !has_arcs[node])
+            continue;
+        mapping.to_normalized[node] = static_cast<int>(mapping.to_original.size());
+        mapping.to_original.push_back(node);
+    }
+
+    const int normalized_n = static_cast<int>(mapping.to_original.size());
+    normalized_graph.first_out.assign(normalized_n + 1, 0);
+    for (int node = 0; node < normalized_n; ++node)
+        normalized_graph.first_out[node + 1] = normalized_graph.first_out[node] + kept[mapping.to_original[node]];
+
+    const int arc_number = normalized_graph.first_out[normalized_n];
+    normalized_graph.from.resize(arc_number);
+    normalized_graph.to.resize(arc_number);
+    normalized_graph.weights.resize(arc_number);
+    Parallel::parallel_for(0, normalized_n, [&](int node)
+    {
+        const int original = mapping.to_original[node];
+        for (int ind = 0; ind < kept[original]; ++ind)
+        {
+            const auto &[to, weight] = arcs[graph.first_out[original] + ind];
+            const int e = normalized_graph.first_out[node] + ind;
+            normalized_graph.from[e] = node;
+            normalized_graph.to[e] = mapping.to_normalized[to];
+            normalized_graph.weights[e] = weight;
+        }
+    });
+}
+
+bool CHGraph::normalize_destination(const CHGraph::NodeMapping &mapping, const CHGraph::Destination &destination,
+                                    CHGraph::Destination &normalized_destination)
+{
+    const int n = static_cast<int>(mapping.to_normalized.size());
+    auto normalize = [&](const int node) { return (node < 0 || node >= n) ? -1 : mapping.to_normalized[node]; };
+
+    normalized_destination = destination;
+    normalized_destination.source = normalize(destination.source);
+    normalized_destination.target = normalize(destination.target);
+    return normalized_destination.source != -1 && normalized_destination.target != -1;
+}
+
+void CHGraph::denormalize_route(const CHGraph::NodeMapping &mapping, CHGraph::Route &route)
+{
+    for (int &node : route.nodes)
+        node = mapping.to_original[node];
+}
@@ -0,0 +1,137 @@
+#include "hierarchy_quality.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <numeric>
+#include <random>
+#include <algorithm>
+#include <stdexcept>
+
+
+// Search spaces of one chunk of the sampled nodes
+struct SearchSpaceChunk
+{
+    Histogram forward_nodes;
+    Histogram backward_nodes;
+    Histogram forward_arcs;
+    Histogram backward_arcs;
+};
+
+// Counts the nodes reachable from source over arcs and the arcs scanned on the way. visited[node] == mark
+// flags the nodes reached by this search, stack is scratch space.
+static void upward_search_space(const std::vector<int> &first_out, const std::vector<CHGraph::CHArc> &arcs, const int source,
+                                std::vector<int> &visited, const int mark, std::vector<int> &stack,
+                                long long &nodes, long long &scanned_arcs)
+{
+    nodes = 1;
+    scanned_arcs = 0;
+    visited[source] = mark;
+    stack.assign(1, source);
+
+    while (!stack.empty())
+    {
+        const int u = stack.back();
+        stack.pop_back();
+
+        scanned_arcs += first_out[u + 1] - first_out[u];
+        for (int arc = first_out[u]; arc < first_out[u + 1]; ++arc)
+        {
+            const int v = arcs[arc].to;
+            if (visited[v] != mark)
+            {
+                visited[v] = mark;
+                ++nodes;
+                stack.push_back(v);
+            }
+        }
+    }
+}
+
+void CHGraph::analyze_hierarchy(const CHGraph::PreprocGraph &preproc_graph, CHGraph::HierarchyQuality &quality,
+                                const int sample_size, const unsigned int seed)
+{
+    const int n = static_cast<int>(preproc_graph.ranks.size());
+    if (preproc_graph.forward_first_out.size() != static_cast<std::size_t>(n) + 1 ||
+        preproc_graph.backward_first_out.size() != static_cast<std::size_t>(n) + 1)
+    {
+        throw std::invalid_argument("Preprocced graph has inconsistent node numbers");
+    }
+    if (sample_size < 0)
+    {
+        throw std::invalid_argument("Sample size must be non-negative");
+    }
+
+    quality = CHGraph::HierarchyQuality{};
+    quality.node_number = n;
+    quality.forward_arcs = static_cast<long long>(preproc_graph.forward_arcs.size());
+    quality.backward_arcs = static_cast<long long>(preproc_graph.backward_arcs.size());
+
+    for (const CHGraph::CHArc &arc : preproc_graph.forward_arcs)
+        quality.shortcuts += (arc.mid_node != -1);
+    for (const CHGraph::CHArc &arc : preproc_graph.backward_arcs)
+        quality.shortcuts += (arc.mid_node != -1);
+
+    for (int v = 0; v < n; ++v)
+    {
+        quality.forward_degree.record(preproc_graph.forward_first_out[v + 1] - preproc_graph.forward_first_out[v]);
+        quality.backward_degree.record(preproc_graph.backward_first_out[v + 1] - preproc_graph.backward_first_out[v]);
+    }
+
+    // Both graphs only lead to higher ranks, so the depth of a node is known once every higher node has one
+    std::vector<int> by_rank(n);
+    std::iota(by_rank.begin(), by_rank.end(), 0);
+    std::sort(by_rank.begin(), by_rank.end(), [&](const int a, const int b) { return preproc_graph.ranks[a] > preproc_graph.ranks[b]; });
+
+    std::vector<int> depth(n, 1);
+    for (const int v : by_rank)
+    {
+        for (int arc = preproc_graph.forward_first_out[v]; arc < preproc_graph.forward_first_out[v + 1]; ++arc)
+            depth[v] = std::max(depth[v], depth[preproc_graph.forward_arcs[arc].to] + 1);
+        for (int arc = preproc_graph.backward_first_out[v]; arc < preproc_graph.backward_first_out[v + 1]; ++arc)
+            depth[v] = std::max(depth[v], depth[preproc_graph.backward_arcs[arc].to] + 1);
+        quality.depth.record(depth[v]);
+    }
+
+    std::vector<int> sample(n);
+    std::iota(sample.begin(), sample.end(), 0);
+    if (sample_size > 0 && sample_size < n)
+    {
+        std::mt19937 generator(seed);
+        std::shuffle(sample.begin(), sample.end(), generator);
+        sample.resize(sample_size);
+        std::sort(sample.begin(), sample.end());
+    }
+    quality.sampled_nodes = static_cast<int>(sample.size());
+
+    const int chunk_number = std::max(1, std::min(Parallel::thread_number(), quality.sampled_nodes));
+    std::vector<SearchSpaceChunk> chunks(chunk_number);
+
+    Parallel::parallel_for(0, chunk_number, [&](int chunk)
+    {
+        const int begin = static_cast<int>(static_cast<long long>(quality.sampled_nodes) * chunk / chunk_number);
+        const int end = static_cast<int>(static_cast<long long>(quality.sampled_nodes) * (chunk + 1) / chunk_number);
+        std::vector<int> forward_visited(n, -1), backward_visited(n, -1), stack;
+        long long nodes, scanned_arcs;
+
+        for (int ind = begin; ind < end; ++ind)
+        {
+            upward_search_space(preproc_graph.forward_first_out, preproc_graph.forward_arcs, sample[ind],
+                                forward_visited, ind, stack, nodes, scanned_arcs);
+            chunks[chunk].forward_nodes.record(nodes);
+            chunks[chunk].forward_arcs.record(scanned_arcs);
+
+            upward_search_space(preproc_graph.backward_first_out, preproc_graph.backward_arcs, sample[ind],
+                                backward_visited, ind, stack, nodes, scanned_arcs);
+            chunks[chunk].backward_nodes.record(nodes);
+            chunks[chunk].backward_arcs.record(scanned_arcs);
+        }
+    }, 1);
+
+    for (const SearchSpaceChunk &chunk : chunks)
+    {
+        quality.forward_search_space.merge(chunk.forward_nodes);
+        quality.backward_search_space.merge(chunk.backward_nodes);
+        quality.forward_search_arcs.merge(chunk.forward_arcs);
+        quality.backward_search_arcs.merge(chunk.backward_arcs);
+    }
+}
@@ -1,14 +1,40 @@
 #include "experiment.hpp"
 #include <stdexcept>
+#include <string>
+#include <vector>
+
+
+const std::string REBUILD_GRAPH_CACHE_OPTION = "--rebuild-graph-cache";
+const std::string TSC_TIMER_OPTION = "--tsc-timer";
+const std::string PERF_COUNTERS_OPTION = "--perf-counters";
+
 
 int main(int argc, char *argv[])
 {
-    if (argc != 5)
+    std::vector<std::string> arguments;
+    bool rebuild_graph_cache = false;
+    TimerBackend timer_backend = TimerBackend::CHRONO;
+    bool count_events = false;
+
+    for (int ind = 1; ind < argc; ++ind)
+    {
+        if (argv[ind] == REBUILD_GRAPH_CACHE_OPTION)
+            rebuild_graph_cache = true;
+        else if (argv[ind] == TSC_TIMER_OPTION)
+            timer_backend = TimerBackend::TSC;
+        else if (argv[ind] == PERF_COUNTERS_OPTION)
+            count_events = true;
+        else
+            arguments.push_back(argv[ind]);
+    }
+
+    if (arguments.size() != 4 && arguments.size() != 5)
     {
         throw std::invalid_argument(
-            "Program should be invoked in the following way: ./experiment.exe graph_file destinations_file output_file run_number");
+            "Program should be invoked in the following way: ./experiment.exe [--rebuild-graph-cache] [--tsc-timer] [--perf-counters] graph_file destinations_file output_file run_number [preproc_file]");
     }
 
-    Experiment::run(argv[1], argv[2], argv[3], std::stoi(argv[4]));
+    Experiment::run(arguments[0], arguments[1], arguments[2], std::stoi(arguments[3]),
+                    arguments.size() == 5 ? arguments[4] : "", rebuild_graph_cache, timer_backend, count_events);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,144 @@
+#include "measurement.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+
+constexpr int HISTOGRAM_PRECISION_BITS = 8;
+constexpr long long HISTOGRAM_SUB_BUCKET_NUMBER = 1LL << HISTOGRAM_PRECISION_BITS;
+constexpr long long HISTOGRAM_HALF_BUCKET_NUMBER = HISTOGRAM_SUB_BUCKET_NUMBER / 2;
+// Largest index belongs to values with their highest bit at position 62
+constexpr long long HISTOGRAM_BUCKET_NUMBER = (65 - HISTOGRAM_PRECISION_BITS) * HISTOGRAM_HALF_BUCKET_NUMBER;
+
+
+// Values below HISTOGRAM_SUB_BUCKET_NUMBER get their own bucket, larger values share a bucket with
+// the values that agree in their HISTOGRAM_PRECISION_BITS - 1 bits after the highest one
+static long long bucket_index(const TimerTime value)
+{
+    if (value < HISTOGRAM_SUB_BUCKET_NUMBER)
+        return value;
+
+    const int shift = std::bit_width(static_cast<std::uint64_t>(value)) - HISTOGRAM_PRECISION_BITS;
+    return shift * HISTOGRAM_HALF_BUCKET_NUMBER + (value >> shift);
+}
+
+// Largest value that falls into bucket index
+static TimerTime bucket_highest_value(const long long index)
+{
+    if (index < HISTOGRAM_SUB_BUCKET_NUMBER)
+        return index;
+
+    const int shift = static_cast<int>(index / HISTOGRAM_HALF_BUCKET_NUMBER - 1);
+    const long long mantissa = index % HISTOGRAM_HALF_BUCKET_NUMBER + HISTOGRAM_HALF_BUCKET_NUMBER;
+    return static_cast<TimerTime>(((static_cast<std::uint64_t>(mantissa) + 1) << shift) - 1);
+}
+
+Histogram::Histogram() : m_counts(HISTOGRAM_BUCKET_NUMBER, 0)
+{
+}
+
+void Histogram::record(const TimerTime value)
+{
+    if (value < 0)
+    {
+        throw std::invalid_argument("Histogram can record only non-negative values");
+    }
+
+    ++m_counts[bucket_index(value)];
+    m_min = (m_count == 0) ? value : std::min(m_min, value);
+    m_max = (m_count == 0) ? value : std::max(m_max, value);
+    m_sum += static_cast<double>(value);
+    ++m_count;
+}
+
+void Histogram::merge(const Histogram &other)
+{
+    if (other.m_count == 0)
+        return;
+
+    for (long long index = 0; index < HISTOGRAM_BUCKET_NUMBER; ++index)
+    {
+        m_counts[index] += other.m_counts[index];
+    }
+    m_min = (m_count == 0) ? other.m_min : std::min(m_min, other.m_min);
+    m_max = (m_count == 0) ? other.m_max : std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+    m_count += other.m_count;
+}
+
+long long Histogram::count() const
+{
+    return m_count;
+}
+
+TimerTime Histogram::min() const
+{
+    return m_min;
+}
+
+TimerTime Histogram::max() const
+{
+    return m_max;
+}
+
+double Histogram::mean() const
+{
+    return (m_count == 0) ? 0.0 : m_sum / m_count;
+}
+
+TimerTime Histogram::value_at_percentile(const double percentile) const
+{
+    if (percentile < 0.0 || percentile > 100.0)
+    {
+        throw std::invalid_argument("Percentile must be in [0, 100]");
+    }
+
+    if (m_count == 0)
+        return 0;
+
+    const long long rank = std::max(1LL, static_cast<long long>(std::ceil(percentile / 100.0 * m_count)));
+    long long seen = 0;
+    for (long long index = 0; index < HISTOGRAM_BUCKET_NUMBER; ++index)
+    {
+        seen += m_counts[index];
+        if (seen >= rank)
+            return std::clamp(bucket_highest_value(index), m_min, m_max);
+    }
+
+    return m_max;
+}
+
+MetricId Measurement::register_metric(const std::string &name)
+{
+    const auto [it, inserted] = metric_ids.emplace(name, static_cast<MetricId>(metric_names.size()));
+    if (inserted)
+    {
+        metric_names.push_back(name);
+        histograms.emplace_back();
+    }
+
+    return it->second;
+}
+
+void Measurement::record(const MetricId metric, const TimerTime value)
+{
+    if (metric < 0 || metric >= static_cast<MetricId>(histograms.size()))
+    {
+        throw std::invalid_argument("Metric id " + std::to_string(metric) + " is not registered");
+    }
+
+    histograms[metric].record(value);
+}
+
+void Measurement::record(const MetricId metric, const Histogram &values)
+{
+    if (metric < 0 || metric >= static_cast<MetricId>(histograms.size()))
+    {
+        throw std::invalid_argument("Metric id " + std::to_string(metric) + " is not registered");
+    }
+
+    histograms[metric].merge(values);
+}
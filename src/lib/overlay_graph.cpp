@@ -0,0 +1,348 @@
+#include "overlay_graph.hpp"
+#include "partition.hpp"
+#include "parallel.hpp"
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <functional>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+
+
+using QItem = std::pair<double, int>;
+using MinQueue = std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>>;
+
+
+// Groups the nodes, entries and exits of every cell and lays out the clique matrices
+static void build_overlay_level(const CHGraph::Graph &graph, std::vector<int> cells, CHGraph::OverlayLevel &level)
+{
+    const int n = static_cast<int>(cells.size());
+
+    level = CHGraph::OverlayLevel{};
+    level.cells = std::move(cells);
+    level.cell_number = n == 0 ? 0 : *std::max_element(level.cells.begin(), level.cells.end()) + 1;
+
+    std::vector<char> is_entry(n, 0), is_exit(n, 0);
+    for (int u = 0; u < n; ++u)
+    {
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+        {
+            const int v = graph.to[e];
+            if (level.cells[u] != level.cells[v])
+            {
+                is_exit[u] = 1;
+                is_entry[v] = 1;
+            }
+        }
+    }
+
+    // Counting sort of the nodes by cell, selected nodes only
+    auto group = [&](const std::vector<char> *selected, std::vector<int> &first, std::vector<int> &grouped, std::vector<int> &index)
+    {
+        first.assign(level.cell_number + 1, 0);
+        index.assign(n, -1);
+        for (int v = 0; v < n; ++v)
+            if (selected == nullptr || (*selected)[v])
+                first[level.cells[v] + 1]++;
+        for (int cell = 0; cell < level.cell_number; ++cell)
+            first[cell + 1] += first[cell];
+
+        grouped.assign(first[level.cell_number], -1);
+        std::vector<int> pos(first.begin(), first.end() - 1);
+        for (int v = 0; v < n; ++v)
+        {
+            if (selected != nullptr && !(*selected)[v])
+                continue;
+            const int cell = level.cells[v];
+            index[v] = pos[cell] - first[cell];
+            grouped[pos[cell]++] = v;
+        }
+    };
+
+    group(nullptr, level.node_first, level.nodes, level.node_index);
+    group(&is_entry, level.entry_first, level.entries, level.entry_index);
+    group(&is_exit, level.exit_first, level.exits, level.exit_index);
+
+    level.clique_first.assign(level.cell_number + 1, 0);
+    for (int cell = 0; cell < level.cell_number; ++cell)
+    {
+        const int entry_count = level.entry_first[cell + 1] - level.entry_first[cell];
+        const int exit_count = level.exit_first[cell + 1] - level.exit_first[cell];
+        level.clique_first[cell + 1] = level.clique_first[cell] + entry_count * exit_count;
+    }
+}
+
+void CHGraph::preproc_overlay_partition(const CHGraph::Graph &graph, const std::vector<int> &cell_numbers,
+                                        CHGraph::OverlayPartition &partition)
+{
+    if (cell_numbers.empty())
+        throw std::invalid_argument("Overlay needs at least one level");
+    for (std::size_t ind = 0; ind < cell_numbers.size(); ++ind)
+    {
+        if (cell_numbers[ind] < 1 || (ind > 0 && cell_numbers[ind] > cell_numbers[ind - 1]))
+            throw std::invalid_argument("Overlay cell numbers should be positive and non increasing from the finest level");
+    }
+
+    const int n = graph.first_out.empty() ? 0 : static_cast<int>(graph.first_out.size()) - 1;
+    const int m = static_cast<int>(graph.to.size());
+
+    partition = CHGraph::OverlayPartition{};
+    partition.levels.resize(cell_numbers.size());
+
+    // The finest level partitions the graph, every coarser level partitions the cell graph of the level below
+    std::vector<int> cells;
+    CHGraph::partition_graph(graph, cell_numbers[0], cells);
+    build_overlay_level(graph, cells, partition.levels[0]);
+
+    for (std::size_t ind = 1; ind < cell_numbers.size(); ++ind)
+    {
+        const CHGraph::OverlayLevel &lower = partition.levels[ind - 1];
+
+        CHGraph::Graph cell_graph;
+        cell_graph.first_out.assign(lower.cell_number + 1, 0);
+        for (int u = 0; u < n; ++u)
+            for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+                if (lower.cells[u] != lower.cells[graph.to[e]])
+                    cell_graph.first_out[lower.cells[u] + 1]++;
+        for (int cell = 0; cell < lower.cell_number; ++cell)
+            cell_graph.first_out[cell + 1] += cell_graph.first_out[cell];
+
+        cell_graph.to.resize(cell_graph.first_out[lower.cell_number]);
+        cell_graph.weights.assign(cell_graph.to.size(), 1.0);
+        std::vector<int> pos(cell_graph.first_out.begin(), cell_graph.first_out.end() - 1);
+        for (int u = 0; u < n; ++u)
+            for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+                if (lower.cells[u] != lower.cells[graph.to[e]])
+                    cell_graph.to[pos[lower.cells[u]]++] = lower.cells[graph.to[e]];
+
+        std::vector<int> cell_cells;
+        CHGraph::partition_graph(cell_graph, cell_numbers[ind], cell_cells);
+
+        for (int v = 0; v < n; ++v)
+            cells[v] = cell_cells[lower.cells[v]];
+        build_overlay_level(graph, cells, partition.levels[ind]);
+    }
+
+    partition.reverse_first_out.assign(n + 1, 0);
+    partition.reverse_tail.resize(m);
+    partition.reverse_arc.resize(m);
+    for (int v : graph.to)
+        partition.reverse_first_out[v + 1]++;
+    for (int v = 0; v < n; ++v)
+        partition.reverse_first_out[v + 1] += partition.reverse_first_out[v];
+
+    std::vector<int> pos(partition.reverse_first_out.begin(), partition.reverse_first_out.end() - 1);
+    for (int u = 0; u < n; ++u)
+    {
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+        {
+            const int slot = pos[graph.to[e]]++;
+            partition.reverse_tail[slot] = u;
+            partition.reverse_arc[slot] = e;
+        }
+    }
+}
+
+void CHGraph::customize_overlay(const CHGraph::Graph &graph, const CHGraph::OverlayPartition &partition,
+                                const std::vector<double> &weights, CHGraph::OverlayMetric &metric)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const int level_number = static_cast<int>(partition.levels.size());
+
+    metric.weights = weights;
+    metric.cliques.assign(level_number, {});
+
+    for (int level_ind = 0; level_ind < level_number; ++level_ind)
+    {
+        const CHGraph::OverlayLevel &level = partition.levels[level_ind];
+        const CHGraph::OverlayLevel *lower = level_ind > 0 ? &partition.levels[level_ind - 1] : nullptr;
+        const std::vector<double> *lower_clique = level_ind > 0 ? &metric.cliques[level_ind - 1] : nullptr;
+        std::vector<double> &clique = metric.cliques[level_ind];
+        clique.assign(level.clique_first[level.cell_number], INF);
+
+        // Dijkstra from every entry restricted to the cell: on the input graph for the finest
+        // level, on the cliques and cut arcs of the level below otherwise
+        auto customize_cell = [&](int cell)
+        {
+            const int node_offset = level.node_first[cell];
+            const int exit_count = level.exit_first[cell + 1] - level.exit_first[cell];
+            std::vector<double> dist(level.node_first[cell + 1] - node_offset, INF);
+            std::vector<int> reached;
+            MinQueue pq;
+
+            auto relax = [&](int v, double nd)
+            {
+                double &dv = dist[level.node_index[v]];
+                if (nd < dv)
+                {
+                    if (dv == INF)
+                        reached.push_back(v);
+                    dv = nd;
+                    pq.push(QItem(nd, v));
+                }
+            };
+
+            for (int entry_ind = 0; entry_ind < level.entry_first[cell + 1] - level.entry_first[cell]; ++entry_ind)
+            {
+                for (int v : reached)
+                    dist[level.node_index[v]] = INF;
+                reached.clear();
+
+                relax(level.entries[level.entry_first[cell] + entry_ind], 0.0);
+
+                while (!pq.empty())
+                {
+                    auto [d, u] = pq.top();
+                    pq.pop();
+                    if (d > dist[level.node_index[u]])
+                        continue;
+
+                    if (lower == nullptr)
+                    {
+                        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+                            if (level.cells[graph.to[e]] == cell)
+                                relax(graph.to[e], d + weights[e]);
+                        continue;
+                    }
+
+                    const int lower_cell = lower->cells[u];
+                    if (lower->entry_index[u] != -1)
+                    {
+                        const int lower_exit_count = lower->exit_first[lower_cell + 1] - lower->exit_first[lower_cell];
+                        const int row = lower->clique_first[lower_cell] + lower->entry_index[u] * lower_exit_count;
+                        for (int exit_ind = 0; exit_ind < lower_exit_count; ++exit_ind)
+                            relax(lower->exits[lower->exit_first[lower_cell] + exit_ind], d + (*lower_clique)[row + exit_ind]);
+                    }
+                    if (lower->exit_index[u] != -1)
+                    {
+                        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+                        {
+                            const int v = graph.to[e];
+                            if (lower->cells[v] != lower_cell && level.cells[v] == cell)
+                                relax(v, d + weights[e]);
+                        }
+                    }
+                }
+
+                const int row = level.clique_first[cell] + entry_ind * exit_count;
+                for (int exit_ind = 0; exit_ind < exit_count; ++exit_ind)
+                    clique[row + exit_ind] = dist[level.node_index[level.exits[level.exit_first[cell] + exit_ind]]];
+            }
+        };
+
+        Parallel::parallel_for(0, level.cell_number, customize_cell, 1);
+    }
+}
+
+void CHGraph::query_route_overlay(const CHGraph::Graph &graph, const CHGraph::OverlayPartition &partition,
+                                  const CHGraph::OverlayMetric &metric, const CHGraph::Destination &destination,
+                                  CHGraph::Route &route)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const int n = static_cast<int>(partition.reverse_first_out.size()) - 1;
+    const int s = destination.source;
+    const int t = destination.target;
+
+    route.nodes.clear();
+    route.total_weight = INF;
+
+    if (n <= 0 || s < 0 || s >= n || t < 0 || t >= n)
+        return;
+
+    if (s == t)
+    {
+        route.total_weight = 0.0;
+        return;
+    }
+
+    const int level_number = static_cast<int>(partition.levels.size());
+
+    // Nodes are searched on the highest level whose cell contains neither s nor t, 0 is the input graph
+    auto query_level = [&](int v) -> int
+    {
+        for (int level_ind = level_number - 1; level_ind >= 0; --level_ind)
+        {
+            const std::vector<int> &cells = partition.levels[level_ind].cells;
+            if (cells[v] != cells[s] && cells[v] != cells[t])
+                return level_ind + 1;
+        }
+        return 0;
+    };
+
+    std::vector<double> dist_f(n, INF), dist_b(n, INF);
+    MinQueue pqf, pqb;
+    dist_f[s] = 0.0; pqf.push(QItem(0.0, s));
+    dist_b[t] = 0.0; pqb.push(QItem(0.0, t));
+
+    double best_dist = INF;
+
+    auto relax = [&](std::vector<double> &dist, const std::vector<double> &other_dist, MinQueue &pq, int v, double nd)
+    {
+        if (nd < dist[v])
+        {
+            dist[v] = nd;
+            pq.push(QItem(nd, v));
+            if (nd + other_dist[v] < best_dist)
+                best_dist = nd + other_dist[v];
+        }
+    };
+
+    auto top_dist = [&](const MinQueue &pq) -> double { return pq.empty() ? INF : pq.top().first; };
+
+    while (top_dist(pqf) + top_dist(pqb) < best_dist)
+    {
+        const bool do_forward = top_dist(pqf) <= top_dist(pqb);
+        MinQueue &pq = do_forward ? pqf : pqb;
+        std::vector<double> &dist = do_forward ? dist_f : dist_b;
+        const std::vector<double> &other_dist = do_forward ? dist_b : dist_f;
+
+        auto [d, u] = pq.top();
+        pq.pop();
+        if (d > dist[u])
+            continue;
+
+        const int level_ind = query_level(u) - 1;
+        const CHGraph::OverlayLevel *level = level_ind >= 0 ? &partition.levels[level_ind] : nullptr;
+
+        if (do_forward)
+        {
+            if (level != nullptr && level->entry_index[u] != -1)
+            {
+                const int cell = level->cells[u];
+                const int exit_count = level->exit_first[cell + 1] - level->exit_first[cell];
+                const int row = level->clique_first[cell] + level->entry_index[u] * exit_count;
+                for (int exit_ind = 0; exit_ind < exit_count; ++exit_ind)
+                    relax(dist, other_dist, pq, level->exits[level->exit_first[cell] + exit_ind],
+                          d + metric.cliques[level_ind][row + exit_ind]);
+            }
+            for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+            {
+                const int v = graph.to[e];
+                if (level == nullptr || level->cells[v] != level->cells[u])
+                    relax(dist, other_dist, pq, v, d + metric.weights[e]);
+            }
+        }
+        else
+        {
+            if (level != nullptr && level->exit_index[u] != -1)
+            {
+                const int cell = level->cells[u];
+                const int exit_count = level->exit_first[cell + 1] - level->exit_first[cell];
+                const int column = level->clique_first[cell] + level->exit_index[u];
+                for (int entry_ind = 0; entry_ind < level->entry_first[cell + 1] - level->entry_first[cell]; ++entry_ind)
+                    relax(dist, other_dist, pq, level->entries[level->entry_first[cell] + entry_ind],
+                          d + metric.cliques[level_ind][column + entry_ind * exit_count]);
+            }
+            for (int e = partition.reverse_first_out[u]; e < partition.reverse_first_out[u + 1]; ++e)
+            {
+                const int v = partition.reverse_tail[e];
+                if (level == nullptr || level->cells[v] != level->cells[u])
+                    relax(dist, other_dist, pq, v, d + metric.weights[partition.reverse_arc[e]]);
+            }
+        }
+    }
+
+    route.total_weight = best_dist;
+}
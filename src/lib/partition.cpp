@@ -0,0 +1,84 @@
+#include "partition.hpp"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+
+void CHGraph::partition_graph(const CHGraph::Graph &graph, const int cell_number, std::vector<int> &cells)
+{
+    const int n = graph.first_out.empty() ? 0 : static_cast<int>(graph.first_out.size()) - 1;
+    const int INF_DIST = std::numeric_limits<int>::max();
+
+    cells.assign(n, 0);
+    if (n == 0 || cell_number <= 1)
+        return;
+
+    // Cells ignore arc directions
+    std::vector<std::vector<int>> adj(n);
+    for (int u = 0; u < n; ++u)
+    {
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+        {
+            const int v = graph.to[e];
+            if (v == u)
+                continue;
+            adj[u].push_back(v);
+            adj[v].push_back(u);
+        }
+    }
+
+    std::vector<int> dist(n, INF_DIST);
+    std::vector<int> queue;
+    queue.reserve(n);
+
+    // Multi source BFS from seeds, assigning every reached node to the cell of its closest seed
+    auto grow = [&](const std::vector<int> &seeds)
+    {
+        std::fill(dist.begin(), dist.end(), INF_DIST);
+        queue.clear();
+        for (int ind = 0; ind < static_cast<int>(seeds.size()); ++ind)
+        {
+            dist[seeds[ind]] = 0;
+            cells[seeds[ind]] = ind;
+            queue.push_back(seeds[ind]);
+        }
+
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            const int u = queue[head];
+            for (int v : adj[u])
+            {
+                if (dist[v] != INF_DIST)
+                    continue;
+                dist[v] = dist[u] + 1;
+                cells[v] = cells[u];
+                queue.push_back(v);
+            }
+        }
+    };
+
+    // First seed is the node farthest from node 0, every next seed is the node farthest
+    // from all seeds so far, nodes in components without a seed count as farthest
+    std::vector<int> seeds{0};
+    grow(seeds);
+    int farthest = 0;
+    for (int v = 0; v < n; ++v)
+        if (dist[v] != INF_DIST && dist[v] > dist[farthest])
+            farthest = v;
+    seeds[0] = farthest;
+
+    const int seed_number = std::min(cell_number, n);
+    while (static_cast<int>(seeds.size()) < seed_number)
+    {
+        grow(seeds);
+        seeds.push_back(static_cast<int>(std::max_element(dist.begin(), dist.end()) - dist.begin()));
+    }
+
+    grow(seeds);
+
+    // Nodes in components without a seed join the last cell
+    for (int v = 0; v < n; ++v)
+        if (dist[v] == INF_DIST)
+            cells[v] = seed_number - 1;
+}
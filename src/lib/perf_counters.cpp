@@ -0,0 +1,175 @@
+#include "perf_counters.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+#ifdef __linux__
+struct PerfEventConfig
+{
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+// Indexed by PerfEvent
+static const PerfEventConfig PERF_EVENT_CONFIGS[PERF_EVENT_NUMBER] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}};
+
+// value, time_enabled, time_running, summed over the exited threads the event was inherited by
+static void read_event(const int fd, std::array<std::uint64_t, 3> &values)
+{
+    if (read(fd, values.data(), sizeof(std::uint64_t) * values.size()) != static_cast<ssize_t>(sizeof(std::uint64_t) * values.size()))
+    {
+        throw std::runtime_error("Can not read perf counters");
+    }
+}
+
+static int open_event(const PerfEventConfig &event)
+{
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    // enabled explicitly around every region, threads started meanwhile count into it
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+#endif
+
+PerfCounters::PerfCounters()
+{
+    m_fds.fill(-1);
+    m_start_values.fill({0, 0, 0});
+    m_results.fill(0);
+
+#ifdef __linux__
+    for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+        m_fds[event] = open_event(PERF_EVENT_CONFIGS[event]);
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#ifdef __linux__
+    for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+    {
+        if (m_fds[event] != -1)
+            close(m_fds[event]);
+    }
+#endif
+}
+
+bool PerfCounters::available() const
+{
+    for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+    {
+        if (m_fds[event] != -1)
+            return true;
+    }
+    return false;
+}
+
+bool PerfCounters::available(const PerfEvent event) const
+{
+    return m_fds[static_cast<int>(event)] != -1;
+}
+
+void PerfCounters::start()
+{
+    if (m_running)
+    {
+        throw std::runtime_error("Can start perf counters only when they are stopped");
+    }
+
+    m_running = true;
+#ifdef __linux__
+    for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+    {
+        if (m_fds[event] == -1)
+            continue;
+
+        read_event(m_fds[event], m_start_values[event]);
+        ioctl(m_fds[event], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounters::stop()
+{
+#ifdef __linux__
+    for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+    {
+        if (m_fds[event] != -1)
+            ioctl(m_fds[event], PERF_EVENT_IOC_DISABLE, 0);
+    }
+#endif
+
+    if (!m_running)
+    {
+        throw std::runtime_error("Can stop perf counters only when they are running");
+    }
+    m_running = false;
+
+#ifdef __linux__
+    for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+    {
+        if (m_fds[event] == -1)
+            continue;
+
+        std::array<std::uint64_t, 3> values;
+        read_event(m_fds[event], values);
+        for (int ind = 0; ind < 3; ++ind)
+            values[ind] -= m_start_values[event][ind];
+
+        const double scale = (values[2] == 0) ? 0.0 : static_cast<double>(values[1]) / static_cast<double>(values[2]);
+        m_results[event] = std::llround(static_cast<double>(values[0]) * scale);
+    }
+#endif
+}
+
+long long PerfCounters::get_result(const PerfEvent event) const
+{
+    if (!available(event))
+    {
+        throw std::runtime_error(std::string("Perf counter ") + event_name(event) + " is not available");
+    }
+
+    return m_results[static_cast<int>(event)];
+}
+
+const char *PerfCounters::event_name(const PerfEvent event)
+{
+    switch (event)
+    {
+    case PerfEvent::CYCLES:
+        return "cycles";
+    case PerfEvent::INSTRUCTIONS:
+        return "instructions";
+    case PerfEvent::L1D_READ_MISSES:
+        return "l1d_read_misses";
+    case PerfEvent::LLC_MISSES:
+        return "llc_misses";
+    case PerfEvent::BRANCH_MISSES:
+        return "branch_misses";
+    }
+
+    return "unknown";
+}
@@ -32,4 +32,43 @@ bool stall_backward(int v, const std::vector<double>& dist_b, const CHGraph::Pre
     return false;
 }
 
+// Mid node of the lightest arc with head `to` in arcs[first, last), -1 for original arcs
+static int lightest_mid_node(const std::vector<CHArc> &arcs, int first, int last, int to) {
+    int mid_node = -1;
+    double weight = std::numeric_limits<double>::infinity();
+    for (int e = first; e < last; ++e) {
+        if (arcs[e].to == to && arcs[e].weight < weight) {
+            weight = arcs[e].weight;
+            mid_node = arcs[e].mid_node;
+        }
+    }
+    return mid_node;
+}
+
+void unpack_arc(const CHGraph::PreprocGraph& preproc_graph, int from, int to, int mid_node, std::vector<int>& nodes) {
+    struct Item {
+        int from;
+        int to;
+        int mid_node;
+    };
+
+    // Shortcut from -> to via m is replaced by from -> m (stored as backward arc at m) and m -> to (forward arc at m)
+    std::vector<Item> stack{Item{from, to, mid_node}};
+    while (!stack.empty()) {
+        const Item item = stack.back();
+        stack.pop_back();
+
+        if (item.mid_node < 0) {
+            nodes.push_back(item.to);
+            continue;
+        }
+
+        const int m = item.mid_node;
+        stack.push_back(Item{m, item.to, lightest_mid_node(preproc_graph.forward_arcs,
+            preproc_graph.forward_first_out[m], preproc_graph.forward_first_out[m + 1], item.to)});
+        stack.push_back(Item{item.from, m, lightest_mid_node(preproc_graph.backward_arcs,
+            preproc_graph.backward_first_out[m], preproc_graph.backward_first_out[m + 1], item.from)});
+    }
+}
+
 } // namespace CHGraph
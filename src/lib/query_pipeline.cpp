@@ -0,0 +1,142 @@
+#include "query_pipeline.hpp"
+#include "parallel.hpp"
+#include "trace.hpp"
+
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <semaphore>
+#include <exception>
+#include <utility>
+#include <algorithm>
+
+
+struct DestinationBatch
+{
+    std::size_t index = 0;
+    std::vector<CHGraph::Destination> destinations;
+};
+
+struct ResultBatch
+{
+    std::size_t index = 0;
+    std::vector<CHGraph::QueryResult> results;
+};
+
+void CHGraph::run_query_pipeline(const CHGraph::DestinationSource &source, const CHGraph::QueryFunction &query,
+                                 const CHGraph::ResultSink &sink, const CHGraph::QueryPipelineOptions &options)
+{
+    const std::size_t max_batches_in_flight = std::max<std::size_t>(1, options.max_batches_in_flight);
+    const int worker_number = std::max(1, options.worker_number);
+
+    // A slot is taken when a batch is read and given back once the sink received it, this bounds
+    // the memory of both queues and of the batches waiting for their turn in the writer
+    std::counting_semaphore<> free_slots(static_cast<std::ptrdiff_t>(max_batches_in_flight));
+    Parallel::BoundedQueue<DestinationBatch> input_queue(max_batches_in_flight);
+    Parallel::BoundedQueue<ResultBatch> output_queue(max_batches_in_flight);
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    std::atomic<bool> failed = false;
+
+    auto record_error = [&]()
+    {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+            error = std::current_exception();
+        failed = true;
+    };
+
+    // Batches of a failed pipeline still pass through so that their slots are given back
+    auto work = [&]()
+    {
+        DestinationBatch batch;
+        while (input_queue.pop(batch))
+        {
+            TRACE_SCOPE("query_batch");
+            ResultBatch result_batch{.index = batch.index};
+            if (!failed)
+            {
+                try
+                {
+                    result_batch.results.reserve(batch.destinations.size());
+                    for (const CHGraph::Destination &destination : batch.destinations)
+                    {
+                        TRACE_SCOPE("query");
+                        CHGraph::Route route;
+                        query(destination, route);
+                        result_batch.results.push_back(CHGraph::QueryResult{.destination = destination, .total_weight = route.total_weight});
+                    }
+                }
+                catch (...)
+                {
+                    record_error();
+                }
+            }
+            output_queue.push(std::move(result_batch));
+        }
+    };
+
+    auto write = [&]()
+    {
+        std::map<std::size_t, std::vector<CHGraph::QueryResult>> waiting;
+        std::size_t next_index = 0;
+        ResultBatch result_batch;
+
+        while (output_queue.pop(result_batch))
+        {
+            waiting.emplace(result_batch.index, std::move(result_batch.results));
+
+            for (auto it = waiting.find(next_index); it != waiting.end(); it = waiting.find(next_index))
+            {
+                if (!failed)
+                {
+                    try
+                    {
+                        sink(it->second);
+                    }
+                    catch (...)
+                    {
+                        record_error();
+                    }
+                }
+                waiting.erase(it);
+                ++next_index;
+                free_slots.release();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(worker_number);
+    for (int ind = 0; ind < worker_number; ++ind)
+        workers.emplace_back(work);
+    std::thread writer(write);
+
+    try
+    {
+        for (std::size_t index = 0;; ++index)
+        {
+            free_slots.acquire();
+            DestinationBatch batch{.index = index};
+            if (failed || !source(batch.destinations))
+                break;
+            input_queue.push(std::move(batch));
+        }
+    }
+    catch (...)
+    {
+        record_error();
+    }
+
+    input_queue.close();
+    for (std::thread &worker : workers)
+        worker.join();
+    output_queue.close();
+    writer.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
@@ -0,0 +1,114 @@
+#include "ch_graph.hpp"
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+
+void CHGraph::compute_components(const CHGraph::Graph &graph, CHGraph::PreprocGraph &preproc_graph)
+{
+    const double INF = std::numeric_limits<double>::infinity();
+    const int n = graph.first_out.empty() ? 0 : static_cast<int>(graph.first_out.size()) - 1;
+
+    std::vector<int> &components = preproc_graph.components;
+    components.assign(n, -1);
+    preproc_graph.component_reachability.clear();
+
+    // Iterative Tarjan, a component is finished only after all components it reaches, which gives
+    // arcs between components decreasing ids
+    std::vector<int> index(n, -1), low(n, 0), next_arc(n, 0);
+    std::vector<int> node_stack, call_stack;
+    int next_index = 0;
+    int component_number = 0;
+
+    auto visit = [&](const int v)
+    {
+        index[v] = low[v] = next_index++;
+        next_arc[v] = graph.first_out[v];
+        node_stack.push_back(v);
+        call_stack.push_back(v);
+    };
+
+    for (int root = 0; root < n; ++root)
+    {
+        if (index[root] != -1)
+            continue;
+
+        visit(root);
+        while (!call_stack.empty())
+        {
+            const int v = call_stack.back();
+            if (next_arc[v] < graph.first_out[v + 1])
+            {
+                const int e = next_arc[v]++;
+                if (!(graph.weights[e] < INF))
+                    continue;
+
+                const int w = graph.to[e];
+                if (index[w] == -1)
+                    visit(w);
+                else if (components[w] == -1)
+                    low[v] = std::min(low[v], index[w]);
+                continue;
+            }
+
+            call_stack.pop_back();
+            if (!call_stack.empty())
+                low[call_stack.back()] = std::min(low[call_stack.back()], low[v]);
+
+            if (low[v] == index[v])
+            {
+                int w;
+                do
+                {
+                    w = node_stack.back();
+                    node_stack.pop_back();
+                    components[w] = component_number;
+                } while (w != v);
+                ++component_number;
+            }
+        }
+    }
+    preproc_graph.component_number = component_number;
+
+    if (component_number > MAX_REACHABILITY_COMPONENTS)
+        return;
+
+    // Condensation closure, a component reaches itself and everything its successors reach. Successors
+    // have smaller ids, so their rows are complete when they are merged.
+    std::vector<int> component_first(component_number + 1, 0), component_nodes(n);
+    for (int v = 0; v < n; ++v)
+        ++component_first[components[v] + 1];
+    for (int c = 0; c < component_number; ++c)
+        component_first[c + 1] += component_first[c];
+    std::vector<int> next_node(component_first.begin(), component_first.end() - 1);
+    for (int v = 0; v < n; ++v)
+        component_nodes[next_node[components[v]]++] = v;
+
+    const int words = component_words(component_number);
+    std::vector<std::uint64_t> &reachability = preproc_graph.component_reachability;
+    reachability.assign(static_cast<std::size_t>(component_number) * words, 0);
+    std::vector<int> merged_into(component_number, -1);
+
+    for (int c = 0; c < component_number; ++c)
+    {
+        std::uint64_t *row = reachability.data() + static_cast<std::size_t>(c) * words;
+        row[c / 64] |= std::uint64_t{1} << (c % 64);
+
+        for (int i = component_first[c]; i < component_first[c + 1]; ++i)
+        {
+            const int v = component_nodes[i];
+            for (int e = graph.first_out[v]; e < graph.first_out[v + 1]; ++e)
+            {
+                const int d = components[graph.to[e]];
+                if (d == c || merged_into[d] == c || !(graph.weights[e] < INF))
+                    continue;
+
+                merged_into[d] = c;
+                const std::uint64_t *successor_row = reachability.data() + static_cast<std::size_t>(d) * words;
+                for (int word = 0; word < words; ++word)
+                    row[word] |= successor_row[word];
+            }
+        }
+    }
+}
@@ -1,8 +1,113 @@
 #include "timer.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TIMER_HAS_TSC 1
+#else
+#define TIMER_HAS_TSC 0
+#endif
+
+
+// Busy wait the TSC is compared with steady_clock for
+constexpr ChronoTime TSC_CALIBRATION_TIME = std::chrono::milliseconds(20);
+// Back to back start/stop pairs, the fastest one is the overhead of a measurement
+constexpr int TSC_OVERHEAD_SAMPLES = 1000;
+// CPUID leaf with the advanced power management flags, EDX bit 8 is set for an invariant TSC
+constexpr unsigned int CPUID_POWER_MANAGEMENT_LEAF = 0x80000007;
+constexpr unsigned int INVARIANT_TSC_BIT = 1u << 8;
+
+
+struct TscCalibration
+{
+    double tick_time = 0.0; // nanoseconds per tick
+    std::uint64_t overhead_ticks = 0;
+};
+
+// Earlier instructions finish before the counter is read, later ones do not start before
+static inline std::uint64_t read_tsc_start()
+{
+#if TIMER_HAS_TSC
+    _mm_lfence();
+    const std::uint64_t ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+// rdtscp waits for earlier instructions, the fence keeps later ones behind the read
+static inline std::uint64_t read_tsc_stop()
+{
+#if TIMER_HAS_TSC
+    unsigned int processor;
+    const std::uint64_t ticks = __rdtscp(&processor);
+    _mm_lfence();
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+static TscCalibration calibrate_tsc()
+{
+    TscCalibration calibration;
+
+    const auto clock_start = std::chrono::steady_clock::now();
+    const std::uint64_t ticks_start = read_tsc_start();
+    auto clock_end = clock_start;
+    while (clock_end - clock_start < TSC_CALIBRATION_TIME)
+    {
+        clock_end = std::chrono::steady_clock::now();
+    }
+    const std::uint64_t ticks_end = read_tsc_stop();
+
+    const double elapsed = static_cast<double>(std::chrono::duration_cast<ChronoTime>(clock_end - clock_start).count());
+    calibration.tick_time = elapsed / static_cast<double>(std::max<std::uint64_t>(ticks_end - ticks_start, 1));
+
+    calibration.overhead_ticks = std::numeric_limits<std::uint64_t>::max();
+    for (int ind = 0; ind < TSC_OVERHEAD_SAMPLES; ++ind)
+    {
+        const std::uint64_t start = read_tsc_start();
+        const std::uint64_t end = read_tsc_stop();
+        calibration.overhead_ticks = std::min(calibration.overhead_ticks, end - start);
+    }
+
+    return calibration;
+}
+
+static const TscCalibration &tsc_calibration()
+{
+    static const TscCalibration calibration = calibrate_tsc();
+    return calibration;
+}
+
+Timer::Timer(const TimerBackend backend, const bool count_events) : m_backend(backend)
+{
+    if (count_events)
+    {
+        m_counters = std::make_unique<PerfCounters>();
+    }
+
+    if (m_backend == TimerBackend::TSC)
+    {
+        if (!tsc_available())
+        {
+            throw std::invalid_argument("TSC timer needs an invariant TSC, which this platform does not have");
+        }
+
+        tsc_calibration();
+    }
+}
+
 void Timer::start()
 {
     if (!(m_state == Timer::State::FINISHED || m_state == Timer::State::INITIAL))
@@ -11,13 +116,21 @@ void Timer::start()
     }
 
     m_state = Timer::State::RUNNING;
-    m_start = std::chrono::high_resolution_clock::now();
+    if (m_counters)
+        m_counters->start();
+    if (m_backend == TimerBackend::TSC)
+        m_start_ticks = read_tsc_start();
+    else
+        m_start = std::chrono::high_resolution_clock::now();
 }
 
 void Timer::stop()
 {
     // Save time before checking status in order to collect more accurate measurement
-    m_end = std::chrono::high_resolution_clock::now();
+    if (m_backend == TimerBackend::TSC)
+        m_end_ticks = read_tsc_stop();
+    else
+        m_end = std::chrono::high_resolution_clock::now();
 
     if (!(m_state == Timer::State::RUNNING))
     {
@@ -25,6 +138,8 @@ void Timer::stop()
     }
 
     m_state = Timer::State::FINISHED;
+    if (m_counters)
+        m_counters->stop();
 }
 
 TimerTime Timer::get_result() const
@@ -34,5 +149,42 @@ TimerTime Timer::get_result() const
         throw std::runtime_error("Can collect timer result only in finished state");
     }
 
+    if (m_backend == TimerBackend::TSC)
+    {
+        const TscCalibration &calibration = tsc_calibration();
+        const std::uint64_t ticks = m_end_ticks - m_start_ticks;
+        const std::uint64_t measured = (ticks > calibration.overhead_ticks) ? ticks - calibration.overhead_ticks : 0;
+        return std::llround(static_cast<double>(measured) * calibration.tick_time);
+    }
+
     return std::chrono::duration_cast<ChronoTime>(m_end - m_start).count();
-}
\ No newline at end of file
+}
+
+const PerfCounters *Timer::counters() const
+{
+    return (m_counters && m_counters->available()) ? m_counters.get() : nullptr;
+}
+
+// Without an invariant TSC the tick rate follows frequency changes and the counters of
+// different cores drift apart, so ticks can not be converted to time
+bool Timer::tsc_available()
+{
+#if TIMER_HAS_TSC
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(CPUID_POWER_MANAGEMENT_LEAF, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (edx & INVARIANT_TSC_BIT) != 0;
+#else
+    return false;
+#endif
+}
+
+double Timer::tsc_tick_time()
+{
+    if (!tsc_available())
+    {
+        throw std::runtime_error("TSC timer needs an invariant TSC, which this platform does not have");
+    }
+
+    return tsc_calibration().tick_time;
+}
@@ -0,0 +1,180 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+
+struct TraceEvent
+{
+    const char *name;
+    std::int64_t begin;    // nanoseconds since the trace started
+    std::int64_t duration; // nanoseconds
+};
+
+// Written only by its thread, read by flush
+struct ThreadBuffer
+{
+    int thread_id = 0;
+    unsigned session = 0;
+    std::vector<TraceEvent> events;
+    std::size_t next = 0; // slot of the next event
+    std::size_t size = 0; // valid events, at most events.size()
+};
+
+static std::mutex trace_mutex;
+static std::atomic<bool> trace_enabled = false;
+static std::atomic<unsigned> trace_session = 0;
+static std::string trace_output_file;
+static std::size_t trace_buffer_events = Trace::DEFAULT_BUFFER_EVENTS;
+static Trace::Clock::time_point trace_origin;
+static std::vector<std::shared_ptr<ThreadBuffer>> trace_buffers;
+static std::set<std::string> trace_names;
+
+// Buffers outlive their threads in trace_buffers, a buffer of an earlier session is replaced
+static thread_local std::shared_ptr<ThreadBuffer> thread_buffer;
+
+
+static ThreadBuffer &current_buffer()
+{
+    const unsigned session = trace_session.load(std::memory_order_acquire);
+    if (!thread_buffer || thread_buffer->session != session)
+    {
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        thread_buffer = std::make_shared<ThreadBuffer>();
+        thread_buffer->thread_id = static_cast<int>(trace_buffers.size()) + 1;
+        thread_buffer->session = session;
+        thread_buffer->events.resize(trace_buffer_events);
+        trace_buffers.push_back(thread_buffer);
+    }
+
+    return *thread_buffer;
+}
+
+static void write_name(std::ofstream &file, const char *name)
+{
+    file << '"';
+    for (const char *c = name; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            file << '\\';
+        file << *c;
+    }
+    file << '"';
+}
+
+static void flush_at_exit()
+{
+    try
+    {
+        Trace::stop();
+    }
+    catch (const std::exception &)
+    {
+    }
+}
+
+void Trace::start(const std::string &output_file, const std::size_t buffer_events)
+{
+    if (buffer_events == 0)
+    {
+        throw std::invalid_argument("Trace buffers need room for at least one event");
+    }
+
+    static std::once_flag exit_handler;
+    std::call_once(exit_handler, []() { std::atexit(flush_at_exit); });
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_output_file = output_file;
+    trace_buffer_events = buffer_events;
+    trace_origin = Clock::now();
+    trace_buffers.clear();
+    trace_session.fetch_add(1, std::memory_order_release);
+    trace_enabled = true;
+}
+
+void Trace::stop()
+{
+    flush();
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    trace_enabled = false;
+    trace_output_file.clear();
+    trace_buffers.clear();
+}
+
+void Trace::flush()
+{
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (trace_output_file.empty())
+        return;
+
+    std::ofstream file(trace_output_file);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Can not open trace file " + trace_output_file);
+    }
+
+    // Chrome expects microseconds
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    bool first = true;
+    for (const std::shared_ptr<ThreadBuffer> &buffer : trace_buffers)
+    {
+        const std::size_t capacity = buffer->events.size();
+        for (std::size_t ind = 0; ind < buffer->size; ++ind)
+        {
+            const TraceEvent &event = buffer->events[(buffer->next + capacity - buffer->size + ind) % capacity];
+            file << (first ? "\n" : ",\n") << "{\"name\":";
+            write_name(file, event.name);
+            file << ",\"cat\":\"ch\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id << ",\"ts\":" << event.begin / 1e3
+                 << ",\"dur\":" << event.duration / 1e3 << "}";
+            first = false;
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool Trace::enabled()
+{
+    return trace_enabled.load(std::memory_order_relaxed);
+}
+
+void Trace::record(const char *name, const Clock::time_point begin, const Clock::time_point end)
+{
+    if (!enabled())
+        return;
+
+    ThreadBuffer &buffer = current_buffer();
+    buffer.events[buffer.next] = TraceEvent{
+        .name = name,
+        .begin = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - trace_origin).count(),
+        .duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()};
+    buffer.next = (buffer.next + 1) % buffer.events.size();
+    buffer.size = std::min(buffer.size + 1, buffer.events.size());
+}
+
+const char *Trace::intern(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    return trace_names.insert(name).first->c_str();
+}
+
+Trace::Span::Span(const char *name) : m_name(enabled() ? name : nullptr)
+{
+    if (m_name != nullptr)
+        m_begin = Clock::now();
+}
+
+Trace::Span::~Span()
+{
+    if (m_name != nullptr)
+        record(m_name, m_begin, Clock::now());
+}
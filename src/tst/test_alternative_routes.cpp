@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "ch_graph.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <limits>
+#include <set>
+
+
+// Weight of the path given by route.nodes in the original graph, infinity if an arc is missing
+static double path_weight(const CHGraph::Graph &graph, const std::vector<int> &nodes)
+{
+    double total = 0.0;
+    for (size_t i = 0; i + 1 < nodes.size(); ++i)
+    {
+        double best = std::numeric_limits<double>::infinity();
+        for (int e = graph.first_out[nodes[i]]; e < graph.first_out[nodes[i] + 1]; ++e)
+            if (graph.to[e] == nodes[i + 1] && graph.weights[e] < best)
+                best = graph.weights[e];
+        total += best;
+    }
+    return total;
+}
+
+
+TEST(CHAlternativeRoutes, SameNode)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph p;
+    CHGraph::preproc_graph_top_down(g, p);
+
+    std::vector<CHGraph::Route> routes;
+    CHGraph::query_alternative_routes(g, p, CHGraph::Destination{.source = 1, .target = 1}, 2, routes);
+
+    ASSERT_EQ(routes.size(), 1);
+    EXPECT_EQ(routes[0].total_weight, 0.0);
+    EXPECT_EQ(routes[0].nodes, std::vector<int>{1});
+}
+
+TEST(CHAlternativeRoutes, Unreachable)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph p;
+    CHGraph::preproc_graph_top_down(g, p);
+
+    std::vector<CHGraph::Route> routes;
+    CHGraph::query_alternative_routes(g, p, CHGraph::Destination{.source = 2, .target = 0}, 2, routes);
+
+    ASSERT_EQ(routes.size(), 1);
+    EXPECT_TRUE(std::isinf(routes[0].total_weight));
+}
+
+TEST(CHAlternativeRoutes, ShortestRouteIsUnpacked)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph p;
+    CHGraph::preproc_graph_top_down(g, p);
+
+    std::vector<CHGraph::Route> routes;
+    CHGraph::query_alternative_routes(g, p, CHGraph::Destination{.source = 0, .target = 2}, 2, routes);
+
+    ASSERT_GE(routes.size(), 1);
+    EXPECT_EQ(routes[0].total_weight, 2.0);
+    EXPECT_EQ(routes[0].nodes, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(CHAlternativeRoutesLargeGraph, RoutesAreValidAlternatives)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_rome99.txt", solutions);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+
+    int alternative_number = 0;
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        std::vector<CHGraph::Route> routes;
+        CHGraph::query_alternative_routes(graph, preproc_graph, destinations[i], 2, routes);
+
+        ASSERT_GE(routes.size(), 1);
+        ASSERT_LE(routes.size(), 3);
+        EXPECT_EQ(solutions[i].expected_weight, routes[0].total_weight);
+
+        for (const CHGraph::Route &route : routes)
+        {
+            ASSERT_FALSE(route.nodes.empty());
+            EXPECT_EQ(route.nodes.front(), destinations[i].source);
+            EXPECT_EQ(route.nodes.back(), destinations[i].target);
+            EXPECT_DOUBLE_EQ(path_weight(graph, route.nodes), route.total_weight);
+            EXPECT_GE(route.total_weight, routes[0].total_weight);
+            EXPECT_LE(route.total_weight, 1.25 * routes[0].total_weight);
+
+            std::set<int> unique_nodes(route.nodes.begin(), route.nodes.end());
+            EXPECT_EQ(unique_nodes.size(), route.nodes.size());
+        }
+
+        for (size_t r = 1; r < routes.size(); ++r)
+            EXPECT_NE(routes[r].nodes, routes[0].nodes);
+
+        alternative_number += routes.size() - 1;
+    }
+
+    EXPECT_GT(alternative_number, 0);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "arc_flags.hpp"
+#include "partition.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+
+static auto arc_flags_query(const int cell_number)
+{
+    return [=](const CHGraph::Graph &graph)
+    {
+        CHGraph::PreprocGraph preproc_graph;
+        CHGraph::ArcFlags arc_flags;
+        CHGraph::preproc_graph_top_down(graph, preproc_graph);
+        CHGraph::preproc_arc_flags(graph, preproc_graph, cell_number, arc_flags);
+
+        return [&graph, preproc_graph = std::move(preproc_graph), arc_flags = std::move(arc_flags)](const CHGraph::Destination &destination)
+        {
+            CHGraph::Route route;
+            CHGraph::query_route(graph, preproc_graph, arc_flags, destination, route);
+            return route.total_weight;
+        };
+    };
+}
+
+TEST(Partition, EveryCellIsUsed)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+
+    std::vector<int> cells;
+    CHGraph::partition_graph(graph, 16, cells);
+
+    ASSERT_EQ(cells.size(), graph.first_out.size() - 1);
+    std::vector<int> cell_sizes(16, 0);
+    for (int cell : cells)
+    {
+        ASSERT_GE(cell, 0);
+        ASSERT_LT(cell, 16);
+        cell_sizes[cell]++;
+    }
+    for (int size : cell_sizes)
+        EXPECT_GT(size, 0);
+}
+
+TEST(ArcFlagsPreprocessing, InvalidCellNumberThrows)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::ArcFlags arc_flags;
+    CHGraph::preproc_graph_top_down(g, preproc_graph);
+
+    EXPECT_THROW(CHGraph::preproc_arc_flags(g, preproc_graph, 0, arc_flags), std::invalid_argument);
+    EXPECT_THROW(CHGraph::preproc_arc_flags(g, preproc_graph, CHGraph::MAX_ARC_FLAGS_CELL_NUMBER + 1, arc_flags),
+                 std::invalid_argument);
+}
+
+TEST(ArcFlagsPreprocessing, SingleCellFlagsEveryArc)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::ArcFlags arc_flags;
+    CHGraph::preproc_graph_top_down(g, preproc_graph);
+    CHGraph::preproc_arc_flags(g, preproc_graph, 1, arc_flags);
+
+    ASSERT_EQ(arc_flags.forward_flags.size(), preproc_graph.forward_arcs.size());
+    ASSERT_EQ(arc_flags.backward_flags.size(), preproc_graph.backward_arcs.size());
+    for (std::uint64_t flags : arc_flags.forward_flags)
+        EXPECT_EQ(flags, 1u);
+    for (std::uint64_t flags : arc_flags.backward_flags)
+        EXPECT_EQ(flags, 1u);
+}
+
+TEST(ArcFlagsQuery, SimpleQueryTwoHops)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::ArcFlags arc_flags;
+    CHGraph::preproc_graph_top_down(g, preproc_graph);
+    CHGraph::preproc_arc_flags(g, preproc_graph, 3, arc_flags);
+
+    CHGraph::Route route;
+    CHGraph::query_route(g, preproc_graph, arc_flags, CHGraph::Destination{.source = 0, .target = 2}, route);
+    EXPECT_EQ(route.total_weight, 2.0);
+
+    CHGraph::query_route(g, preproc_graph, arc_flags, CHGraph::Destination{.source = 2, .target = 0}, route);
+    EXPECT_TRUE(std::isinf(route.total_weight));
+}
+
+TEST(ArcFlagsQuery, SearchSpaceDoesNotGrow)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::ArcFlags arc_flags;
+    std::vector<CHGraph::Destination> destinations;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+    CHGraph::preproc_arc_flags(graph, preproc_graph, 16, arc_flags);
+
+    for (const CHGraph::Destination &destination : destinations)
+    {
+        CHGraph::Route plain_route, flags_route;
+        int plain_settled = 0, flags_settled = 0;
+        CHGraph::query_route_search_space(preproc_graph, nullptr, destination, plain_route, plain_settled);
+        CHGraph::query_route_search_space(preproc_graph, &arc_flags, destination, flags_route, flags_settled);
+
+        EXPECT_EQ(plain_route.total_weight, flags_route.total_weight);
+        EXPECT_LE(flags_settled, plain_settled);
+    }
+}
+
+TEST(ArcFlagsQueryLargeGraph, ROME99)
+{
+    expect_solutions_match("tst/graphs/rome99.gr", "tst/destinations/d_rome99.txt",
+                           "tst/graph_solutions/formatted_rome99.txt", arc_flags_query(32));
+}
+
+TEST(ArcFlagsQueryLargeGraph, GRAPH_1000_2000)
+{
+    expect_solutions_match("tst/graphs/graph_1000_2000.gr", "tst/destinations/d_1000_100.txt",
+                           "tst/graph_solutions/formatted_1000_2000.txt", arc_flags_query(64));
+}
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include "cch_graph.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <limits>
+
+
+TEST(CCHPreprocessing, RanksArePermutation)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+
+    CHGraph::CCHTopology topology;
+    CHGraph::preproc_graph_cch(graph, topology);
+
+    const int n = (int)topology.ranks.size();
+    ASSERT_EQ(n, (int)graph.first_out.size() - 1);
+
+    std::vector<int> seen(n, 0);
+    for (int r : topology.ranks)
+    {
+        ASSERT_GE(r, 0);
+        ASSERT_LT(r, n);
+        seen[r]++;
+    }
+    for (int i = 0; i < n; ++i)
+        EXPECT_EQ(seen[i], 1);
+}
+
+TEST(CCHPreprocessing, UpwardArcsPointUpward)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+
+    CHGraph::CCHTopology topology;
+    CHGraph::preproc_graph_cch(graph, topology);
+
+    const int n = (int)topology.ranks.size();
+    for (int u = 0; u < n; ++u)
+        for (int a = topology.up_first_out[u]; a < topology.up_first_out[u + 1]; ++a)
+            EXPECT_LT(topology.ranks[u], topology.ranks[topology.up_head[a]]);
+}
+
+TEST(CCHPreprocessing, EveryInputArcIsMapped)
+{
+    CHGraph::Graph graph = make_simple_graph();
+
+    CHGraph::CCHTopology topology;
+    CHGraph::preproc_graph_cch(graph, topology);
+
+    ASSERT_EQ(topology.input_arc.size(), graph.to.size());
+    for (int a : topology.input_arc)
+        EXPECT_GE(a, 0);
+}
+
+TEST(CCHQuery, SimpleQueryTwoHops)
+{
+    CHGraph::Graph graph = make_simple_graph();
+    CHGraph::CCHTopology topology;
+    CHGraph::PreprocGraph preproc_graph;
+
+    CHGraph::preproc_graph_cch(graph, topology);
+    CHGraph::customize_cch(topology, graph.weights, preproc_graph);
+
+    CHGraph::Destination dest{.source = 0, .target = 2};
+    CHGraph::Route route;
+    CHGraph::query_route(graph, preproc_graph, dest, route);
+
+    EXPECT_EQ(route.total_weight, 2.0);
+}
+
+TEST(CCHQuery, SimpleQueryUnreachable)
+{
+    CHGraph::Graph graph = make_simple_graph();
+    CHGraph::CCHTopology topology;
+    CHGraph::PreprocGraph preproc_graph;
+
+    CHGraph::preproc_graph_cch(graph, topology);
+    CHGraph::customize_cch(topology, graph.weights, preproc_graph);
+
+    CHGraph::Destination dest{.source = 2, .target = 0};
+    CHGraph::Route route;
+    CHGraph::query_route(graph, preproc_graph, dest, route);
+
+    EXPECT_TRUE(std::isinf(route.total_weight));
+}
+
+TEST(CCHQueryLargeGraph, AllQueriesMatchSolutions)
+{
+    CHGraph::Graph graph;
+    CHGraph::CCHTopology topology;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_rome99.txt", solutions);
+
+    CHGraph::preproc_graph_cch(graph, topology);
+    CHGraph::customize_cch(topology, graph.weights, preproc_graph);
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        CHGraph::Route route;
+        CHGraph::query_route(graph, preproc_graph, destinations[i], route);
+        EXPECT_EQ(solutions[i].expected_weight, route.total_weight);
+    }
+}
+
+TEST(CCHQueryLargeGraph, GRAPH_1000_2000)
+{
+    CHGraph::Graph graph;
+    CHGraph::CCHTopology topology;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_1000_100.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_1000_2000.txt", solutions);
+
+    CHGraph::preproc_graph_cch(graph, topology);
+    CHGraph::customize_cch(topology, graph.weights, preproc_graph);
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        CHGraph::Route route;
+        CHGraph::query_route(graph, preproc_graph, destinations[i], route);
+        EXPECT_EQ(solutions[i].expected_weight, route.total_weight);
+    }
+}
+
+TEST(CCHQueryLargeGraph, RecustomizationMatchesDijkstra)
+{
+    CHGraph::Graph graph;
+    CHGraph::CCHTopology topology;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+
+    CHGraph::preproc_graph_cch(graph, topology);
+    CHGraph::customize_cch(topology, graph.weights, preproc_graph);
+
+    // New metric: every third arc is slower, every seventh arc is closed
+    std::vector<double> weights = graph.weights;
+    for (size_t e = 0; e < weights.size(); ++e)
+    {
+        if (e % 7 == 0)
+            weights[e] = std::numeric_limits<double>::infinity();
+        else if (e % 3 == 0)
+            weights[e] *= 4.0;
+    }
+
+    CHGraph::customize_cch(topology, weights, preproc_graph);
+
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        double dijkstra_dist = dijkstra_shortest_path(graph, destinations[i].source, destinations[i].target, &weights);
+
+        CHGraph::Route route;
+        CHGraph::query_route(graph, preproc_graph, destinations[i], route);
+
+        EXPECT_EQ(dijkstra_dist, route.total_weight);
+    }
+}
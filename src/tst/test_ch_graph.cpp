@@ -1,73 +1,13 @@
 #include <gtest/gtest.h>
 #include "ch_graph.hpp"
+#include "arc_flags.hpp"
 #include "file_facilities.hpp"
+#include "test_helpers.hpp"
 #include <cmath>
-#include <queue>
 #include <limits>
+#include <stdexcept>
 
 
-// Dijkstra implementation for validation
-static double dijkstra_shortest_path(const CHGraph::Graph &graph, int source, int target)
-{
-    const int n = graph.first_out.size() - 1;
-    
-    if (source < 0 || source >= n || target < 0 || target >= n)
-        return std::numeric_limits<double>::infinity();
-    
-    if (source == target)
-        return 0.0;
-    
-    const double INF = std::numeric_limits<double>::infinity();
-    std::vector<double> dist(n, INF);
-    
-    using QItem = std::pair<double, int>;
-    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
-    
-    dist[source] = 0.0;
-    pq.push(QItem(0.0, source));
-    
-    while (!pq.empty())
-    {
-        auto [d, u] = pq.top();
-        pq.pop();
-        
-        if (d > dist[u])
-            continue;
-        
-        if (u == target)
-            return dist[target];
-        
-        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
-        {
-            int v = graph.to[e];
-            double w = graph.weights[e];
-            double new_dist = d + w;
-            
-            if (new_dist < dist[v])
-            {
-                dist[v] = new_dist;
-                pq.push(QItem(new_dist, v));
-            }
-        }
-    }
-    
-    return dist[target];
-}
-
-
-// simple test graph to be used for test
-static CHGraph::Graph make_simple_graph()
-{
-    CHGraph::Graph g;
-
-    g.first_out = {0, 2, 3, 3};
-    g.to        = {1, 2, 2};
-    g.weights   = {1.0, 3.0, 1.0};
-
- 
-    return g;
-}
-
 TEST(CHPreprocessingBottomUP, ForwardGraphIsUpward)
 {
     CHGraph::Graph g = make_simple_graph();
@@ -482,4 +422,186 @@ TEST(CHQueryLargeGraph, GRAPH_5000_10000)
         double actual = route.total_weight;
         EXPECT_EQ(expected,actual);
     }
-}
\ No newline at end of file
+}
+
+TEST(CHSearchStats, QueryStatsMatchSearchSpace)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    const int n = (int)graph.first_out.size() - 1;
+    for (int i = 0; i < 20; ++i)
+    {
+        CHGraph::Destination dest{.source = (i * 7919) % n, .target = (i * 104729 + 13) % n};
+        CHGraph::Route route, stats_route;
+        CHGraph::QueryStats stats;
+
+        CHGraph::query_route(graph, preproc_graph, dest, route);
+        CHGraph::query_route(graph, preproc_graph, dest, stats_route, stats);
+        EXPECT_EQ(route.total_weight, stats_route.total_weight);
+
+        if (!SEARCH_STATS_ENABLED)
+        {
+            EXPECT_EQ(stats.settled_nodes + stats.stalled_nodes + stats.relaxed_arcs + stats.queue_pushes, 0);
+            continue;
+        }
+
+        EXPECT_GT(stats.settled_nodes, 0);
+        EXPECT_LE(stats.stalled_nodes, stats.settled_nodes);
+        // every settled node was pushed at least once
+        EXPECT_GE(stats.queue_pushes, stats.settled_nodes);
+        EXPECT_LE(stats.queue_pushes, stats.relaxed_arcs + 2);
+
+        CHGraph::Route search_space_route;
+        int settled_nodes = 0;
+        CHGraph::query_route_search_space(preproc_graph, nullptr, dest, search_space_route, settled_nodes);
+        EXPECT_EQ(stats.settled_nodes, settled_nodes);
+    }
+}
+
+TEST(CHSearchStats, PreprocStatsCountShortcuts)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+
+    using Preproc = void (*)(const CHGraph::Graph &, CHGraph::PreprocGraph &, const CHGraph::PreprocOptions &);
+    for (Preproc preproc : {Preproc(&CHGraph::preproc_graph_bottom_up), Preproc(&CHGraph::preproc_graph_top_down)})
+    {
+        CHGraph::PreprocGraph preproc_graph;
+        CHGraph::PreprocStats stats;
+        preproc(graph, preproc_graph, CHGraph::PreprocOptions{.stats = &stats});
+
+        if (!SEARCH_STATS_ENABLED)
+        {
+            EXPECT_EQ(stats.witness_searches + stats.witness_settled_nodes + stats.shortcuts_added, 0);
+            continue;
+        }
+
+        // every counted shortcut is an arc of the hierarchy
+        const long long arc_number = preproc_graph.forward_arcs.size() + preproc_graph.backward_arcs.size();
+        EXPECT_GT(stats.witness_searches, 0);
+        EXPECT_GE(stats.witness_settled_nodes, stats.witness_searches);
+        EXPECT_GT(stats.shortcuts_added, 0);
+        EXPECT_LE(stats.shortcuts_added, arc_number);
+    }
+}
+
+TEST(CHPreprocMonitor, ReportsPhasesAndProgress)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    const int n = (int)graph.first_out.size() - 1;
+
+    using Preproc = void (*)(const CHGraph::Graph &, CHGraph::PreprocGraph &, const CHGraph::PreprocOptions &);
+    for (Preproc preproc : {Preproc(&CHGraph::preproc_graph_bottom_up), Preproc(&CHGraph::preproc_graph_top_down)})
+    {
+        std::vector<CHGraph::PreprocProgress> reports;
+        CHGraph::PreprocMonitor monitor;
+        monitor.progress_interval = ChronoTime(0);
+        monitor.progress = [&](const CHGraph::PreprocProgress &progress) { reports.push_back(progress); };
+
+        CHGraph::PreprocGraph preproc_graph, expected_graph;
+        preproc(graph, preproc_graph, CHGraph::PreprocOptions{.monitor = &monitor});
+        preproc(graph, expected_graph, CHGraph::PreprocOptions{});
+
+        // monitoring does not change the hierarchy
+        EXPECT_EQ(preproc_graph.ranks, expected_graph.ranks);
+        EXPECT_EQ(preproc_graph.forward_arcs.size(), expected_graph.forward_arcs.size());
+
+        for (int phase = 0; phase < CHGraph::PREPROC_PHASE_NUMBER; ++phase)
+            EXPECT_GT(monitor.profile.phase_times[phase], 0) << CHGraph::preproc_phase_name(static_cast<CHGraph::PreprocPhase>(phase));
+        EXPECT_EQ(monitor.profile.contraction_costs.count(), n);
+
+        // one report per contracted node and a final one
+        ASSERT_EQ((int)reports.size(), n + 1);
+        for (size_t i = 1; i < reports.size(); ++i)
+        {
+            EXPECT_GE(reports[i].contracted_nodes, reports[i - 1].contracted_nodes);
+            EXPECT_GE(reports[i].shortcuts, reports[i - 1].shortcuts);
+            EXPECT_GE(reports[i].remaining_arcs, 0);
+        }
+        EXPECT_EQ(reports.back().contracted_nodes, n);
+        EXPECT_EQ(reports.back().node_number, n);
+        EXPECT_EQ(reports.back().remaining_arcs, 0);
+        EXPECT_EQ(reports.back().eta, 0);
+    }
+}
+
+TEST(CHPreprocessingGivenOrder, OwnOrderReproducesHierarchy)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+
+    CHGraph::PreprocGraph bottom_up, bottom_up_ordered, top_down, top_down_ordered;
+    CHGraph::preproc_graph_bottom_up(graph, bottom_up);
+    CHGraph::preproc_graph_bottom_up(graph, bottom_up_ordered, CHGraph::PreprocOptions{.ranks = &bottom_up.ranks});
+    CHGraph::preproc_graph_top_down(graph, top_down);
+    CHGraph::preproc_graph_top_down(graph, top_down_ordered, CHGraph::PreprocOptions{.ranks = &top_down.ranks});
+
+    expect_same_preproc_graph(bottom_up, bottom_up_ordered);
+    expect_same_preproc_graph(top_down, top_down_ordered);
+
+    // The ranks may come from the graph that is overwritten
+    CHGraph::preproc_graph_top_down(graph, top_down_ordered, CHGraph::PreprocOptions{.ranks = &top_down_ordered.ranks});
+    expect_same_preproc_graph(top_down, top_down_ordered);
+}
+
+TEST(CHPreprocessingGivenOrder, OldOrderWithNewWeights)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+
+    CHGraph::PreprocGraph old_graph;
+    CHGraph::preproc_graph_bottom_up(graph, old_graph);
+
+    // Every third arc gets slower
+    for (size_t e = 0; e < graph.weights.size(); e += 3)
+        graph.weights[e] *= 1.5;
+
+    CHGraph::PreprocGraph top_down, bottom_up;
+    CHGraph::preproc_graph_top_down(graph, top_down, CHGraph::PreprocOptions{.ranks = &old_graph.ranks});
+    CHGraph::preproc_graph_bottom_up(graph, bottom_up, CHGraph::PreprocOptions{.ranks = &old_graph.ranks});
+    EXPECT_EQ(top_down.ranks, old_graph.ranks);
+    EXPECT_EQ(bottom_up.ranks, old_graph.ranks);
+
+    const int n = (int)graph.first_out.size() - 1;
+    for (int s = 0; s < n; s += 37)
+    {
+        for (int t = 5; t < n; t += 41)
+        {
+            const double expected = dijkstra_shortest_path(graph, s, t);
+            CHGraph::Route route;
+            CHGraph::query_route(graph, top_down, CHGraph::Destination{.source = s, .target = t}, route);
+            EXPECT_EQ(expected, route.total_weight) << "top down " << s << " -> " << t;
+            CHGraph::query_route(graph, bottom_up, CHGraph::Destination{.source = s, .target = t}, route);
+            EXPECT_EQ(expected, route.total_weight) << "bottom up " << s << " -> " << t;
+        }
+    }
+}
+
+TEST(CHPreprocessingGivenOrder, InvalidOrder)
+{
+    const CHGraph::Graph graph = make_simple_graph();
+    const int n = (int)graph.first_out.size() - 1;
+    CHGraph::PreprocGraph preproc_graph;
+
+    std::vector<int> short_ranks(n - 1);
+    for (int v = 0; v < n - 1; ++v)
+        short_ranks[v] = v;
+    EXPECT_THROW(CHGraph::preproc_graph_bottom_up(graph, preproc_graph, CHGraph::PreprocOptions{.ranks = &short_ranks}), std::invalid_argument);
+    EXPECT_THROW(CHGraph::preproc_graph_top_down(graph, preproc_graph, CHGraph::PreprocOptions{.ranks = &short_ranks}), std::invalid_argument);
+
+    std::vector<int> repeated_ranks(n, 0);
+    EXPECT_THROW(CHGraph::preproc_graph_bottom_up(graph, preproc_graph, CHGraph::PreprocOptions{.ranks = &repeated_ranks}), std::invalid_argument);
+    EXPECT_THROW(CHGraph::preproc_graph_top_down(graph, preproc_graph, CHGraph::PreprocOptions{.ranks = &repeated_ranks}), std::invalid_argument);
+}
+
+TEST(CHPreprocessingTopDown, CoreIsRejected)
+{
+    const CHGraph::Graph graph = make_simple_graph();
+    CHGraph::PreprocGraph preproc_graph;
+
+    EXPECT_THROW(CHGraph::preproc_graph_top_down(graph, preproc_graph, CHGraph::PreprocOptions{.core_size = 1}), std::invalid_argument);
+}
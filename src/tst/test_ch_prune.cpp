@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "ch_graph.hpp"
+#include "file_facilities.hpp"
+#include <limits>
+
+
+// Weight of the path given by route.nodes in the original graph, infinity if an arc is missing
+static double path_weight(const CHGraph::Graph &graph, const std::vector<int> &nodes)
+{
+    double total = 0.0;
+    for (size_t i = 0; i + 1 < nodes.size(); ++i)
+    {
+        double best = std::numeric_limits<double>::infinity();
+        for (int e = graph.first_out[nodes[i]]; e < graph.first_out[nodes[i] + 1]; ++e)
+            if (graph.to[e] == nodes[i + 1] && graph.weights[e] < best)
+                best = graph.weights[e];
+        total += best;
+    }
+    return total;
+}
+
+// Ranks 4 < 0 < 1 < 2 < 3. The shortcut 0 -> 2 via 4 is as heavy as 0 -> 1 -> 2. With parent, the
+// shortcut 3 -> 2 via 0 (a backward arc at 2) needs it for unpacking.
+static CHGraph::PreprocGraph make_simple_hierarchy(const bool parent)
+{
+    CHGraph::PreprocGraph preproc_graph;
+
+    preproc_graph.ranks = {1, 2, 3, 4, 0};
+    preproc_graph.forward_first_out = {0, 2, 3, 3, 3, 4};
+    preproc_graph.forward_arcs = {{0, 1, 1.0, -1}, {0, 2, 2.0, 4}, {1, 2, 1.0, -1}, {4, 2, 1.0, -1}};
+    if (parent)
+    {
+        preproc_graph.backward_first_out = {0, 1, 1, 2, 2, 3};
+        preproc_graph.backward_arcs = {{0, 3, 1.0, -1}, {2, 3, 3.0, 0}, {4, 0, 1.0, -1}};
+    }
+    else
+    {
+        preproc_graph.backward_first_out = {0, 1, 1, 1, 1, 2};
+        preproc_graph.backward_arcs = {{0, 3, 1.0, -1}, {4, 0, 1.0, -1}};
+    }
+
+    return preproc_graph;
+}
+
+TEST(CHPrune, RedundantShortcutIsRemoved)
+{
+    CHGraph::PreprocGraph preproc_graph = make_simple_hierarchy(false);
+
+    EXPECT_EQ(CHGraph::prune_redundant_shortcuts(preproc_graph), 1);
+    EXPECT_EQ(preproc_graph.forward_first_out, (std::vector<int>{0, 1, 2, 2, 2, 3}));
+    ASSERT_EQ(preproc_graph.forward_arcs.size(), 3);
+    EXPECT_EQ(preproc_graph.forward_arcs[0].to, 1);
+    EXPECT_EQ(preproc_graph.forward_arcs[1].from, 1);
+    EXPECT_EQ(preproc_graph.backward_arcs.size(), 2);
+}
+
+TEST(CHPrune, ShortcutNeededForUnpackingIsKept)
+{
+    CHGraph::PreprocGraph preproc_graph = make_simple_hierarchy(true);
+
+    EXPECT_EQ(CHGraph::prune_redundant_shortcuts(preproc_graph), 0);
+    EXPECT_EQ(preproc_graph.forward_arcs.size(), 4);
+    EXPECT_EQ(preproc_graph.backward_arcs.size(), 3);
+}
+
+TEST(CHPrune, OriginalArcsAreKept)
+{
+    CHGraph::PreprocGraph preproc_graph = make_simple_hierarchy(false);
+    preproc_graph.forward_arcs[1].mid_node = -1;
+
+    EXPECT_EQ(CHGraph::prune_redundant_shortcuts(preproc_graph), 0);
+}
+
+TEST(CHPruneLargeGraph, PrunedHierarchyMatchesSolutions)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_rome99.txt", solutions);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    const size_t arc_number = preproc_graph.forward_arcs.size() + preproc_graph.backward_arcs.size();
+    const long long pruned_arcs = CHGraph::prune_redundant_shortcuts(preproc_graph);
+    EXPECT_GT(pruned_arcs, 0);
+    EXPECT_EQ(preproc_graph.forward_arcs.size() + preproc_graph.backward_arcs.size(), arc_number - pruned_arcs);
+    EXPECT_EQ(preproc_graph.forward_first_out.back(), preproc_graph.forward_arcs.size());
+    EXPECT_EQ(preproc_graph.backward_first_out.back(), preproc_graph.backward_arcs.size());
+
+    // Pruning again finds nothing, the remaining shortcuts are needed
+    EXPECT_EQ(CHGraph::prune_redundant_shortcuts(preproc_graph), 0);
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        CHGraph::Route route;
+        CHGraph::query_route(graph, preproc_graph, destinations[i], route);
+        EXPECT_EQ(solutions[i].expected_weight, route.total_weight);
+
+        // Shortcuts still unpack into original paths
+        std::vector<CHGraph::Route> routes;
+        CHGraph::query_alternative_routes(graph, preproc_graph, destinations[i], 0, routes);
+        ASSERT_EQ(routes.size(), 1);
+        EXPECT_EQ(solutions[i].expected_weight, routes[0].total_weight);
+        if (routes[0].total_weight != std::numeric_limits<double>::infinity())
+        {
+            EXPECT_DOUBLE_EQ(path_weight(graph, routes[0].nodes), routes[0].total_weight);
+        }
+    }
+}
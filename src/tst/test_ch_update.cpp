@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "ch_graph.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <limits>
+
+
+static void expect_queries_match_dijkstra(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph,
+                                          const std::vector<CHGraph::Destination> &destinations)
+{
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        double dijkstra_dist = dijkstra_shortest_path(graph, destinations[i].source, destinations[i].target);
+
+        CHGraph::Route route;
+        CHGraph::query_route(graph, preproc_graph, destinations[i], route);
+
+        EXPECT_EQ(dijkstra_dist, route.total_weight);
+    }
+}
+
+
+TEST(CHUpdate, ClosedArcIsAvoided)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph p;
+    CHGraph::preproc_graph_top_down(g, p);
+
+    g.weights[2] = std::numeric_limits<double>::infinity();
+    CHGraph::update_preproc_graph(g, p, {2});
+
+    CHGraph::Destination dest{.source = 0, .target = 2};
+    CHGraph::Route route;
+    CHGraph::query_route(g, p, dest, route);
+
+    EXPECT_EQ(route.total_weight, 3.0);
+}
+
+TEST(CHUpdate, DecreasedArcIsUsed)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph p;
+    CHGraph::preproc_graph_top_down(g, p);
+
+    g.weights[1] = 0.5;
+    CHGraph::update_preproc_graph(g, p, {1});
+
+    CHGraph::Destination dest{.source = 0, .target = 2};
+    CHGraph::Route route;
+    CHGraph::query_route(g, p, dest, route);
+
+    EXPECT_EQ(route.total_weight, 0.5);
+}
+
+TEST(CHUpdate, RanksAreKept)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    const std::vector<int> ranks = preproc_graph.ranks;
+
+    std::vector<int> changed_arcs;
+    for (int e = 0; e < (int)graph.to.size(); e += 97)
+    {
+        graph.weights[e] *= 3.0;
+        changed_arcs.push_back(e);
+    }
+    CHGraph::update_preproc_graph(graph, preproc_graph, changed_arcs);
+
+    EXPECT_EQ(ranks, preproc_graph.ranks);
+
+    for (const auto &arc : preproc_graph.forward_arcs)
+        EXPECT_LT(preproc_graph.ranks[arc.from], preproc_graph.ranks[arc.to]);
+    for (const auto &arc : preproc_graph.backward_arcs)
+        EXPECT_LT(preproc_graph.ranks[arc.from], preproc_graph.ranks[arc.to]);
+}
+
+TEST(CHUpdateLargeGraph, IncreasedWeightsAndClosuresMatchDijkstra)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    std::vector<int> changed_arcs;
+    for (int e = 0; e < (int)graph.to.size(); e += 53)
+    {
+        if (changed_arcs.size() % 2 == 0)
+            graph.weights[e] = std::numeric_limits<double>::infinity();
+        else
+            graph.weights[e] *= 10.0;
+        changed_arcs.push_back(e);
+    }
+    CHGraph::update_preproc_graph(graph, preproc_graph, changed_arcs);
+
+    expect_queries_match_dijkstra(graph, preproc_graph, destinations);
+}
+
+TEST(CHUpdateLargeGraph, DecreasedWeightsMatchDijkstra)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    std::vector<int> changed_arcs;
+    for (int e = 0; e < (int)graph.to.size(); e += 31)
+    {
+        graph.weights[e] = std::floor(graph.weights[e] / 8.0);
+        changed_arcs.push_back(e);
+    }
+    CHGraph::update_preproc_graph(graph, preproc_graph, changed_arcs);
+
+    expect_queries_match_dijkstra(graph, preproc_graph, destinations);
+}
+
+TEST(CHUpdateLargeGraph, ReopeningRestoresSolutions)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_1000_100.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_1000_2000.txt", solutions);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    const std::vector<double> original_weights = graph.weights;
+    std::vector<int> changed_arcs;
+    for (int e = 0; e < (int)graph.to.size(); e += 11)
+    {
+        graph.weights[e] = std::numeric_limits<double>::infinity();
+        changed_arcs.push_back(e);
+    }
+    CHGraph::update_preproc_graph(graph, preproc_graph, changed_arcs);
+    expect_queries_match_dijkstra(graph, preproc_graph, destinations);
+
+    graph.weights = original_weights;
+    CHGraph::update_preproc_graph(graph, preproc_graph, changed_arcs);
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        CHGraph::Route route;
+        CHGraph::query_route(graph, preproc_graph, destinations[i], route);
+        EXPECT_EQ(solutions[i].expected_weight, route.total_weight);
+    }
+}
+
+TEST(CHUpdateLargeGraph, MixedChangesMatchDijkstra)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_1000_100.txt", destinations);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    std::vector<int> changed_arcs;
+    for (int e = 5; e < (int)graph.to.size(); e += 7)
+    {
+        graph.weights[e] = (e % 2 == 0) ? graph.weights[e] * 4.0 : 1.0;
+        changed_arcs.push_back(e);
+    }
+    CHGraph::update_preproc_graph(graph, preproc_graph, changed_arcs);
+
+    expect_queries_match_dijkstra(graph, preproc_graph, destinations);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "chain_compression.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <tuple>
+#include <limits>
+
+
+static void expect_all_pairs_match_dijkstra(const CHGraph::Graph &graph)
+{
+    CHGraph::ChainCompression compression;
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::compress_chains(graph, compression);
+    CHGraph::preproc_graph_top_down(compression.graph, preproc_graph);
+
+    const int n = graph.first_out.size() - 1;
+    for (int s = 0; s < n; ++s)
+    {
+        for (int t = 0; t < n; ++t)
+        {
+            CHGraph::Route route;
+            CHGraph::query_route(compression, preproc_graph, CHGraph::Destination{.source = s, .target = t}, route);
+            EXPECT_EQ(dijkstra_shortest_path(graph, s, t), route.total_weight) << s << " -> " << t;
+        }
+    }
+}
+
+TEST(ChainCompression, TwoWayChain)
+{
+    // 0 <-> 1 <-> 2 <-> 3 with different weights per direction, 3 also leads to 4 and 5
+    const CHGraph::Graph graph = make_graph(6, {{0, 1, 1.0}, {1, 0, 2.0}, {1, 2, 3.0}, {2, 1, 4.0}, {2, 3, 5.0}, {3, 2, 6.0},
+                                                {3, 4, 1.0}, {4, 3, 1.0}, {3, 5, 1.0}, {5, 3, 1.0}});
+    CHGraph::ChainCompression compression;
+    CHGraph::compress_chains(graph, compression);
+
+    EXPECT_EQ(compression.chain_tail, std::vector<int>{0});
+    EXPECT_EQ(compression.chain_head, std::vector<int>{3});
+    EXPECT_EQ(compression.chain_nodes, (std::vector<int>{1, 2}));
+    EXPECT_EQ(compression.from_tail, (std::vector<double>{1.0, 4.0}));
+    EXPECT_EQ(compression.to_head, (std::vector<double>{8.0, 5.0}));
+    EXPECT_EQ(compression.to_tail, (std::vector<double>{2.0, 6.0}));
+    EXPECT_EQ(compression.from_head, (std::vector<double>{10.0, 6.0}));
+    EXPECT_EQ(compression.mapping.to_original, (std::vector<int>{0, 3, 4, 5}));
+
+    // chain arcs 0 -> 3 and 3 -> 0
+    EXPECT_EQ(compression.graph.first_out[1], 1);
+    EXPECT_EQ(compression.graph.weights[0], 9.0);
+
+    expect_all_pairs_match_dijkstra(graph);
+}
+
+TEST(ChainCompression, OneWayChain)
+{
+    // 0 -> 1 -> 2 -> 3 and back directly, 0 and 3 have a further neighbour each
+    const CHGraph::Graph graph = make_graph(6, {{0, 1, 1.0}, {1, 2, 1.0}, {2, 3, 1.0}, {3, 0, 10.0},
+                                                {0, 4, 1.0}, {4, 0, 1.0}, {3, 5, 1.0}, {5, 3, 1.0}});
+    CHGraph::ChainCompression compression;
+    CHGraph::compress_chains(graph, compression);
+
+    EXPECT_EQ(compression.chain_nodes, (std::vector<int>{1, 2}));
+    EXPECT_EQ(compression.to_tail[0], std::numeric_limits<double>::infinity());
+    EXPECT_EQ(compression.graph.first_out.size(), 5);
+
+    expect_all_pairs_match_dijkstra(graph);
+}
+
+TEST(ChainCompression, ChainClosingACycleIsKept)
+{
+    // 0 -> 1 -> 2 -> 3 -> 0 starts and ends at 0
+    const CHGraph::Graph graph = make_graph(5, {{0, 1, 1.0}, {1, 2, 1.0}, {2, 3, 1.0}, {3, 0, 10.0}, {0, 4, 1.0}, {4, 0, 1.0}});
+    CHGraph::ChainCompression compression;
+    CHGraph::compress_chains(graph, compression);
+
+    EXPECT_TRUE(compression.chain_nodes.empty());
+    EXPECT_EQ(compression.graph.to.size(), graph.to.size());
+
+    expect_all_pairs_match_dijkstra(graph);
+}
+
+TEST(ChainCompressionLargeGraph, CompressedGraphMatchesSolutions)
+{
+    CHGraph::Graph graph;
+    CHGraph::ChainCompression compression;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_rome99.txt", solutions);
+    CHGraph::compress_chains(graph, compression);
+    CHGraph::preproc_graph_top_down(compression.graph, preproc_graph);
+
+    EXPECT_LT(compression.graph.first_out.size(), graph.first_out.size());
+    EXPECT_EQ(compression.chain_nodes.size() + compression.mapping.to_original.size() + 1, graph.first_out.size());
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        CHGraph::Route route;
+        CHGraph::query_route(compression, preproc_graph, destinations[i], route);
+        EXPECT_EQ(solutions[i].expected_weight, route.total_weight);
+    }
+
+    // End points inside chains, also both in the same chain
+    for (size_t i = 0; i + 1 < compression.chain_nodes.size() && i < 200; i += 7)
+    {
+        const int s = compression.chain_nodes[i];
+        for (const int t : {compression.chain_nodes[i + 1], destinations[i % destinations.size()].target})
+        {
+            CHGraph::Route route, back;
+            CHGraph::query_route(compression, preproc_graph, CHGraph::Destination{.source = s, .target = t}, route);
+            CHGraph::query_route(compression, preproc_graph, CHGraph::Destination{.source = t, .target = s}, back);
+            EXPECT_EQ(dijkstra_shortest_path(graph, s, t), route.total_weight);
+            EXPECT_EQ(dijkstra_shortest_path(graph, t, s), back.total_weight);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "compressed_graph.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <utility>
+
+
+static std::vector<std::pair<int, double>> compressed_arcs_of(const CHGraph::CompressedArcs &arcs, int node)
+{
+    std::vector<std::pair<int, double>> result;
+    CHGraph::for_each_compressed_arc(arcs, node, [&](int head, double weight) { result.emplace_back(head, weight); });
+    return result;
+}
+
+// Queries the compressed hierarchy and checks that Dijkstra on the plain and the compressed graph agree
+static auto compressed_query(const CHGraph::Graph &graph)
+{
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    CHGraph::CompressedGraph compressed_graph;
+    CHGraph::CompressedPreprocGraph compressed_preproc_graph;
+    CHGraph::compress_graph(graph, compressed_graph);
+    CHGraph::compress_preproc_graph(preproc_graph, compressed_preproc_graph);
+
+    EXPECT_LT(CHGraph::compressed_arcs_memory(compressed_graph.arcs), CHGraph::graph_memory(graph));
+    EXPECT_LT(CHGraph::compressed_arcs_memory(compressed_preproc_graph.forward_arcs) +
+              CHGraph::compressed_arcs_memory(compressed_preproc_graph.backward_arcs),
+              CHGraph::preproc_graph_memory(preproc_graph));
+
+    return [&graph, compressed_graph = std::move(compressed_graph),
+            compressed_preproc_graph = std::move(compressed_preproc_graph)](const CHGraph::Destination &destination)
+    {
+        CHGraph::Route route, dijkstra_route, compressed_dijkstra_route;
+        CHGraph::query_route(compressed_preproc_graph, destination, route);
+        CHGraph::query_route_dijkstra(graph, destination, dijkstra_route);
+        CHGraph::query_route_dijkstra(compressed_graph, destination, compressed_dijkstra_route);
+
+        EXPECT_EQ(route.total_weight, dijkstra_route.total_weight);
+        EXPECT_EQ(route.total_weight, compressed_dijkstra_route.total_weight);
+        return route.total_weight;
+    };
+}
+
+TEST(CompressedArcs, DecodesSortedArcs)
+{
+    CHGraph::Graph g;
+    g.first_out = {0, 3, 3, 5, 6, 6};
+    g.to        = {4, 0, 2, 1, 0, 3};
+    g.weights   = {7.0, 0.0, 1000000.0, 3.0, 5.0, 1.0};
+
+    CHGraph::CompressedGraph compressed;
+    CHGraph::compress_graph(g, compressed);
+
+    EXPECT_TRUE(compressed.arcs.packed_weights);
+    EXPECT_EQ(compressed.arcs.weight_bits, 20);
+
+    using Arcs = std::vector<std::pair<int, double>>;
+    EXPECT_EQ(compressed_arcs_of(compressed.arcs, 0), (Arcs{{0, 0.0}, {2, 1000000.0}, {4, 7.0}}));
+    EXPECT_EQ(compressed_arcs_of(compressed.arcs, 1), Arcs{});
+    EXPECT_EQ(compressed_arcs_of(compressed.arcs, 2), (Arcs{{0, 5.0}, {1, 3.0}}));
+    EXPECT_EQ(compressed_arcs_of(compressed.arcs, 3), (Arcs{{3, 1.0}}));
+}
+
+TEST(CompressedArcs, FractionalWeightsStayRaw)
+{
+    CHGraph::Graph g = make_simple_graph();
+    g.weights[1] = 2.5;
+
+    CHGraph::CompressedGraph compressed;
+    CHGraph::compress_graph(g, compressed);
+
+    EXPECT_FALSE(compressed.arcs.packed_weights);
+    using Arcs = std::vector<std::pair<int, double>>;
+    EXPECT_EQ(compressed_arcs_of(compressed.arcs, 0), (Arcs{{1, 1.0}, {2, 2.5}}));
+}
+
+TEST(CompressedQuery, SimpleQueryTwoHops)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::CompressedPreprocGraph compressed;
+    CHGraph::preproc_graph_top_down(g, preproc_graph);
+    CHGraph::compress_preproc_graph(preproc_graph, compressed);
+
+    CHGraph::Route route;
+    CHGraph::query_route(compressed, CHGraph::Destination{.source = 0, .target = 2}, route);
+
+    EXPECT_EQ(route.total_weight, 2.0);
+}
+
+TEST(CompressedQuery, SimpleQueryUnreachable)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::CompressedPreprocGraph compressed_preproc_graph;
+    CHGraph::CompressedGraph compressed_graph;
+    CHGraph::preproc_graph_top_down(g, preproc_graph);
+    CHGraph::compress_preproc_graph(preproc_graph, compressed_preproc_graph);
+    CHGraph::compress_graph(g, compressed_graph);
+
+    CHGraph::Route route, dijkstra_route;
+    CHGraph::query_route(compressed_preproc_graph, CHGraph::Destination{.source = 2, .target = 0}, route);
+    CHGraph::query_route_dijkstra(compressed_graph, CHGraph::Destination{.source = 2, .target = 0}, dijkstra_route);
+
+    EXPECT_TRUE(std::isinf(route.total_weight));
+    EXPECT_TRUE(std::isinf(dijkstra_route.total_weight));
+}
+
+TEST(CompressedQueryLargeGraph, ROME99)
+{
+    expect_solutions_match("tst/graphs/rome99.gr", "tst/destinations/d_rome99.txt",
+                           "tst/graph_solutions/formatted_rome99.txt", compressed_query);
+}
+
+TEST(CompressedQueryLargeGraph, GRAPH_1000_2000)
+{
+    expect_solutions_match("tst/graphs/graph_1000_2000.gr", "tst/destinations/d_1000_100.txt",
+                           "tst/graph_solutions/formatted_1000_2000.txt", compressed_query);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "core_alt.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <limits>
+#include <utility>
+
+
+static auto core_alt_query(const int core_size, const int landmark_number)
+{
+    return [=](const CHGraph::Graph &graph)
+    {
+        CHGraph::CoreALTGraph core_graph;
+        CHGraph::preproc_graph_core_alt(graph, core_size, landmark_number, core_graph);
+
+        return [core_graph = std::move(core_graph)](const CHGraph::Destination &destination)
+        {
+            CHGraph::Route route;
+            CHGraph::query_route_core_alt(core_graph, destination, route);
+            return route.total_weight;
+        };
+    };
+}
+
+TEST(CoreALTPreprocessing, CoreHasRequestedSize)
+{
+    CHGraph::Graph graph;
+    CHGraph::CoreALTGraph core_graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+
+    CHGraph::preproc_graph_core_alt(graph, 300, 8, core_graph);
+
+    int core_number = 0;
+    for (int index : core_graph.core_index)
+        if (index != -1)
+            core_number++;
+
+    EXPECT_EQ(core_number, 300);
+    EXPECT_EQ(core_graph.landmarks.size(), 8);
+    EXPECT_EQ(core_graph.landmark_from.size(), 8 * 300);
+}
+
+TEST(CoreALTPreprocessing, CoreNodesHaveHighestRanks)
+{
+    CHGraph::Graph graph;
+    CHGraph::CoreALTGraph core_graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+
+    CHGraph::preproc_graph_core_alt(graph, 300, 8, core_graph);
+
+    const int n = (int)core_graph.core_index.size();
+    for (int v = 0; v < n; ++v)
+    {
+        if (core_graph.core_index[v] != -1)
+            EXPECT_GE(core_graph.hierarchy.ranks[v], n - 300);
+        else
+            EXPECT_LT(core_graph.hierarchy.ranks[v], n - 300);
+    }
+
+    for (const auto &arc : core_graph.core_arcs)
+    {
+        EXPECT_NE(core_graph.core_index[arc.from], -1);
+        EXPECT_NE(core_graph.core_index[arc.to], -1);
+    }
+}
+
+TEST(CoreALTQuery, SimpleQueryTwoHops)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::CoreALTGraph core_graph;
+    CHGraph::preproc_graph_core_alt(g, 2, 1, core_graph);
+
+    CHGraph::Route route;
+    CHGraph::query_route_core_alt(core_graph, CHGraph::Destination{.source = 0, .target = 2}, route);
+
+    EXPECT_EQ(route.total_weight, 2.0);
+}
+
+TEST(CoreALTQuery, SimpleQueryUnreachable)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::CoreALTGraph core_graph;
+    CHGraph::preproc_graph_core_alt(g, 2, 1, core_graph);
+
+    CHGraph::Route route;
+    CHGraph::query_route_core_alt(core_graph, CHGraph::Destination{.source = 2, .target = 0}, route);
+
+    EXPECT_TRUE(std::isinf(route.total_weight));
+}
+
+TEST(CoreALTQueryLargeGraph, SmallCoreMatchesSolutions)
+{
+    expect_solutions_match("tst/graphs/rome99.gr", "tst/destinations/d_rome99.txt",
+                           "tst/graph_solutions/formatted_rome99.txt", core_alt_query(200, 16));
+}
+
+TEST(CoreALTQueryLargeGraph, FullContractionMatchesSolutions)
+{
+    expect_solutions_match("tst/graphs/rome99.gr", "tst/destinations/d_rome99.txt",
+                           "tst/graph_solutions/formatted_rome99.txt", core_alt_query(0, 16));
+}
+
+TEST(CoreALTQueryLargeGraph, NoContractionMatchesSolutions)
+{
+    expect_solutions_match("tst/graphs/graph_1000_2000.gr", "tst/destinations/d_1000_100.txt",
+                           "tst/graph_solutions/formatted_1000_2000.txt", core_alt_query(1000, 8));
+}
+
+TEST(CoreALTQueryLargeGraph, GRAPH_1000_2000)
+{
+    expect_solutions_match("tst/graphs/graph_1000_2000.gr", "tst/destinations/d_1000_100.txt",
+                           "tst/graph_solutions/formatted_1000_2000.txt", core_alt_query(100, 8));
+}
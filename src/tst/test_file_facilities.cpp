@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "file_facilities.hpp"
+#include "test_helpers.hpp"
 #include <string>
 #include <vector>
 #include <iostream>
@@ -220,6 +221,124 @@ TEST(ReadGraphFileTests, IncorrectNodeNumberInFile)
     EXPECT_THROW(FileFacilities::read_graph(graph_file_path, graph), std::runtime_error);
 }
 
+TEST(ReadGraphFileTests, WindowsLineEndingsAndBlankLines)
+{
+    const CHGraph::Graph expected_graph = {
+        .first_out =    {0, 3, 5, 5, 5},
+        .from =         {0,     0,      0,      1,      1},
+        .to =           {1,     2,      3,      2,      3},
+        .weights =      {1.5,   2.5,    3.5,    4.5,    5.5},
+    };
+
+    CHGraph::Graph graph;
+    const std::string graph_file_path = "tst/data/test_facilities/graph_08.txt";
+
+    EXPECT_NO_THROW(FileFacilities::read_graph(graph_file_path, graph));
+
+    expect_equal_graphs(expected_graph, graph);
+}
+
+TEST(ReadGraphFileTests, ErrorReportsLineNumber)
+{
+    CHGraph::Graph graph;
+    const std::string graph_file_path = "tst/data/test_facilities/graph_06.txt";
+
+    try
+    {
+        FileFacilities::read_graph(graph_file_path, graph);
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch (const std::runtime_error &error)
+    {
+        EXPECT_NE(std::string(error.what()).find("on line 4 "), std::string::npos) << error.what();
+    }
+}
+
+TEST(ReadGraphFileTests, LargeGraphArcsAreGroupedByTail)
+{
+    CHGraph::Graph graph;
+    EXPECT_NO_THROW(FileFacilities::read_graph("tst/graphs/rome99.gr", graph));
+
+    ASSERT_EQ(graph.first_out.size(), 3354);
+    EXPECT_EQ(graph.to.size(), 8870);
+    EXPECT_EQ(graph.first_out.back(), graph.to.size());
+    for (int node = 0; node + 1 < graph.first_out.size(); ++node)
+        for (int e = graph.first_out[node]; e < graph.first_out[node + 1]; ++e)
+            EXPECT_EQ(graph.from[e], node);
+}
+
+// Writes a graph file large enough to be parsed in several chunks, returns the expected graph
+static CHGraph::Graph write_large_graph_file(const std::string &graph_file_path, const int node_number, const int edge_number)
+{
+    std::vector<std::vector<std::pair<int, double>>> out_edges(node_number);
+    std::ofstream file(graph_file_path);
+    file << "c generated graph" << std::endl;
+    file << "p sp " << node_number << " " << edge_number << std::endl;
+
+    for (int ind = 0; ind < edge_number; ++ind)
+    {
+        const int node_from = static_cast<int>((ind * 7919LL) % node_number);
+        const int node_to = static_cast<int>((ind * 104729LL + 17) % node_number);
+        const double weight = (ind % 1000) + 0.25;
+        out_edges[node_from].emplace_back(node_to, weight);
+
+        if (ind % 1000 == 0)
+            file << "c comment between edges" << std::endl;
+        file << "a " << node_from + 1 << " " << node_to + 1 << " " << weight << std::endl;
+    }
+    file.close();
+
+    CHGraph::Graph graph;
+    graph.first_out.push_back(0);
+    for (int node_from = 0; node_from < node_number; ++node_from)
+    {
+        for (const auto &[node_to, weight] : out_edges[node_from])
+        {
+            graph.from.push_back(node_from);
+            graph.to.push_back(node_to);
+            graph.weights.push_back(weight);
+        }
+        graph.first_out.push_back(graph.to.size());
+    }
+
+    return graph;
+}
+
+TEST(ReadGraphFileTests, ChunkedParsingKeepsFileOrder)
+{
+    const std::string graph_file_path = "tst/tmp/large_graph.tmp";
+    const CHGraph::Graph expected_graph = write_large_graph_file(graph_file_path, 1000, 300000);
+
+    CHGraph::Graph graph;
+    EXPECT_NO_THROW(FileFacilities::read_graph(graph_file_path, graph));
+
+    expect_equal_graphs(expected_graph, graph);
+    std::filesystem::remove(graph_file_path);
+}
+
+TEST(ReadGraphFileTests, ChunkedParsingReportsLineNumber)
+{
+    const std::string graph_file_path = "tst/tmp/large_graph_error.tmp";
+    write_large_graph_file(graph_file_path, 1000, 300000);
+    {
+        std::ofstream file(graph_file_path, std::ios::app);
+        file << "a 1 1001 1.0" << std::endl;
+    }
+
+    // 2 header lines, 300000 edges and 300 comments come before the incorrect edge
+    CHGraph::Graph graph;
+    try
+    {
+        FileFacilities::read_graph(graph_file_path, graph);
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch (const std::runtime_error &error)
+    {
+        EXPECT_NE(std::string(error.what()).find("on line 300303 "), std::string::npos) << error.what();
+    }
+    std::filesystem::remove(graph_file_path);
+}
+
 static void expect_equal_text_files(const std::string &file1_path, const std::string &file2_path)
 {
     std::ifstream file1(file1_path);
@@ -284,6 +403,41 @@ TEST(DumpMeasurementTests, SuccessfulWriting02)
     expect_equal_text_files(dump_measurement_path, expected_dump_measurement);
 }
 
+static Measurement make_histogram_measurement()
+{
+    Measurement measurement;
+    const MetricId beta = measurement.register_metric("beta");
+    const MetricId alpha = measurement.register_metric("alpha");
+    // registered without values, left out of the summaries
+    measurement.register_metric("gamma");
+
+    for (TimerTime value : {10, 20, 30, 40})
+    {
+        measurement.record(alpha, value);
+    }
+    measurement.record(beta, 5);
+
+    return measurement;
+}
+
+TEST(DumpMeasurementSummaryTests, SuccessfulWriting)
+{
+    const std::string dump_measurement_path = "tst/tmp/measurement_03.tmp";
+
+    EXPECT_NO_THROW(FileFacilities::dump_measurement_summary(make_histogram_measurement(), dump_measurement_path));
+
+    expect_equal_text_files(dump_measurement_path, "tst/data/test_facilities/measurement_03.csv");
+}
+
+TEST(DumpMeasurementSummaryTests, SuccessfulWritingJson)
+{
+    const std::string dump_measurement_path = "tst/tmp/measurement_04.tmp";
+
+    EXPECT_NO_THROW(FileFacilities::dump_measurement_json(make_histogram_measurement(), dump_measurement_path));
+
+    expect_equal_text_files(dump_measurement_path, "tst/data/test_facilities/measurement_03.json");
+}
+
 // Tests for read_solutions
 TEST(ReadSolutionsTests, SuccessfulRetrieving)
 {
@@ -355,4 +509,317 @@ TEST(ReadSolutionsTests, WithComments)
     EXPECT_EQ(solutions[0].source, expected_solutions[0].source);
     EXPECT_EQ(solutions[0].target, expected_solutions[0].target);
     EXPECT_EQ(solutions[0].expected_weight, expected_solutions[0].expected_weight);
-}
\ No newline at end of file
+}
+static CHGraph::Graph make_test_graph()
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/data/test_facilities/graph_02.txt", graph);
+    return graph;
+}
+
+static CHGraph::PreprocGraph make_preproc_graph(const CHGraph::Graph &graph)
+{
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+    return preproc_graph;
+}
+
+TEST(PreprocGraphFileTests, SaveAndLoadRoundTrip)
+{
+    const std::string preproc_file_path = "tst/tmp/preproc_graph_01.tmp";
+    const CHGraph::Graph graph = make_test_graph();
+    const CHGraph::PreprocGraph expected_graph = make_preproc_graph(graph);
+
+    EXPECT_NO_THROW(FileFacilities::save_preproc_graph(graph, expected_graph, preproc_file_path));
+
+    CHGraph::PreprocGraph preproc_graph;
+    EXPECT_NO_THROW(FileFacilities::load_preproc_graph(preproc_file_path, graph, preproc_graph));
+
+    expect_same_preproc_graph(expected_graph, preproc_graph);
+}
+
+TEST(PreprocGraphFileTests, LoadedGraphAnswersQueries)
+{
+    const std::string preproc_file_path = "tst/tmp/preproc_graph_02.tmp";
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph, loaded_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_1000_100.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_1000_2000.txt", solutions);
+
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+    FileFacilities::save_preproc_graph(graph, preproc_graph, preproc_file_path);
+    FileFacilities::load_preproc_graph(preproc_file_path, graph, loaded_graph);
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        CHGraph::Route route;
+        CHGraph::query_route(graph, loaded_graph, destinations[i], route);
+        EXPECT_EQ(solutions[i].expected_weight, route.total_weight);
+    }
+}
+
+TEST(PreprocGraphFileTests, FileNotExist)
+{
+    CHGraph::PreprocGraph preproc_graph;
+    const std::string preproc_file_path = "tst/tmp/non_existing_preproc_graph.tmp";
+
+    EXPECT_THROW(FileFacilities::load_preproc_graph(preproc_file_path, make_test_graph(), preproc_graph), std::runtime_error);
+}
+
+TEST(PreprocGraphFileTests, NotAPreprocGraphFile)
+{
+    CHGraph::PreprocGraph preproc_graph;
+    const std::string preproc_file_path = "tst/data/test_facilities/graph_01.txt";
+
+    EXPECT_THROW(FileFacilities::load_preproc_graph(preproc_file_path, make_test_graph(), preproc_graph), std::runtime_error);
+}
+
+TEST(PreprocGraphFileTests, CorruptedPayload)
+{
+    const std::string preproc_file_path = "tst/tmp/preproc_graph_03.tmp";
+    const CHGraph::Graph graph = make_test_graph();
+    FileFacilities::save_preproc_graph(graph, make_preproc_graph(graph), preproc_file_path);
+
+    {
+        std::fstream file(preproc_file_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-8, std::ios::end);
+        char byte;
+        file.read(&byte, 1);
+        byte ^= 0x5a;
+        file.seekp(-8, std::ios::end);
+        file.write(&byte, 1);
+    }
+
+    CHGraph::PreprocGraph preproc_graph;
+    EXPECT_THROW(FileFacilities::load_preproc_graph(preproc_file_path, graph, preproc_graph), std::runtime_error);
+}
+
+TEST(PreprocGraphFileTests, TruncatedFile)
+{
+    const std::string preproc_file_path = "tst/tmp/preproc_graph_04.tmp";
+    const CHGraph::Graph graph = make_test_graph();
+    FileFacilities::save_preproc_graph(graph, make_preproc_graph(graph), preproc_file_path);
+    std::filesystem::resize_file(preproc_file_path, std::filesystem::file_size(preproc_file_path) - 64);
+
+    CHGraph::PreprocGraph preproc_graph;
+    EXPECT_THROW(FileFacilities::load_preproc_graph(preproc_file_path, graph, preproc_graph), std::runtime_error);
+}
+
+TEST(PreprocGraphFileTests, UnsupportedVersion)
+{
+    const std::string preproc_file_path = "tst/tmp/preproc_graph_05.tmp";
+    const CHGraph::Graph graph = make_test_graph();
+    FileFacilities::save_preproc_graph(graph, make_preproc_graph(graph), preproc_file_path);
+
+    {
+        std::fstream file(preproc_file_path, std::ios::in | std::ios::out | std::ios::binary);
+        const std::uint32_t version = 1000;
+        file.seekp(8);
+        file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    }
+
+    CHGraph::PreprocGraph preproc_graph;
+    EXPECT_THROW(FileFacilities::load_preproc_graph(preproc_file_path, graph, preproc_graph), std::runtime_error);
+}
+
+TEST(PreprocGraphFileTests, FileOfOtherGraph)
+{
+    const std::string preproc_file_path = "tst/tmp/preproc_graph_06.tmp";
+    const CHGraph::Graph graph = make_test_graph();
+    FileFacilities::save_preproc_graph(graph, make_preproc_graph(graph), preproc_file_path);
+
+    CHGraph::Graph other_graph = graph;
+    other_graph.weights[0] += 1.0;
+    CHGraph::Graph larger_graph;
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", larger_graph);
+
+    CHGraph::PreprocGraph preproc_graph;
+    EXPECT_THROW(FileFacilities::load_preproc_graph(preproc_file_path, other_graph, preproc_graph), std::runtime_error);
+    EXPECT_THROW(FileFacilities::load_preproc_graph(preproc_file_path, larger_graph, preproc_graph), std::runtime_error);
+    EXPECT_NO_THROW(FileFacilities::load_preproc_graph(preproc_file_path, graph, preproc_graph));
+}
+
+TEST(RanksFileTests, SaveAndLoadRoundTrip)
+{
+    const std::string ranks_file_path = "tst/tmp/ranks_01.tmp";
+    const std::vector<int> expected_ranks = make_preproc_graph(make_test_graph()).ranks;
+
+    EXPECT_NO_THROW(FileFacilities::save_ranks(expected_ranks, ranks_file_path));
+
+    std::vector<int> ranks;
+    EXPECT_NO_THROW(FileFacilities::load_ranks(ranks_file_path, ranks));
+    EXPECT_EQ(expected_ranks, ranks);
+}
+
+TEST(RanksFileTests, CorruptedOrWrongFile)
+{
+    const std::string ranks_file_path = "tst/tmp/ranks_02.tmp";
+    FileFacilities::save_ranks(make_preproc_graph(make_test_graph()).ranks, ranks_file_path);
+
+    {
+        std::fstream file(ranks_file_path, std::ios::in | std::ios::out | std::ios::binary);
+        const int rank = 1000;
+        file.seekp(-64, std::ios::end);
+        file.write(reinterpret_cast<const char *>(&rank), sizeof(rank));
+    }
+
+    std::vector<int> ranks;
+    EXPECT_THROW(FileFacilities::load_ranks(ranks_file_path, ranks), std::runtime_error);
+    EXPECT_THROW(FileFacilities::load_ranks("tst/data/test_facilities/graph_01.txt", ranks), std::runtime_error);
+    EXPECT_THROW(FileFacilities::load_ranks("tst/tmp/non_existing_ranks.tmp", ranks), std::runtime_error);
+}
+
+static std::string copy_to_tmp(const std::string &file_path, const std::string &tmp_path)
+{
+    std::filesystem::copy_file(file_path, tmp_path, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::remove(tmp_path + ".cache");
+    return tmp_path;
+}
+
+TEST(GraphCacheTests, CacheIsWrittenAndReused)
+{
+    const std::string graph_file_path = copy_to_tmp("tst/data/test_facilities/graph_02.txt", "tst/tmp/graph_cache_01.tmp");
+    CHGraph::Graph expected_graph, graph, cached_graph;
+    FileFacilities::read_graph(graph_file_path, expected_graph);
+
+    EXPECT_NO_THROW(FileFacilities::read_graph(graph_file_path, graph, FileFacilities::GraphCacheMode::ENABLED));
+    ASSERT_TRUE(std::filesystem::exists(graph_file_path + ".cache"));
+
+    // an untouched cache is not rewritten
+    const auto old_time = std::filesystem::last_write_time(graph_file_path + ".cache") - std::chrono::hours(1);
+    std::filesystem::last_write_time(graph_file_path + ".cache", old_time);
+    EXPECT_NO_THROW(FileFacilities::read_graph(graph_file_path, cached_graph, FileFacilities::GraphCacheMode::ENABLED));
+    EXPECT_EQ(std::filesystem::last_write_time(graph_file_path + ".cache"), old_time);
+
+    expect_equal_graphs(expected_graph, graph);
+    expect_equal_graphs(expected_graph, cached_graph);
+    std::filesystem::remove(graph_file_path + ".cache");
+}
+
+TEST(GraphCacheTests, ChangedSourceInvalidatesCache)
+{
+    const std::string graph_file_path = copy_to_tmp("tst/data/test_facilities/graph_02.txt", "tst/tmp/graph_cache_02.tmp");
+    CHGraph::Graph graph, expected_graph;
+    FileFacilities::read_graph(graph_file_path, graph, FileFacilities::GraphCacheMode::ENABLED);
+
+    copy_to_tmp("tst/data/test_facilities/graph_03.txt", graph_file_path);
+    FileFacilities::read_graph(graph_file_path, expected_graph);
+    FileFacilities::read_graph(graph_file_path, graph, FileFacilities::GraphCacheMode::ENABLED);
+
+    expect_equal_graphs(expected_graph, graph);
+    std::filesystem::remove(graph_file_path + ".cache");
+}
+
+TEST(GraphCacheTests, CorruptedCacheIsRebuilt)
+{
+    const std::string graph_file_path = copy_to_tmp("tst/data/test_facilities/graph_02.txt", "tst/tmp/graph_cache_03.tmp");
+    CHGraph::Graph expected_graph, graph;
+    FileFacilities::read_graph(graph_file_path, expected_graph, FileFacilities::GraphCacheMode::ENABLED);
+
+    {
+        std::fstream file(graph_file_path + ".cache", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-16, std::ios::end);
+        const double weight = 1000.0;
+        file.write(reinterpret_cast<const char *>(&weight), sizeof(weight));
+    }
+
+    FileFacilities::read_graph(graph_file_path, graph, FileFacilities::GraphCacheMode::ENABLED);
+    expect_equal_graphs(expected_graph, graph);
+
+    // the rebuilt cache is intact again
+    CHGraph::Graph cached_graph;
+    FileFacilities::read_graph(graph_file_path, cached_graph, FileFacilities::GraphCacheMode::ENABLED);
+    expect_equal_graphs(expected_graph, cached_graph);
+    std::filesystem::remove(graph_file_path + ".cache");
+}
+
+TEST(GraphCacheTests, RebuildRewritesValidCache)
+{
+    const std::string graph_file_path = copy_to_tmp("tst/data/test_facilities/graph_02.txt", "tst/tmp/graph_cache_04.tmp");
+    CHGraph::Graph graph;
+    FileFacilities::read_graph(graph_file_path, graph, FileFacilities::GraphCacheMode::ENABLED);
+
+    const auto old_time = std::filesystem::last_write_time(graph_file_path + ".cache") - std::chrono::hours(1);
+    std::filesystem::last_write_time(graph_file_path + ".cache", old_time);
+    FileFacilities::read_graph(graph_file_path, graph, FileFacilities::GraphCacheMode::REBUILD);
+
+    EXPECT_NE(std::filesystem::last_write_time(graph_file_path + ".cache"), old_time);
+    std::filesystem::remove(graph_file_path + ".cache");
+}
+
+static std::vector<CHGraph::Destination> read_all_batches(const std::string &destinations_file_path, const std::size_t batch_size)
+{
+    FileFacilities::DestinationReader reader(destinations_file_path);
+    std::vector<CHGraph::Destination> destinations, batch;
+
+    while (reader.next_batch(batch, batch_size))
+    {
+        EXPECT_LE(batch.size(), batch_size);
+        destinations.insert(destinations.end(), batch.begin(), batch.end());
+    }
+
+    return destinations;
+}
+
+TEST(DestinationReaderTests, BatchesMatchReadDestinations)
+{
+    for (const std::string destinations_file_path : {"tst/data/test_facilities/destinations_01.txt",
+                                                     "tst/data/test_facilities/destinations_02.txt",
+                                                     "tst/data/test_facilities/destinations_03.txt",
+                                                     "tst/destinations/d_rome99.txt"})
+    {
+        std::vector<CHGraph::Destination> expected_destinations;
+        FileFacilities::read_destinations(destinations_file_path, expected_destinations);
+
+        for (std::size_t batch_size : {1, 2, 7, 1000})
+        {
+            expect_equal_destinations(expected_destinations, read_all_batches(destinations_file_path, batch_size));
+        }
+    }
+}
+
+TEST(DestinationReaderTests, LongFileIsReadThroughBuffer)
+{
+    const std::string destinations_file_path = "tst/tmp/destinations_long.tmp";
+    std::vector<CHGraph::Destination> expected_destinations;
+    {
+        std::ofstream file(destinations_file_path);
+        for (int ind = 0; ind < 50000; ++ind)
+        {
+            expected_destinations.push_back(CHGraph::Destination{.source = ind, .target = 3 * ind + 1});
+            file << "d " << ind << " " << 3 * ind + 1;
+            if (ind + 1 < 50000)
+                file << std::endl;
+        }
+    }
+
+    expect_equal_destinations(expected_destinations, read_all_batches(destinations_file_path, 333));
+    std::filesystem::remove(destinations_file_path);
+}
+
+TEST(DestinationReaderTests, FileNotExist)
+{
+    EXPECT_THROW(FileFacilities::DestinationReader("tst/data/test_facilities/non_existing_destinations_file.txt"), std::runtime_error);
+}
+
+TEST(DestinationReaderTests, ErrorReportsLineNumber)
+{
+    FileFacilities::DestinationReader reader("tst/data/test_facilities/destinations_04.txt");
+    std::vector<CHGraph::Destination> batch;
+
+    EXPECT_TRUE(reader.next_batch(batch, 1));
+    try
+    {
+        reader.next_batch(batch, 1);
+        FAIL() << "Expected std::runtime_error";
+    }
+    catch (const std::runtime_error &error)
+    {
+        EXPECT_NE(std::string(error.what()).find("on line 4 "), std::string::npos) << error.what();
+    }
+}
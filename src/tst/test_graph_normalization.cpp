@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "graph_normalization.hpp"
+#include "file_facilities.hpp"
+#include <limits>
+#include <stdexcept>
+
+
+// 0 -> 2, two parallel arcs 0 -> 1, a self loop at 0 and 1 -> 2
+static CHGraph::Graph make_parallel_arc_graph()
+{
+    CHGraph::Graph g;
+
+    g.first_out = {0, 4, 5, 5};
+    g.from      = {0, 0, 0, 0, 1};
+    g.to        = {2, 1, 0, 1, 2};
+    g.weights   = {5.0, 3.0, 1.0, 1.0, 2.0};
+
+    return g;
+}
+
+TEST(GraphNormalization, ParallelArcsAndSelfLoops)
+{
+    CHGraph::Graph normalized;
+    CHGraph::NodeMapping mapping;
+    CHGraph::normalize_graph(make_parallel_arc_graph(), normalized, mapping);
+
+    EXPECT_EQ(normalized.first_out, (std::vector<int>{0, 2, 3, 3}));
+    EXPECT_EQ(normalized.from, (std::vector<int>{0, 0, 1}));
+    EXPECT_EQ(normalized.to, (std::vector<int>{1, 2, 2}));
+    EXPECT_EQ(normalized.weights, (std::vector<double>{1.0, 5.0, 2.0}));
+    EXPECT_EQ(mapping.to_normalized, (std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(mapping.to_original, (std::vector<int>{0, 1, 2}));
+}
+
+TEST(GraphNormalization, IsolatedNodesAreRemoved)
+{
+    // node 1 only has a self loop, node 3 has no arc at all
+    CHGraph::Graph g;
+    g.first_out = {0, 1, 2, 2, 2};
+    g.from      = {0, 1};
+    g.to        = {2, 1};
+    g.weights   = {4.0, 1.0};
+
+    CHGraph::Graph normalized;
+    CHGraph::NodeMapping mapping;
+    CHGraph::normalize_graph(g, normalized, mapping, true);
+
+    EXPECT_EQ(normalized.first_out, (std::vector<int>{0, 1, 1}));
+    EXPECT_EQ(normalized.to, (std::vector<int>{1}));
+    EXPECT_EQ(mapping.to_normalized, (std::vector<int>{0, -1, 1, -1}));
+    EXPECT_EQ(mapping.to_original, (std::vector<int>{0, 2}));
+
+    CHGraph::Destination destination;
+    EXPECT_TRUE(CHGraph::normalize_destination(mapping, CHGraph::Destination{.source = 0, .target = 2}, destination));
+    EXPECT_EQ(destination.source, 0);
+    EXPECT_EQ(destination.target, 1);
+    EXPECT_FALSE(CHGraph::normalize_destination(mapping, CHGraph::Destination{.source = 1, .target = 2}, destination));
+    EXPECT_FALSE(CHGraph::normalize_destination(mapping, CHGraph::Destination{.source = 0, .target = 4}, destination));
+
+    CHGraph::Route route{.total_weight = 4.0, .nodes = {0, 1}};
+    CHGraph::denormalize_route(mapping, route);
+    EXPECT_EQ(route.nodes, (std::vector<int>{0, 2}));
+}
+
+TEST(GraphNormalization, InconsistentGraph)
+{
+    CHGraph::Graph g = make_parallel_arc_graph();
+    g.weights.pop_back();
+
+    CHGraph::Graph normalized;
+    CHGraph::NodeMapping mapping;
+    EXPECT_THROW(CHGraph::normalize_graph(g, normalized, mapping), std::invalid_argument);
+}
+
+TEST(GraphNormalizationLargeGraph, NormalizedGraphMatchesSolutions)
+{
+    CHGraph::Graph graph, normalized;
+    CHGraph::NodeMapping mapping;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_rome99.txt", solutions);
+    CHGraph::normalize_graph(graph, normalized, mapping, true);
+
+    EXPECT_LE(normalized.to.size(), graph.to.size());
+    for (int node = 0; node + 1 < static_cast<int>(normalized.first_out.size()); ++node)
+    {
+        for (int e = normalized.first_out[node]; e < normalized.first_out[node + 1]; ++e)
+        {
+            EXPECT_EQ(normalized.from[e], node);
+            EXPECT_NE(normalized.to[e], node);
+            if (e > normalized.first_out[node])
+            {
+                EXPECT_LT(normalized.to[e - 1], normalized.to[e]);
+            }
+        }
+    }
+
+    CHGraph::preproc_graph_top_down(normalized, preproc_graph);
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        CHGraph::Destination destination;
+        CHGraph::Route route;
+        if (CHGraph::normalize_destination(mapping, destinations[i], destination))
+            CHGraph::query_route(normalized, preproc_graph, destination, route);
+        else
+            route.total_weight = (destinations[i].source == destinations[i].target) ? 0.0 : std::numeric_limits<double>::infinity();
+
+        EXPECT_EQ(solutions[i].expected_weight, route.total_weight);
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef __TEST_HELPERS_HPP__
+#define __TEST_HELPERS_HPP__
+
+#include <gtest/gtest.h>
+#include "ch_graph.hpp"
+#include "file_facilities.hpp"
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// simple test graph to be used for test, 0 -> 1 -> 2 is shorter than 0 -> 2
+inline CHGraph::Graph make_simple_graph()
+{
+    CHGraph::Graph g;
+
+    g.first_out = {0, 2, 3, 3};
+    g.to        = {1, 2, 2};
+    g.weights   = {1.0, 3.0, 1.0};
+
+    return g;
+}
+
+// Graph with node_number nodes and the given (from, to, weight) arcs in any order
+inline CHGraph::Graph make_graph(const int node_number, const std::vector<std::tuple<int, int, double>> &arcs)
+{
+    CHGraph::Graph g;
+    g.first_out.assign(node_number + 1, 0);
+    for (const auto &[from, to, weight] : arcs)
+        ++g.first_out[from + 1];
+    for (int v = 0; v < node_number; ++v)
+        g.first_out[v + 1] += g.first_out[v];
+
+    std::vector<int> next(g.first_out.begin(), g.first_out.end() - 1);
+    g.from.resize(arcs.size());
+    g.to.resize(arcs.size());
+    g.weights.resize(arcs.size());
+    for (const auto &[from, to, weight] : arcs)
+    {
+        const int e = next[from]++;
+        g.from[e] = from;
+        g.to[e] = to;
+        g.weights[e] = weight;
+    }
+    return g;
+}
+
+// Dijkstra implementation for validation, weights replaces graph.weights if given
+inline double dijkstra_shortest_path(const CHGraph::Graph &graph, int source, int target, const std::vector<double> *weights = nullptr)
+{
+    const int n = graph.first_out.size() - 1;
+
+    if (source < 0 || source >= n || target < 0 || target >= n)
+        return std::numeric_limits<double>::infinity();
+
+    const std::vector<double> &arc_weights = (weights != nullptr) ? *weights : graph.weights;
+    const double INF = std::numeric_limits<double>::infinity();
+    std::vector<double> dist(n, INF);
+
+    using QItem = std::pair<double, int>;
+    std::priority_queue<QItem, std::vector<QItem>, std::greater<QItem>> pq;
+
+    dist[source] = 0.0;
+    pq.push(QItem(0.0, source));
+
+    while (!pq.empty())
+    {
+        auto [d, u] = pq.top();
+        pq.pop();
+
+        if (d > dist[u])
+            continue;
+
+        if (u == target)
+            return dist[target];
+
+        for (int e = graph.first_out[u]; e < graph.first_out[u + 1]; ++e)
+        {
+            double new_dist = d + arc_weights[e];
+            if (new_dist < dist[graph.to[e]])
+            {
+                dist[graph.to[e]] = new_dist;
+                pq.push(QItem(new_dist, graph.to[e]));
+            }
+        }
+    }
+
+    return dist[target];
+}
+
+// Reads the files, preprocess(graph) builds what a method needs and returns its query, a callable from a
+// Destination to the route weight, which has to give every weight of solutions_file
+template <typename Preprocess>
+void expect_solutions_match(const std::string &graph_file, const std::string &destinations_file,
+                            const std::string &solutions_file, Preprocess preprocess)
+{
+    CHGraph::Graph graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph(graph_file, graph);
+    FileFacilities::read_destinations(destinations_file, destinations);
+    FileFacilities::read_solutions(solutions_file, solutions);
+
+    const auto query = preprocess(graph);
+
+    ASSERT_EQ(destinations.size(), solutions.size());
+
+    for (size_t i = 0; i < destinations.size(); ++i)
+        EXPECT_EQ(solutions[i].expected_weight, query(destinations[i]));
+}
+
+inline void expect_same_arcs(const std::vector<CHGraph::CHArc> &expected, const std::vector<CHGraph::CHArc> &actual)
+{
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].from, actual[i].from);
+        EXPECT_EQ(expected[i].to, actual[i].to);
+        EXPECT_EQ(expected[i].weight, actual[i].weight);
+        EXPECT_EQ(expected[i].mid_node, actual[i].mid_node);
+    }
+}
+
+inline void expect_same_preproc_graph(const CHGraph::PreprocGraph &expected, const CHGraph::PreprocGraph &actual)
+{
+    EXPECT_EQ(expected.ranks, actual.ranks);
+    EXPECT_EQ(expected.forward_first_out, actual.forward_first_out);
+    EXPECT_EQ(expected.backward_first_out, actual.backward_first_out);
+    expect_same_arcs(expected.forward_arcs, actual.forward_arcs);
+    expect_same_arcs(expected.backward_arcs, actual.backward_arcs);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "hierarchy_quality.hpp"
+#include "file_facilities.hpp"
+#include <stdexcept>
+
+
+// 0 -> 1 -> 2 upwards, 2 -> 0 downwards as shortcut over 1
+static CHGraph::PreprocGraph make_simple_hierarchy()
+{
+    CHGraph::PreprocGraph preproc_graph;
+
+    preproc_graph.ranks = {0, 1, 2};
+    preproc_graph.forward_first_out = {0, 1, 2, 2};
+    preproc_graph.forward_arcs = {{0, 1, 1.0, -1}, {1, 2, 1.0, -1}};
+    preproc_graph.backward_first_out = {0, 1, 1, 1};
+    preproc_graph.backward_arcs = {{0, 2, 2.0, 1}};
+
+    return preproc_graph;
+}
+
+TEST(HierarchyQualityTests, SimpleHierarchy)
+{
+    CHGraph::HierarchyQuality quality;
+    CHGraph::analyze_hierarchy(make_simple_hierarchy(), quality);
+
+    EXPECT_EQ(quality.node_number, 3);
+    EXPECT_EQ(quality.sampled_nodes, 3);
+    EXPECT_EQ(quality.forward_arcs, 2);
+    EXPECT_EQ(quality.backward_arcs, 1);
+    EXPECT_EQ(quality.shortcuts, 1);
+
+    // forward search spaces {0, 1, 2}, {1, 2}, {2}, backward ones {0, 2}, {1}, {2}
+    EXPECT_EQ(quality.forward_search_space.count(), 3);
+    EXPECT_EQ(quality.forward_search_space.min(), 1);
+    EXPECT_EQ(quality.forward_search_space.max(), 3);
+    EXPECT_EQ(quality.forward_search_space.mean(), 2.0);
+    EXPECT_EQ(quality.backward_search_space.max(), 2);
+    EXPECT_EQ(quality.forward_search_arcs.max(), 2);
+    EXPECT_EQ(quality.backward_search_arcs.max(), 1);
+
+    EXPECT_EQ(quality.forward_degree.max(), 1);
+    EXPECT_EQ(quality.backward_degree.count(), 3);
+    EXPECT_EQ(quality.depth.max(), 3);
+    EXPECT_EQ(quality.depth.min(), 1);
+}
+
+TEST(HierarchyQualityTests, SampleOfRealGraph)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    CHGraph::HierarchyQuality full, sampled;
+    CHGraph::analyze_hierarchy(preproc_graph, full);
+    CHGraph::analyze_hierarchy(preproc_graph, sampled, 100, 7);
+
+    EXPECT_EQ(full.sampled_nodes, full.node_number);
+    EXPECT_EQ(full.forward_search_space.count(), full.node_number);
+    EXPECT_EQ(sampled.sampled_nodes, 100);
+    EXPECT_EQ(sampled.backward_search_space.count(), 100);
+
+    EXPECT_GE(full.forward_search_space.min(), 1);
+    EXPECT_LE(full.forward_search_space.max(), full.node_number);
+    EXPECT_GT(full.depth.max(), 1);
+    EXPECT_EQ(sampled.forward_arcs + sampled.backward_arcs,
+              static_cast<long long>(preproc_graph.forward_arcs.size() + preproc_graph.backward_arcs.size()));
+    EXPECT_EQ(sampled.depth.count(), full.node_number);
+    EXPECT_EQ(sampled.depth.max(), full.depth.max());
+}
+
+TEST(HierarchyQualityTests, InvalidArguments)
+{
+    CHGraph::PreprocGraph preproc_graph = make_simple_hierarchy();
+    CHGraph::HierarchyQuality quality;
+
+    EXPECT_THROW(CHGraph::analyze_hierarchy(preproc_graph, quality, -1), std::invalid_argument);
+    preproc_graph.backward_first_out.pop_back();
+    EXPECT_THROW(CHGraph::analyze_hierarchy(preproc_graph, quality), std::invalid_argument);
+}
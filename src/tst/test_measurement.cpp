@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include "measurement.hpp"
+
+#include <stdexcept>
+
+
+TEST(HistogramTests, EmptyHistogram)
+{
+    Histogram histogram;
+
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_EQ(histogram.value_at_percentile(50.0), 0);
+    EXPECT_EQ(histogram.mean(), 0.0);
+}
+
+TEST(HistogramTests, SmallValuesAreExact)
+{
+    Histogram histogram;
+    for (TimerTime value = 1; value <= 100; ++value)
+    {
+        histogram.record(value);
+    }
+
+    EXPECT_EQ(histogram.count(), 100);
+    EXPECT_EQ(histogram.min(), 1);
+    EXPECT_EQ(histogram.max(), 100);
+    EXPECT_EQ(histogram.mean(), 50.5);
+    EXPECT_EQ(histogram.value_at_percentile(0.0), 1);
+    EXPECT_EQ(histogram.value_at_percentile(50.0), 50);
+    EXPECT_EQ(histogram.value_at_percentile(90.0), 90);
+    EXPECT_EQ(histogram.value_at_percentile(99.0), 99);
+    EXPECT_EQ(histogram.value_at_percentile(100.0), 100);
+}
+
+TEST(HistogramTests, LargeValuesKeepRelativePrecision)
+{
+    Histogram histogram;
+    for (TimerTime value = 1; value <= 10000; ++value)
+    {
+        histogram.record(value * 1000003);
+    }
+
+    EXPECT_EQ(histogram.min(), 1000003);
+    EXPECT_EQ(histogram.max(), 10000LL * 1000003);
+
+    for (const double percentile : {10.0, 50.0, 90.0, 99.0})
+    {
+        const double expected = percentile * 100 * 1000003;
+        const double value = static_cast<double>(histogram.value_at_percentile(percentile));
+        EXPECT_GE(value, expected);
+        EXPECT_LE(value, expected * (1.0 + 1.0 / 128));
+    }
+}
+
+TEST(HistogramTests, NegativeValueThrows)
+{
+    Histogram histogram;
+    EXPECT_THROW(histogram.record(-1), std::invalid_argument);
+    EXPECT_THROW(histogram.value_at_percentile(101.0), std::invalid_argument);
+}
+
+TEST(MeasurementTests, RegisterMetricReturnsStableIds)
+{
+    Measurement measurement;
+
+    const MetricId first = measurement.register_metric("first");
+    const MetricId second = measurement.register_metric("second");
+
+    EXPECT_EQ(first, 0);
+    EXPECT_EQ(second, 1);
+    EXPECT_EQ(measurement.register_metric("first"), first);
+    EXPECT_EQ(measurement.metric_names[second], "second");
+
+    measurement.record(second, 7);
+    EXPECT_EQ(measurement.histograms[first].count(), 0);
+    EXPECT_EQ(measurement.histograms[second].count(), 1);
+    EXPECT_THROW(measurement.record(2, 7), std::invalid_argument);
+}
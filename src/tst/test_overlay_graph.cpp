@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "overlay_graph.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+
+static auto overlay_query(const std::vector<int> &cell_numbers)
+{
+    return [=](const CHGraph::Graph &graph)
+    {
+        CHGraph::OverlayPartition partition;
+        CHGraph::OverlayMetric metric;
+        CHGraph::preproc_overlay_partition(graph, cell_numbers, partition);
+        CHGraph::customize_overlay(graph, partition, graph.weights, metric);
+
+        return [&graph, partition = std::move(partition), metric = std::move(metric)](const CHGraph::Destination &destination)
+        {
+            CHGraph::Route route;
+            CHGraph::query_route_overlay(graph, partition, metric, destination, route);
+            return route.total_weight;
+        };
+    };
+}
+
+TEST(OverlayPartition, LevelsAreNested)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+
+    CHGraph::OverlayPartition partition;
+    CHGraph::preproc_overlay_partition(graph, {64, 16, 4}, partition);
+
+    ASSERT_EQ(partition.levels.size(), 3);
+    EXPECT_EQ(partition.levels[0].cell_number, 64);
+
+    const int n = (int)graph.first_out.size() - 1;
+    for (size_t level = 1; level < partition.levels.size(); ++level)
+    {
+        // nodes sharing a cell share the cell of every coarser level
+        std::vector<int> parent(partition.levels[level - 1].cell_number, -1);
+        for (int v = 0; v < n; ++v)
+        {
+            int &cell = parent[partition.levels[level - 1].cells[v]];
+            if (cell == -1)
+                cell = partition.levels[level].cells[v];
+            EXPECT_EQ(cell, partition.levels[level].cells[v]);
+        }
+    }
+}
+
+TEST(OverlayPartition, InvalidCellNumbersThrow)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::OverlayPartition partition;
+
+    EXPECT_THROW(CHGraph::preproc_overlay_partition(g, {}, partition), std::invalid_argument);
+    EXPECT_THROW(CHGraph::preproc_overlay_partition(g, {0}, partition), std::invalid_argument);
+    EXPECT_THROW(CHGraph::preproc_overlay_partition(g, {2, 3}, partition), std::invalid_argument);
+}
+
+TEST(OverlayQuery, SimpleQueryTwoHops)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::OverlayPartition partition;
+    CHGraph::OverlayMetric metric;
+    CHGraph::preproc_overlay_partition(g, {3, 2}, partition);
+    CHGraph::customize_overlay(g, partition, g.weights, metric);
+
+    CHGraph::Route route;
+    CHGraph::query_route_overlay(g, partition, metric, CHGraph::Destination{.source = 0, .target = 2}, route);
+
+    EXPECT_EQ(route.total_weight, 2.0);
+}
+
+TEST(OverlayQuery, SimpleQueryUnreachable)
+{
+    CHGraph::Graph g = make_simple_graph();
+    CHGraph::OverlayPartition partition;
+    CHGraph::OverlayMetric metric;
+    CHGraph::preproc_overlay_partition(g, {3, 2}, partition);
+    CHGraph::customize_overlay(g, partition, g.weights, metric);
+
+    CHGraph::Route route;
+    CHGraph::query_route_overlay(g, partition, metric, CHGraph::Destination{.source = 2, .target = 0}, route);
+
+    EXPECT_TRUE(std::isinf(route.total_weight));
+}
+
+TEST(OverlayQueryLargeGraph, ROME99)
+{
+    expect_solutions_match("tst/graphs/rome99.gr", "tst/destinations/d_rome99.txt",
+                           "tst/graph_solutions/formatted_rome99.txt", overlay_query({64, 16, 4}));
+}
+
+TEST(OverlayQueryLargeGraph, SingleLevel)
+{
+    expect_solutions_match("tst/graphs/rome99.gr", "tst/destinations/d_rome99.txt",
+                           "tst/graph_solutions/formatted_rome99.txt", overlay_query({32}));
+}
+
+TEST(OverlayQueryLargeGraph, GRAPH_1000_2000)
+{
+    expect_solutions_match("tst/graphs/graph_1000_2000.gr", "tst/destinations/d_1000_100.txt",
+                           "tst/graph_solutions/formatted_1000_2000.txt", overlay_query({32, 8}));
+}
+
+TEST(OverlayQueryLargeGraph, SeveralMetricsShareOnePartition)
+{
+    CHGraph::Graph graph;
+    CHGraph::OverlayPartition partition;
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    CHGraph::preproc_overlay_partition(graph, {64, 16, 4}, partition);
+
+    // Second metric: every third arc is slower, every seventh arc is closed
+    std::vector<double> weights = graph.weights;
+    for (size_t e = 0; e < weights.size(); ++e)
+    {
+        if (e % 7 == 0)
+            weights[e] = std::numeric_limits<double>::infinity();
+        else if (e % 3 == 0)
+            weights[e] *= 4.0;
+    }
+
+    CHGraph::OverlayMetric metric, other_metric;
+    CHGraph::customize_overlay(graph, partition, graph.weights, metric);
+    CHGraph::customize_overlay(graph, partition, weights, other_metric);
+
+    const int n = (int)graph.first_out.size() - 1;
+    for (int i = 0; i < 100; ++i)
+    {
+        CHGraph::Destination dest{.source = (i * 7919) % n, .target = (i * 104729 + 13) % n};
+        CHGraph::Route route, other_route;
+        CHGraph::query_route_overlay(graph, partition, metric, dest, route);
+        CHGraph::query_route_overlay(graph, partition, other_metric, dest, other_route);
+
+        EXPECT_EQ(dijkstra_shortest_path(graph, dest.source, dest.target), route.total_weight);
+        EXPECT_EQ(dijkstra_shortest_path(graph, dest.source, dest.target, &weights), other_route.total_weight);
+    }
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "perf_counters.hpp"
+#include "timer.hpp"
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+// Sums a vector large enough to retire many instructions
+static long long sum_values(const int size)
+{
+    std::vector<long long> values(size);
+    for (int ind = 0; ind < size; ++ind)
+    {
+        values[ind] = ind;
+    }
+
+    long long sum = 0;
+    for (long long value : values)
+    {
+        sum += value;
+    }
+    return sum;
+}
+
+TEST(PerfCountersTests, StartStopWorksWithoutCounters)
+{
+    PerfCounters counters;
+
+    EXPECT_NO_THROW(counters.start());
+    EXPECT_THROW(counters.start(), std::runtime_error);
+    EXPECT_NO_THROW(counters.stop());
+    EXPECT_THROW(counters.stop(), std::runtime_error);
+
+    for (int event = 0; event < PERF_EVENT_NUMBER; ++event)
+    {
+        if (!counters.available(static_cast<PerfEvent>(event)))
+        {
+            EXPECT_THROW(counters.get_result(static_cast<PerfEvent>(event)), std::runtime_error);
+        }
+    }
+}
+
+TEST(PerfCountersTests, CountsInstructions)
+{
+    PerfCounters counters;
+    if (!counters.available(PerfEvent::INSTRUCTIONS))
+        GTEST_SKIP() << "Instruction counter is not available";
+
+    counters.start();
+    const long long sum = sum_values(1000000);
+    counters.stop();
+
+    EXPECT_GT(sum, 0);
+    EXPECT_GT(counters.get_result(PerfEvent::INSTRUCTIONS), 1000000);
+}
+
+// Counts the instructions of four threads summing a vector each
+static long long count_threaded_region(PerfCounters &counters)
+{
+    counters.start();
+    std::vector<std::thread> workers;
+    for (int ind = 0; ind < 4; ++ind)
+        workers.emplace_back([]() { sum_values(1000000); });
+    for (std::thread &worker : workers)
+        worker.join();
+    counters.stop();
+
+    return counters.get_result(PerfEvent::INSTRUCTIONS);
+}
+
+TEST(PerfCountersTests, CountsStartedThreads)
+{
+    PerfCounters counters;
+    if (!counters.available(PerfEvent::INSTRUCTIONS))
+        GTEST_SKIP() << "Instruction counter is not available";
+
+    EXPECT_GT(count_threaded_region(counters), 4000000);
+}
+
+TEST(PerfCountersTests, RepeatedThreadedRegionsCountAlike)
+{
+    PerfCounters counters;
+    if (!counters.available(PerfEvent::INSTRUCTIONS))
+        GTEST_SKIP() << "Instruction counter is not available";
+
+    // counts of the threads of the first region must not carry over into the second
+    const long long first = count_threaded_region(counters);
+    const long long second = count_threaded_region(counters);
+    EXPECT_LT(second, first + first / 2);
+    EXPECT_GT(second, first / 2);
+}
+
+TEST(PerfCountersTests, EventNamesAreDistinct)
+{
+    for (int first = 0; first < PERF_EVENT_NUMBER; ++first)
+    {
+        for (int second = first + 1; second < PERF_EVENT_NUMBER; ++second)
+        {
+            EXPECT_STRNE(PerfCounters::event_name(static_cast<PerfEvent>(first)),
+                         PerfCounters::event_name(static_cast<PerfEvent>(second)));
+        }
+    }
+}
+
+TEST(PerfCountersTests, TimerWithoutCountersHasNone)
+{
+    Timer timer;
+    EXPECT_EQ(timer.counters(), nullptr);
+
+    Timer counting_timer(TimerBackend::CHRONO, true);
+    counting_timer.start();
+    sum_values(1000);
+    counting_timer.stop();
+
+    EXPECT_GE(counting_timer.get_result(), 0);
+    if (counting_timer.counters() != nullptr)
+    {
+        EXPECT_TRUE(counting_timer.counters()->available());
+    }
+}
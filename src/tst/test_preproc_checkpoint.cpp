@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include "ch_graph.hpp"
+#include "preproc_checkpoint.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+
+
+// Thrown from the progress callback to stop a contraction halfway like a crash would
+struct Interruption
+{
+};
+
+using Preprocessor = std::function<void(const CHGraph::Graph &, CHGraph::PreprocGraph &, CHGraph::PreprocMonitor *,
+                                        CHGraph::PreprocCheckpoint *)>;
+
+static void expect_resume_matches(const Preprocessor &preprocess, const std::string &checkpoint_file)
+{
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    std::remove(checkpoint_file.c_str());
+
+    CHGraph::PreprocGraph expected;
+    preprocess(graph, expected, nullptr, nullptr);
+
+    // Checkpoint after every node and stop after 100 of them
+    const int stop_after = 100;
+    CHGraph::PreprocCheckpoint checkpoint{.file = checkpoint_file, .interval = std::chrono::nanoseconds(0)};
+    CHGraph::PreprocMonitor monitor;
+    monitor.progress_interval = std::chrono::nanoseconds(0);
+    monitor.progress = [&](const CHGraph::PreprocProgress &progress)
+    {
+        if (progress.contracted_nodes == stop_after)
+            throw Interruption();
+    };
+
+    CHGraph::PreprocGraph interrupted;
+    EXPECT_THROW(preprocess(graph, interrupted, &monitor, &checkpoint), Interruption);
+    ASSERT_TRUE(std::filesystem::exists(checkpoint_file));
+
+    CHGraph::PreprocGraph resumed;
+    checkpoint.interval = std::chrono::hours(1);
+    preprocess(graph, resumed, nullptr, &checkpoint);
+
+    EXPECT_GT(checkpoint.resumed_nodes, stop_after / 2);
+    EXPECT_LE(checkpoint.resumed_nodes, stop_after);
+    EXPECT_FALSE(std::filesystem::exists(checkpoint_file));
+    expect_same_preproc_graph(expected, resumed);
+}
+
+TEST(PreprocCheckpoint, BottomUpResumeMatchesUninterruptedRun)
+{
+    expect_resume_matches([](const CHGraph::Graph &graph, CHGraph::PreprocGraph &preproc_graph, CHGraph::PreprocMonitor *monitor,
+                             CHGraph::PreprocCheckpoint *checkpoint)
+                          {
+                              CHGraph::preproc_graph_bottom_up(graph, preproc_graph,
+                                                              CHGraph::PreprocOptions{.monitor = monitor, .checkpoint = checkpoint});
+                          },
+                          "tst/tmp/checkpoint_01.tmp");
+}
+
+TEST(PreprocCheckpoint, TopDownResumeMatchesUninterruptedRun)
+{
+    expect_resume_matches([](const CHGraph::Graph &graph, CHGraph::PreprocGraph &preproc_graph, CHGraph::PreprocMonitor *monitor,
+                             CHGraph::PreprocCheckpoint *checkpoint)
+                          {
+                              CHGraph::preproc_graph_top_down(graph, preproc_graph,
+                                                              CHGraph::PreprocOptions{.monitor = monitor, .checkpoint = checkpoint});
+                          },
+                          "tst/tmp/checkpoint_02.tmp");
+}
+
+TEST(PreprocCheckpoint, CheckpointOfOtherGraphOrMethod)
+{
+    const std::string checkpoint_file = "tst/tmp/checkpoint_03.tmp";
+    CHGraph::Graph graph, other_graph;
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    other_graph = graph;
+    other_graph.weights[0] += 1.0;
+
+    CHGraph::ContractionState state;
+    state.method = CHGraph::ContractionMethod::TOP_DOWN;
+    state.ranks.assign(graph.first_out.size() - 1, 0);
+    state.contracted.assign(graph.first_out.size() - 1, 0);
+    state.out_first_out.assign(graph.first_out.size(), 0);
+    state.in_first_out.assign(graph.first_out.size(), 0);
+    FileFacilities::save_contraction_checkpoint(graph, state, checkpoint_file);
+
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::PreprocCheckpoint checkpoint{.file = checkpoint_file};
+    const CHGraph::PreprocOptions options{.checkpoint = &checkpoint};
+    EXPECT_THROW(CHGraph::preproc_graph_top_down(other_graph, preproc_graph, options), std::runtime_error);
+    EXPECT_THROW(CHGraph::preproc_graph_bottom_up(graph, preproc_graph, options), std::runtime_error);
+
+    // A damaged checkpoint is not used either
+    std::filesystem::resize_file(checkpoint_file, std::filesystem::file_size(checkpoint_file) - 8);
+    EXPECT_THROW(CHGraph::preproc_graph_top_down(graph, preproc_graph, options), std::runtime_error);
+    std::remove(checkpoint_file.c_str());
+}
+
+TEST(PreprocCheckpoint, InconsistentCheckpoint)
+{
+    const std::string checkpoint_file = "tst/tmp/checkpoint_04.tmp";
+    CHGraph::Graph graph;
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    const int n = graph.first_out.size() - 1;
+
+    CHGraph::ContractionState valid;
+    valid.method = CHGraph::ContractionMethod::TOP_DOWN;
+    valid.ranks.assign(n, 0);
+    valid.contracted.assign(n, 0);
+    valid.out_first_out.assign(n + 1, 0);
+    valid.in_first_out.assign(n + 1, 0);
+    valid.out_arcs.push_back(CHGraph::CHArc{0, 1, 1.0, -1});
+    for (int v = 1; v <= n; ++v)
+        valid.out_first_out[v] = 1;
+
+    CHGraph::ContractionState loaded;
+    FileFacilities::save_contraction_checkpoint(graph, valid, checkpoint_file);
+    EXPECT_NO_THROW(FileFacilities::load_contraction_checkpoint(checkpoint_file, graph, loaded));
+
+    std::vector<std::function<void(CHGraph::ContractionState &)>> damages = {
+        [](CHGraph::ContractionState &state) { state.method = static_cast<CHGraph::ContractionMethod>(7); },
+        [](CHGraph::ContractionState &state) { state.contracted_nodes = -1; },
+        [n](CHGraph::ContractionState &state) { state.contracted_nodes = n + 1; },
+        [](CHGraph::ContractionState &state) { state.out_first_out[1] = 2; },
+        [](CHGraph::ContractionState &state) { state.out_first_out.back() = 0; },
+        [n](CHGraph::ContractionState &state) { state.out_arcs[0].to = n; },
+        [](CHGraph::ContractionState &state) { state.out_arcs[0].from = -1; },
+        [n](CHGraph::ContractionState &state) { state.ranks[0] = n; },
+        [](CHGraph::ContractionState &state) { state.queue_priorities.push_back(0); state.queue_nodes.push_back(-2); },
+    };
+    for (const auto &damage : damages)
+    {
+        CHGraph::ContractionState state = valid;
+        damage(state);
+        FileFacilities::save_contraction_checkpoint(graph, state, checkpoint_file);
+        EXPECT_THROW(FileFacilities::load_contraction_checkpoint(checkpoint_file, graph, loaded), std::runtime_error);
+    }
+    std::remove(checkpoint_file.c_str());
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "query_pipeline.hpp"
+#include "file_facilities.hpp"
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+
+static std::vector<CHGraph::QueryResult> run_pipeline(const std::vector<CHGraph::Destination> &destinations, const std::size_t batch_size,
+                                                      const CHGraph::QueryFunction &query, const CHGraph::QueryPipelineOptions &options)
+{
+    std::size_t next = 0;
+    std::vector<CHGraph::QueryResult> results;
+
+    CHGraph::run_query_pipeline(
+        [&](std::vector<CHGraph::Destination> &batch)
+        {
+            batch.assign(destinations.begin() + next, destinations.begin() + std::min(destinations.size(), next + batch_size));
+            next += batch.size();
+            return !batch.empty();
+        },
+        query,
+        [&](const std::vector<CHGraph::QueryResult> &batch_results) { results.insert(results.end(), batch_results.begin(), batch_results.end()); },
+        options);
+
+    return results;
+}
+
+TEST(QueryPipeline, ResultsKeepInputOrder)
+{
+    std::vector<CHGraph::Destination> destinations;
+    for (int ind = 0; ind < 10000; ++ind)
+        destinations.push_back(CHGraph::Destination{.source = ind, .target = ind % 17});
+
+    // later batches are faster, so workers finish out of order
+    const std::vector<CHGraph::QueryResult> results = run_pipeline(destinations, 10,
+        [](const CHGraph::Destination &destination, CHGraph::Route &route)
+        {
+            if (destination.source % 1000 < 10)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            route.total_weight = destination.source + destination.target;
+        },
+        CHGraph::QueryPipelineOptions{.worker_number = 4, .max_batches_in_flight = 3});
+
+    ASSERT_EQ(results.size(), destinations.size());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        EXPECT_EQ(results[i].destination.source, destinations[i].source);
+        EXPECT_EQ(results[i].total_weight, destinations[i].source + destinations[i].target);
+    }
+}
+
+TEST(QueryPipeline, BatchesInFlightAreBounded)
+{
+    std::atomic<int> read_batches = 0, written_batches = 0;
+    int max_difference = 0;
+
+    CHGraph::run_query_pipeline(
+        [&](std::vector<CHGraph::Destination> &batch)
+        {
+            if (read_batches == 200)
+                return false;
+            max_difference = std::max(max_difference, read_batches - written_batches + 1);
+            ++read_batches;
+            batch.assign(5, CHGraph::Destination{.source = 0, .target = 1});
+            return true;
+        },
+        [](const CHGraph::Destination &, CHGraph::Route &route) { route.total_weight = 1.0; },
+        [&](const std::vector<CHGraph::QueryResult> &) { ++written_batches; },
+        CHGraph::QueryPipelineOptions{.worker_number = 2, .max_batches_in_flight = 4});
+
+    EXPECT_EQ(written_batches, 200);
+    EXPECT_LE(max_difference, 4);
+}
+
+TEST(QueryPipeline, QueryExceptionIsRethrown)
+{
+    std::vector<CHGraph::Destination> destinations(1000, CHGraph::Destination{.source = 0, .target = 1});
+    destinations[567].source = -1;
+
+    EXPECT_THROW(run_pipeline(destinations, 8,
+        [](const CHGraph::Destination &destination, CHGraph::Route &route)
+        {
+            if (destination.source < 0)
+                throw std::invalid_argument("negative source");
+            route.total_weight = 1.0;
+        },
+        CHGraph::QueryPipelineOptions{.worker_number = 3, .max_batches_in_flight = 2}), std::invalid_argument);
+}
+
+TEST(QueryPipeline, ReaderExceptionIsRethrown)
+{
+    FileFacilities::DestinationReader reader("tst/data/test_facilities/destinations_06.txt");
+
+    EXPECT_THROW(CHGraph::run_query_pipeline(
+        [&](std::vector<CHGraph::Destination> &batch) { return reader.next_batch(batch, 1); },
+        [](const CHGraph::Destination &, CHGraph::Route &route) { route.total_weight = 1.0; },
+        [](const std::vector<CHGraph::QueryResult> &) {}), std::runtime_error);
+}
+
+TEST(QueryPipelineLargeGraph, StreamedQueriesMatchSolutions)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/graph_1000_2000.gr", graph);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_1000_2000.txt", solutions);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    FileFacilities::DestinationReader reader("tst/destinations/d_1000_100.txt");
+    std::vector<CHGraph::QueryResult> results;
+
+    CHGraph::run_query_pipeline(
+        [&](std::vector<CHGraph::Destination> &batch) { return reader.next_batch(batch, 3); },
+        [&](const CHGraph::Destination &destination, CHGraph::Route &route) { CHGraph::query_route(graph, preproc_graph, destination, route); },
+        [&](const std::vector<CHGraph::QueryResult> &batch_results) { results.insert(results.end(), batch_results.begin(), batch_results.end()); },
+        CHGraph::QueryPipelineOptions{.worker_number = 4, .max_batches_in_flight = 2});
+
+    ASSERT_EQ(results.size(), solutions.size());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        EXPECT_EQ(results[i].destination.source, solutions[i].source);
+        EXPECT_EQ(results[i].destination.target, solutions[i].target);
+        EXPECT_EQ(results[i].total_weight, solutions[i].expected_weight);
+    }
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "ch_graph.hpp"
+#include "file_facilities.hpp"
+#include "test_helpers.hpp"
+#include <limits>
+#include <tuple>
+
+
+static double query_weight(const CHGraph::Graph &graph, const CHGraph::PreprocGraph &preproc_graph, const int s, const int t)
+{
+    CHGraph::Route route;
+    CHGraph::query_route(graph, preproc_graph, CHGraph::Destination{.source = s, .target = t}, route);
+    return route.total_weight;
+}
+
+TEST(Reachability, ComponentsAndCondensation)
+{
+    // cycles {0, 1} and {2, 3} joined by 1 -> 2, the closed arc 3 -> 0 does not count, 4 -> 5 and 4 -> 6 branch
+    const double INF = std::numeric_limits<double>::infinity();
+    const CHGraph::Graph graph = make_graph(7, {{0, 1, 1.0}, {1, 0, 1.0}, {1, 2, 2.0}, {2, 3, 1.0}, {3, 2, 1.0}, {3, 0, INF},
+                                                {4, 5, 1.0}, {4, 6, 1.0}});
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    ASSERT_EQ(preproc_graph.components.size(), 7);
+    EXPECT_EQ(preproc_graph.component_number, 5);
+    EXPECT_EQ(preproc_graph.components[0], preproc_graph.components[1]);
+    EXPECT_EQ(preproc_graph.components[2], preproc_graph.components[3]);
+    EXPECT_GT(preproc_graph.components[1], preproc_graph.components[2]);
+    EXPECT_GT(preproc_graph.components[4], preproc_graph.components[5]);
+    EXPECT_GT(preproc_graph.components[4], preproc_graph.components[6]);
+    EXPECT_EQ(preproc_graph.component_reachability.size(), 5);
+
+    EXPECT_TRUE(CHGraph::may_reach(preproc_graph, 0, 3));
+    EXPECT_FALSE(CHGraph::may_reach(preproc_graph, 3, 0));
+    EXPECT_FALSE(CHGraph::may_reach(preproc_graph, 0, 4));
+    EXPECT_FALSE(CHGraph::may_reach(preproc_graph, 4, 0));
+    EXPECT_FALSE(CHGraph::may_reach(preproc_graph, 5, 6));
+    EXPECT_FALSE(CHGraph::may_reach(preproc_graph, 6, 5));
+
+    EXPECT_EQ(query_weight(graph, preproc_graph, 0, 3), 4.0);
+    EXPECT_EQ(query_weight(graph, preproc_graph, 3, 0), INF);
+    EXPECT_EQ(query_weight(graph, preproc_graph, 4, 6), 1.0);
+    EXPECT_EQ(query_weight(graph, preproc_graph, 5, 6), INF);
+}
+
+TEST(Reachability, ManyComponentsWithoutCondensation)
+{
+    // a one-way path has one component per node
+    const int n = CHGraph::MAX_REACHABILITY_COMPONENTS + 10;
+    std::vector<std::tuple<int, int, double>> arcs;
+    for (int v = 0; v + 1 < n; ++v)
+        arcs.emplace_back(v, v + 1, 1.0);
+    const CHGraph::Graph graph = make_graph(n, arcs);
+
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::compute_components(graph, preproc_graph);
+
+    EXPECT_EQ(preproc_graph.component_number, n);
+    EXPECT_TRUE(preproc_graph.component_reachability.empty());
+    EXPECT_TRUE(CHGraph::may_reach(preproc_graph, 0, n - 1));
+    EXPECT_FALSE(CHGraph::may_reach(preproc_graph, n - 1, 0));
+    EXPECT_FALSE(CHGraph::may_reach(preproc_graph, 5, 4));
+}
+
+TEST(Reachability, UpdateReopensArc)
+{
+    // 0 <-> 1 -> 2 -> 0, closing 2 -> 0 splits off {2}, opening it again has to join it back
+    const double INF = std::numeric_limits<double>::infinity();
+    CHGraph::Graph graph = make_graph(3, {{0, 1, 1.0}, {1, 0, 1.0}, {1, 2, 1.0}, {2, 0, 1.0}});
+    CHGraph::PreprocGraph preproc_graph;
+    CHGraph::preproc_graph_bottom_up(graph, preproc_graph);
+    EXPECT_EQ(preproc_graph.component_number, 1);
+
+    const int closed = graph.first_out[2];
+    graph.weights[closed] = INF;
+    CHGraph::update_preproc_graph(graph, preproc_graph, {closed});
+    EXPECT_EQ(preproc_graph.component_number, 2);
+    EXPECT_EQ(query_weight(graph, preproc_graph, 2, 1), INF);
+
+    graph.weights[closed] = 3.0;
+    CHGraph::update_preproc_graph(graph, preproc_graph, {closed});
+    EXPECT_EQ(preproc_graph.component_number, 1);
+    EXPECT_EQ(query_weight(graph, preproc_graph, 2, 1), 4.0);
+}
+
+TEST(ReachabilityLargeGraph, FilterKeepsSolutions)
+{
+    CHGraph::Graph graph;
+    CHGraph::PreprocGraph preproc_graph;
+    std::vector<CHGraph::Destination> destinations;
+    std::vector<CHGraph::Solution> solutions;
+
+    FileFacilities::read_graph("tst/graphs/rome99.gr", graph);
+    FileFacilities::read_destinations("tst/destinations/d_rome99.txt", destinations);
+    FileFacilities::read_solutions("tst/graph_solutions/formatted_rome99.txt", solutions);
+    CHGraph::preproc_graph_top_down(graph, preproc_graph);
+
+    ASSERT_EQ(preproc_graph.components.size(), graph.first_out.size() - 1);
+    ASSERT_EQ(destinations.size(), solutions.size());
+    for (size_t i = 0; i < destinations.size(); ++i)
+    {
+        const CHGraph::Destination &destination = destinations[i];
+        if (!CHGraph::may_reach(preproc_graph, destination.source, destination.target))
+        {
+            EXPECT_EQ(solutions[i].expected_weight, std::numeric_limits<double>::infinity());
+        }
+        EXPECT_EQ(solutions[i].expected_weight, query_weight(graph, preproc_graph, destination.source, destination.target));
+    }
+}
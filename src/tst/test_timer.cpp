@@ -3,6 +3,9 @@
 
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 TEST(TimerTests, StartFromInitialDoesNotThrow)
 {
@@ -87,4 +90,93 @@ TEST(TimerTests, GetResultBeforeFinishedThrows)
 {
     Timer timer;
     EXPECT_THROW(timer.get_result(), std::runtime_error);
-}
\ No newline at end of file
+}
+
+// Busy waits at least duration according to steady_clock and returns the waited time
+static TimerTime busy_wait(const ChronoTime duration)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto end = start;
+    while (end - start < duration)
+    {
+        end = std::chrono::steady_clock::now();
+    }
+    return std::chrono::duration_cast<ChronoTime>(end - start).count();
+}
+
+TEST(TscTimerTests, UnavailableTscIsRejected)
+{
+    if (Timer::tsc_available())
+        GTEST_SKIP() << "Invariant TSC is available on this platform";
+
+    EXPECT_THROW(Timer(TimerBackend::TSC), std::invalid_argument);
+    EXPECT_THROW(Timer::tsc_tick_time(), std::runtime_error);
+}
+
+TEST(TscTimerTests, StateErrorsThrow)
+{
+    if (!Timer::tsc_available())
+        GTEST_SKIP() << "No invariant TSC on this platform";
+
+    Timer timer(TimerBackend::TSC);
+    EXPECT_THROW(timer.stop(), std::runtime_error);
+    timer.start();
+    EXPECT_THROW(timer.start(), std::runtime_error);
+    EXPECT_THROW(timer.get_result(), std::runtime_error);
+}
+
+TEST(TscTimerTests, EmptyRegionIsNearZero)
+{
+    if (!Timer::tsc_available())
+        GTEST_SKIP() << "No invariant TSC on this platform";
+
+    Timer timer(TimerBackend::TSC);
+    TimerTime fastest = std::numeric_limits<TimerTime>::max();
+    for (int ind = 0; ind < 1000; ++ind)
+    {
+        timer.start();
+        timer.stop();
+        EXPECT_GE(timer.get_result(), 0);
+        fastest = std::min(fastest, timer.get_result());
+    }
+
+    // the overhead of start and stop is subtracted
+    EXPECT_LE(fastest, 50);
+}
+
+TEST(TscTimerTests, LongerRegionsTakeLonger)
+{
+    if (!Timer::tsc_available())
+        GTEST_SKIP() << "No invariant TSC on this platform";
+
+    Timer timer(TimerBackend::TSC);
+    TimerTime previous = 0;
+    for (const int microseconds : {10, 100, 1000, 10000})
+    {
+        timer.start();
+        busy_wait(std::chrono::microseconds(microseconds));
+        timer.stop();
+
+        EXPECT_GE(timer.get_result(), previous);
+        previous = timer.get_result();
+    }
+}
+
+TEST(TscTimerTests, CalibrationMatchesSteadyClock)
+{
+    if (!Timer::tsc_available())
+        GTEST_SKIP() << "No invariant TSC on this platform";
+
+    EXPECT_GT(Timer::tsc_tick_time(), 0.0);
+
+    Timer timer(TimerBackend::TSC);
+    for (const int milliseconds : {2, 10, 50})
+    {
+        timer.start();
+        const TimerTime expected = busy_wait(std::chrono::milliseconds(milliseconds));
+        timer.stop();
+
+        // tolerance covers the steady_clock reads inside the region
+        EXPECT_NEAR(static_cast<double>(timer.get_result()), static_cast<double>(expected), 0.02 * expected + 20000.0);
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "trace.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+
+static std::string read_file(const std::string &path)
+{
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static int occurrences(const std::string &text, const std::string &pattern)
+{
+    int count = 0;
+    for (std::size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+    {
+        ++count;
+    }
+    return count;
+}
+
+TEST(TraceTests, WritesCompleteEvents)
+{
+    const std::string trace_path = "tst/tmp/trace_01.tmp";
+
+    Trace::start(trace_path);
+    EXPECT_TRUE(Trace::enabled());
+    {
+        Trace::Span span("outer");
+        Trace::Span inner(Trace::intern("in\"ner"));
+    }
+    Trace::stop();
+    EXPECT_FALSE(Trace::enabled());
+
+    const std::string trace = read_file(trace_path);
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(trace.find("\"name\":\"outer\""), std::string::npos);
+    EXPECT_NE(trace.find("\"name\":\"in\\\"ner\""), std::string::npos);
+    EXPECT_EQ(occurrences(trace, "\"ph\":\"X\""), 2);
+}
+
+TEST(TraceTests, RingBufferKeepsNewestEvents)
+{
+    const std::string trace_path = "tst/tmp/trace_02.tmp";
+    const char *names[] = {"event_0", "event_1", "event_2", "event_3", "event_4", "event_5"};
+
+    Trace::start(trace_path, 4);
+    for (const char *name : names)
+    {
+        const Trace::Clock::time_point now = Trace::Clock::now();
+        Trace::record(name, now, now);
+    }
+    Trace::stop();
+
+    const std::string trace = read_file(trace_path);
+    EXPECT_EQ(trace.find("event_0"), std::string::npos);
+    EXPECT_EQ(trace.find("event_1"), std::string::npos);
+    EXPECT_LT(trace.find("event_2"), trace.find("event_5"));
+    EXPECT_EQ(occurrences(trace, "\"ph\":\"X\""), 4);
+}
+
+TEST(TraceTests, ThreadsGetOwnBuffers)
+{
+    const std::string trace_path = "tst/tmp/trace_03.tmp";
+
+    Trace::start(trace_path, 1);
+    {
+        Trace::Span span("main");
+    }
+    std::thread worker([]() { Trace::Span span("worker"); });
+    worker.join();
+    Trace::stop();
+
+    const std::string trace = read_file(trace_path);
+    EXPECT_NE(trace.find("\"name\":\"worker\""), std::string::npos);
+    EXPECT_NE(trace.find("\"tid\":2"), std::string::npos);
+}
+
+TEST(TraceTests, NothingIsRecordedWhenStopped)
+{
+    const std::string trace_path = "tst/tmp/trace_04.tmp";
+
+    {
+        Trace::Span span("before");
+    }
+    Trace::start(trace_path);
+    Trace::stop();
+
+    EXPECT_EQ(occurrences(read_file(trace_path), "\"ph\":\"X\""), 0);
+    EXPECT_THROW(Trace::start(trace_path, 0), std::invalid_argument);
+}